@@ -0,0 +1,17 @@
+// Direction through the texel of a cube face, following the Vulkan face selection rules
+vec3 GetCubeDirection(uint face, uvec2 texel, uvec2 faceSize)
+{
+	vec2 uv = (vec2(texel) + 0.5) / vec2(faceSize) * 2.0 - 1.0;
+
+	vec3 direction;
+	switch (face) {
+	case 0u: direction = vec3(1.0, -uv.y, -uv.x); break;
+	case 1u: direction = vec3(-1.0, -uv.y, uv.x); break;
+	case 2u: direction = vec3(uv.x, 1.0, uv.y); break;
+	case 3u: direction = vec3(uv.x, -1.0, -uv.y); break;
+	case 4u: direction = vec3(uv.x, -uv.y, 1.0); break;
+	default: direction = vec3(-uv.x, -uv.y, -1.0); break;
+	}
+
+	return normalize(direction);
+}
@@ -0,0 +1,20 @@
+// Material parameters as laid out in the material buffer, see MaterialData
+struct Material
+{
+	vec4 baseColorFactor;
+	vec3 emissiveFactor;
+	float metallicFactor;
+	float roughnessFactor;
+	float alphaMask;
+	float alphaMaskCutoff;
+	uint albedoTextureIndex;
+	uint physicalTextureIndex;
+	uint normalTextureIndex;
+	uint occlusionTextureIndex;
+	uint emissiveTextureIndex;
+	int albedoTextureSet;
+	int physicalTextureSet;
+	int normalTextureSet;
+	int occlusionTextureSet;
+	int emissiveTextureSet;
+};
@@ -0,0 +1,35 @@
+#version 450
+
+layout (location = 0) in vec3 i_position;
+layout (location = 4) in uint i_transformSlot;
+
+// Camera set
+layout (set = 0, binding = 0) uniform Camera
+{
+	mat4 projection;
+	mat4 view;
+	vec3 position;
+} u_camera;
+
+// Transforms set
+layout (set = 1, binding = 0) readonly buffer Transforms
+{
+	mat4 models[];
+} u_transforms;
+
+// Dequantization of the mesh positions
+layout (push_constant) uniform Mesh {
+	vec4 positionOffset;
+	vec4 positionScale;
+} pc_mesh;
+
+// Must match Pbr.vert exactly for the shading pass EQUAL depth test
+invariant gl_Position;
+
+void main() 
+{
+	mat4 model = u_transforms.models[i_transformSlot];
+	vec3 position = pc_mesh.positionOffset.xyz + pc_mesh.positionScale.xyz * i_position;
+	vec3 worldPosition = vec3(model * vec4(position, 1.0));
+	gl_Position =  u_camera.projection * u_camera.view * vec4(worldPosition, 1.0);
+}
@@ -1,5 +1,7 @@
 #version 450
 
+#extension GL_EXT_nonuniform_qualifier : require
+
 layout (location = 0) in vec3 i_worldPosition;
 layout (location = 1) in vec3 i_normal;
 layout (location = 2) in vec2 i_uv0;
@@ -7,6 +9,7 @@ layout (location = 3) in vec2 i_uv1;
 
 layout (constant_id = 0) const float c_gamma = 2.2;
 layout (constant_id = 1) const float c_exposure = 4.5;
+layout (constant_id = 2) const bool c_useIrradianceSH = false; // Diffuse from the SH coefficients instead of the irradiance cube
 
 // Camera set
 layout (set = 0, binding = 0) uniform Camera
@@ -16,58 +19,102 @@ layout (set = 0, binding = 0) uniform Camera
 	vec3 position;
 } u_camera;
 
-// Material set
-layout (set = 2, binding = 0) uniform sampler2D u_albedoMap;
-layout (set = 2, binding = 1) uniform sampler2D u_physicalMap;
-layout (set = 2, binding = 2) uniform sampler2D u_normalMap;
-layout (set = 2, binding = 3) uniform sampler2D u_aoMap;
-layout (set = 2, binding = 4) uniform sampler2D u_emissiveMap;
+// Bindless textures set
+layout (set = 2, binding = 0) uniform sampler2D u_textures[];
 
 // IBL set
 layout (set = 3, binding = 0) uniform sampler2D u_brdflutMap;
 layout (set = 3, binding = 1) uniform samplerCube u_irradianceCube;	
 layout (set = 3, binding = 2) uniform samplerCube u_prefilteredCube;
+layout (set = 3, binding = 3) uniform IrradianceSH
+{
+	vec4 coefficients[9];
+} u_irradianceSH;
 
 // Lights set
 struct Light
 {
 	vec3 color;
+	float range;
 	vec3 position;
+	uint type;
+	vec3 direction;
+	float spotAngleScale;
+	float spotAngleOffset;
+	uint shadowIndex;
 };
 
-layout (set = 4, binding = 0) buffer Lights
+const uint LIGHT_TYPE_SPOT = 1;
+const uint LIGHT_TYPE_DIRECTIONAL = 2;
+const uint NO_SHADOW = 0xFFFFFFFF;
+
+layout (set = 4, binding = 0) readonly buffer Lights
 {
-	Light lights[128];
-	int nrLights;
+	Light lights[];
 } u_lights;
 
-layout (push_constant) uniform Material {
-	vec4 baseColorFactor;
-	vec3 emissiveFactor;
-	int albedoTextureSet;
-	int physicalTextureSet;
-	int normalTextureSet;	
-	int occlusionTextureSet;
-	int emissiveTextureSet;
-	float metallicFactor;	
-	float roughnessFactor;	
-	float alphaMask;
-	float alphaMaskCutoff;
-} pc_material;
+layout (set = 4, binding = 1) readonly buffer Clusters
+{
+	uvec4 clusterCount; // w is the number of lights shading every fragment, listed first in the light indices
+	vec4 clusterParameters; // Clusters per pixel in xy, depth slice scale and bias in zw
+	uvec2 clusters[]; // First light index and light count
+} u_clusters;
+
+layout (set = 4, binding = 2) readonly buffer LightIndices
+{
+	uint lightIndices[];
+} u_lightIndices;
+
+// Materials set
+#include "Common/Material.glsl"
+
+layout (set = 5, binding = 0) readonly buffer Materials
+{
+	Material materials[];
+} u_materials;
+
+// Shadows set
+struct ShadowView
+{
+	mat4 viewProjection;
+	vec4 atlasRect; // Offset and size in atlas UVs
+};
+
+layout (set = 6, binding = 0) readonly buffer Shadows
+{
+	vec4 cascadeSplits; // View depth at which each directional light cascade ends
+	ShadowView views[];
+} u_shadows;
+
+layout (set = 6, binding = 1) uniform sampler2DShadow u_shadowAtlas;
+
+layout (push_constant) uniform Draw {
+	layout (offset = 32) uint materialIndex;
+} pc_draw;
 
 layout (location = 0) out vec4 o_color;
 
 #include "Common/Constants.glsl"
 #include "Common/ColorSpace.glsl"
+#include "Common/SphericalHarmonics.glsl"
 
 // Constants
 const vec3 DIELECTRIC_F0 = vec3(0.04);
 
+// Material of the current draw, fetched once from the material buffer
+Material material;
+
+// Distance of the fragment from the camera plane
+float viewDepth;
+
 // Normal Mapping without Precomputed Tangents by Christian Schüler
 vec3 GetNormalFromMap()
 {
-	vec2 inUV = pc_material.normalTextureSet == 0 ? i_uv0 : i_uv1;
-	vec3 tangentNormal = texture(u_normalMap, inUV).xyz * 2.0 - 1.0;
+	vec2 inUV = material.normalTextureSet == 0 ? i_uv0 : i_uv1;
+	// Z is rebuilt from XY, cooked normal maps are BC5 and only store two channels
+	vec3 tangentNormal;
+	tangentNormal.xy = texture(u_textures[material.normalTextureIndex], inUV).xy * 2.0 - 1.0;
+	tangentNormal.z = sqrt(max(1.0 - dot(tangentNormal.xy, tangentNormal.xy), 0.0));
 
 	vec3 q1 = dFdx(i_worldPosition);
 	vec3 q2 = dFdy(i_worldPosition);
@@ -84,48 +131,48 @@ vec3 GetNormalFromMap()
 
 vec3 GetNormal()
 {
-	return (pc_material.normalTextureSet > -1) ? GetNormalFromMap() : normalize(i_normal);
+	return (material.normalTextureSet > -1) ? GetNormalFromMap() : normalize(i_normal);
 }
 
 void ApplyAmbientOcclusion(inout vec3 color)
 {
 	const float occlusionStrength = 1.0f;
-	if (pc_material.occlusionTextureSet > -1) {
-		float ao = texture(u_aoMap, (pc_material.occlusionTextureSet == 0 ? i_uv0 : i_uv1)).r;
+	if (material.occlusionTextureSet > -1) {
+		float ao = texture(u_textures[material.occlusionTextureIndex], (material.occlusionTextureSet == 0 ? i_uv0 : i_uv1)).r;
 		color = mix(color, color * ao, occlusionStrength);
 	}
 }
 
 void ApplyEmissiveness(inout vec3 color)
 {
-	if (pc_material.emissiveTextureSet > -1) {
-		vec3 emissive = SRGBtoLinear(texture(u_emissiveMap, pc_material.emissiveTextureSet == 0 ? i_uv0 : i_uv1)).rgb * pc_material.emissiveFactor;
+	if (material.emissiveTextureSet > -1) {
+		vec3 emissive = SRGBtoLinear(texture(u_textures[material.emissiveTextureIndex], material.emissiveTextureSet == 0 ? i_uv0 : i_uv1)).rgb * material.emissiveFactor;
 		color += emissive;
 	} else {	
-		color += pc_material.emissiveFactor;	
+		color += material.emissiveFactor;	
 	}
 }
 
 void GetAlbedo(out vec4 albedo)
 {
-	if (pc_material.albedoTextureSet > -1) {
-		albedo = SRGBtoLinear(texture(u_albedoMap, pc_material.albedoTextureSet == 0 ? i_uv0 : i_uv1)) * pc_material.baseColorFactor;
+	if (material.albedoTextureSet > -1) {
+		albedo = SRGBtoLinear(texture(u_textures[material.albedoTextureIndex], material.albedoTextureSet == 0 ? i_uv0 : i_uv1)) * material.baseColorFactor;
 	} else {
-		albedo = pc_material.baseColorFactor;
+		albedo = material.baseColorFactor;
 	}
 
-	if (albedo.a < pc_material.alphaMaskCutoff) {
+	if (material.alphaMask > 0.5 && albedo.a < material.alphaMaskCutoff) {
 		discard;
 	}
 }
 
 void GetMetallicRoughness(out float metallic, out float roughness)
 {
-	metallic = pc_material.metallicFactor;
-	roughness = pc_material.roughnessFactor;
+	metallic = material.metallicFactor;
+	roughness = material.roughnessFactor;
 
-	if (pc_material.physicalTextureSet > -1) {
-		vec4 mrSample = texture(u_physicalMap, pc_material.physicalTextureSet == 0 ? i_uv0 : i_uv1);
+	if (material.physicalTextureSet > -1) {
+		vec4 mrSample = texture(u_textures[material.physicalTextureIndex], material.physicalTextureSet == 0 ? i_uv0 : i_uv1);
 		roughness = mrSample.g * roughness;
 		metallic = mrSample.b * metallic;
 	}
@@ -195,6 +242,104 @@ vec3 BRDF(vec3 L, vec3 V, vec3 N, vec3 radiance, vec4 albedo, float metallic, fl
 	return color;
 }
 
+float SampleShadowView(uint viewIndex)
+{
+	ShadowView view = u_shadows.views[viewIndex];
+	vec4 clipPosition = view.viewProjection * vec4(i_worldPosition, 1.0);
+	vec3 shadowPosition = clipPosition.xyz / clipPosition.w;
+	if (any(greaterThan(abs(shadowPosition.xy), vec2(1.0))) || shadowPosition.z > 1.0) {
+		return 1.0;
+	}
+
+	// Filtering must not read the neighbouring tiles of the atlas
+	vec2 halfTexel = 0.5 / vec2(textureSize(u_shadowAtlas, 0));
+	vec2 uv = view.atlasRect.xy + (shadowPosition.xy * 0.5 + 0.5) * view.atlasRect.zw;
+	uv = clamp(uv, view.atlasRect.xy + halfTexel, view.atlasRect.xy + view.atlasRect.zw - halfTexel);
+	return texture(u_shadowAtlas, vec3(uv, shadowPosition.z));
+}
+
+float GetShadow(Light light)
+{
+	if (light.shadowIndex == NO_SHADOW) {
+		return 1.0;
+	}
+
+	if (light.type == LIGHT_TYPE_DIRECTIONAL) {
+		// One view per cascade
+		uint cascade = uint(dot(vec4(greaterThanEqual(vec4(viewDepth), u_shadows.cascadeSplits)), vec4(1.0)));
+		return cascade < 4u ? SampleShadowView(light.shadowIndex + cascade) : 1.0;
+	}
+
+	if (light.type == LIGHT_TYPE_SPOT) {
+		return SampleShadowView(light.shadowIndex);
+	}
+
+	// Point lights have one view per cube face, ordered +X, -X, +Y, -Y, +Z, -Z
+	vec3 lightToFragment = i_worldPosition - light.position;
+	vec3 axis = abs(lightToFragment);
+	uint face;
+	if (axis.x >= axis.y && axis.x >= axis.z) {
+		face = lightToFragment.x > 0.0 ? 0u : 1u;
+	} else if (axis.y >= axis.z) {
+		face = lightToFragment.y > 0.0 ? 2u : 3u;
+	} else {
+		face = lightToFragment.z > 0.0 ? 4u : 5u;
+	}
+	return SampleShadowView(light.shadowIndex + face);
+}
+
+vec3 ComputeLight(Light light, vec3 V, vec3 N, vec4 albedo, float metallic, float roughness, vec3 F0)
+{
+	vec3 L;
+	float attenuation = 1.0;
+	if (light.type == LIGHT_TYPE_DIRECTIONAL) {
+		L = -light.direction;
+	} else {
+		vec3 uL = light.position - i_worldPosition;
+		float lightDistanceSquare = dot(uL, uL);
+		L = uL * inversesqrt(lightDistanceSquare);
+		attenuation = 1.0 / max(lightDistanceSquare, EPSILON);
+
+		// Lights with a range fade out smoothly before reaching it
+		if (light.range > 0.0) {
+			float rangeRatio = lightDistanceSquare / (light.range * light.range);
+			attenuation *= clamp(1.0 - rangeRatio * rangeRatio, 0.0, 1.0);
+		}
+
+		if (light.type == LIGHT_TYPE_SPOT) {
+			float cone = clamp(dot(light.direction, -L) * light.spotAngleScale + light.spotAngleOffset, 0.0, 1.0);
+			attenuation *= cone * cone;
+		}
+	}
+
+	if (attenuation > 0.0) {
+		attenuation *= GetShadow(light);
+	}
+
+	vec3 radiance = light.color * attenuation;
+	return BRDF(L, V, N, radiance, albedo, metallic, roughness, F0);
+}
+
+uint GetClusterIndex()
+{
+	uvec3 cluster;
+	cluster.xy = min(uvec2(gl_FragCoord.xy * u_clusters.clusterParameters.xy), u_clusters.clusterCount.xy - 1);
+	cluster.z = min(uint(max(log(viewDepth) * u_clusters.clusterParameters.z + u_clusters.clusterParameters.w, 0.0)), u_clusters.clusterCount.z - 1);
+	return cluster.x + u_clusters.clusterCount.x * (cluster.y + u_clusters.clusterCount.y * cluster.z);
+}
+
+vec3 GetIrradianceSH(vec3 N)
+{
+	float basis[9];
+	GetSH9Basis(N, basis);
+
+	vec3 irradiance = vec3(0.0);
+	for (uint i = 0; i < 9; i++) {
+		irradiance += u_irradianceSH.coefficients[i].rgb * basis[i];
+	}
+	return max(irradiance, vec3(0.0));
+}
+
 vec3 ComputeIBL(vec4 albedo, float metallic, float roughness, vec3 N, vec3 V, vec3 F0)
 {	
     vec3 F = FresnelRoughnessFunction(max(dot(N, V), 0.0), F0, roughness);	
@@ -203,7 +348,7 @@ vec3 ComputeIBL(vec4 albedo, float metallic, float roughness, vec3 N, vec3 V, ve
     vec3 kD = 1.0 - kS;
     kD *= 1.0 - metallic;
 
-    vec3 irradiance = texture(u_irradianceCube, N).rgb;
+    vec3 irradiance = c_useIrradianceSH ? GetIrradianceSH(N) : texture(u_irradianceCube, N).rgb;
     vec3 diffuse = irradiance * albedo.rgb;	
     	
 	vec3 R = -normalize(reflect(V, N));	
@@ -215,6 +360,9 @@ vec3 ComputeIBL(vec4 albedo, float metallic, float roughness, vec3 N, vec3 V, ve
 
 void main()
 {
+	material = u_materials.materials[pc_draw.materialIndex];
+	viewDepth = -(u_camera.view * vec4(i_worldPosition, 1.0)).z;
+
 	vec4 albedo;
 	float metallic;
 	float roughness;
@@ -227,16 +375,15 @@ void main()
 
 	vec3 F0 = mix(DIELECTRIC_F0, albedo.rgb, metallic);
 
-	// Reflectance equation
+	// Reflectance equation, unbounded lights first then the lights assigned to the cluster of the fragment
 	vec3 Lo = vec3(0.0);
-	for(int i = 0; i < u_lights.nrLights; i++) {
-		vec3 uL = u_lights.lights[i].position - i_worldPosition;
-		vec3 L = normalize(uL);
-		float lightDistance = length(uL);
-        float attenuation = 1.0 / (lightDistance * lightDistance);
-		vec3 radiance = SRGBtoLinear(u_lights.lights[i].color) * attenuation;
-		
-		Lo += BRDF(L, V, N, radiance, albedo, metallic, roughness, F0);
+	for (uint i = 0; i < u_clusters.clusterCount.w; i++) {
+		Lo += ComputeLight(u_lights.lights[u_lightIndices.lightIndices[i]], V, N, albedo, metallic, roughness, F0);
+	}
+
+	uvec2 cluster = u_clusters.clusters[GetClusterIndex()];
+	for (uint i = 0; i < cluster.y; i++) {
+		Lo += ComputeLight(u_lights.lights[u_lightIndices.lightIndices[cluster.x + i]], V, N, albedo, metallic, roughness, F0);
 	}
 	
 	ApplyEmissiveness(Lo);
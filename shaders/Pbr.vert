@@ -1,9 +1,10 @@
 #version 450
 
 layout (location = 0) in vec3 i_position;
-layout (location = 1) in vec3 i_normal;
+layout (location = 1) in vec2 i_normal;
 layout (location = 2) in vec2 i_uv0;
 layout (location = 3) in vec2 i_uv1;
+layout (location = 4) in uint i_transformSlot;
 
 // Camera set
 layout (set = 0, binding = 0) uniform Camera
@@ -13,21 +14,40 @@ layout (set = 0, binding = 0) uniform Camera
 	vec3 position;
 } u_camera;
 
-// Transform set
-layout (set = 1, binding = 0) uniform Transform
+// Transforms set
+layout (set = 1, binding = 0) readonly buffer Transforms
 {
-	mat4 model;
-} u_transform;
+	mat4 models[];
+} u_transforms;
+
+// Dequantization of the mesh positions
+layout (push_constant) uniform Mesh {
+	vec4 positionOffset;
+	vec4 positionScale;
+} pc_mesh;
 
 layout (location = 0) out vec3 o_worldPosition;
 layout (location = 1) out vec3 o_normal;
 layout (location = 2) out vec2 o_uv0;
 layout (location = 3) out vec2 o_uv1;
 
+// The depth pre-pass computes the same position in Depth.vert
+invariant gl_Position;
+
+vec3 DecodeOctahedralNormal(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float t = max(-normal.z, 0.0);
+	normal.xy += mix(vec2(t), vec2(-t), greaterThanEqual(normal.xy, vec2(0.0)));
+	return normalize(normal);
+}
+
 void main() 
 {
-	o_worldPosition = vec3(u_transform.model * vec4(i_position, 1.0));
-    o_normal = normalize(transpose(inverse(mat3(u_transform.model))) * i_normal);
+	mat4 model = u_transforms.models[i_transformSlot];
+	vec3 position = pc_mesh.positionOffset.xyz + pc_mesh.positionScale.xyz * i_position;
+	o_worldPosition = vec3(model * vec4(position, 1.0));
+    o_normal = normalize(transpose(inverse(mat3(model))) * DecodeOctahedralNormal(i_normal));
 	o_uv0 = i_uv0;
 	o_uv1 = i_uv1;
 	gl_Position =  u_camera.projection * u_camera.view * vec4(o_worldPosition, 1.0);
@@ -0,0 +1,24 @@
+#version 450
+
+layout (location = 0) in vec3 i_position;
+layout (location = 4) in uint i_transformSlot;
+
+// Transforms set
+layout (set = 0, binding = 0) readonly buffer Transforms
+{
+	mat4 models[];
+} u_transforms;
+
+// Dequantization of the mesh positions and view of the shadow tile
+layout (push_constant) uniform Shadow {
+	vec4 positionOffset;
+	vec4 positionScale;
+	mat4 viewProjection;
+} pc_shadow;
+
+void main() 
+{
+	mat4 model = u_transforms.models[i_transformSlot];
+	vec3 position = pc_shadow.positionOffset.xyz + pc_shadow.positionScale.xyz * i_position;
+	gl_Position = pc_shadow.viewProjection * model * vec4(position, 1.0);
+}
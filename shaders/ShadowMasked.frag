@@ -0,0 +1,37 @@
+#version 450
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (location = 0) in vec2 i_uv0;
+layout (location = 1) in vec2 i_uv1;
+
+// Bindless textures set
+layout (set = 1, binding = 0) uniform sampler2D u_textures[];
+
+// Materials set
+#include "Common/Material.glsl"
+
+layout (set = 2, binding = 0) readonly buffer Materials
+{
+	Material materials[];
+} u_materials;
+
+// After the shadow block of the vertex stage
+layout (push_constant) uniform Draw {
+	layout (offset = 96) uint materialIndex;
+} pc_draw;
+
+// Depth only, the fragments the shading pass would discard cast no shadow
+void main()
+{
+	Material material = u_materials.materials[pc_draw.materialIndex];
+
+	float alpha = material.baseColorFactor.a;
+	if (material.albedoTextureSet > -1) {
+		alpha *= texture(u_textures[material.albedoTextureIndex], material.albedoTextureSet == 0 ? i_uv0 : i_uv1).a;
+	}
+
+	if (alpha < material.alphaMaskCutoff) {
+		discard;
+	}
+}
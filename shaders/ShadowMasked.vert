@@ -0,0 +1,32 @@
+#version 450
+
+layout (location = 0) in vec3 i_position;
+layout (location = 2) in vec2 i_uv0;
+layout (location = 3) in vec2 i_uv1;
+layout (location = 4) in uint i_transformSlot;
+
+// Transforms set
+layout (set = 0, binding = 0) readonly buffer Transforms
+{
+	mat4 models[];
+} u_transforms;
+
+// Dequantization of the mesh positions and view of the shadow tile
+layout (push_constant) uniform Shadow {
+	vec4 positionOffset;
+	vec4 positionScale;
+	mat4 viewProjection;
+} pc_shadow;
+
+layout (location = 0) out vec2 o_uv0;
+layout (location = 1) out vec2 o_uv1;
+
+// Same position as Shadow.vert, the uvs are only needed to alpha test
+void main() 
+{
+	mat4 model = u_transforms.models[i_transformSlot];
+	vec3 position = pc_shadow.positionOffset.xyz + pc_shadow.positionScale.xyz * i_position;
+	o_uv0 = i_uv0;
+	o_uv1 = i_uv1;
+	gl_Position = pc_shadow.viewProjection * model * vec4(position, 1.0);
+}
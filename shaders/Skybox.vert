@@ -1,9 +1,6 @@
 #version 450
 
 layout (location = 0) in vec3 i_position;
-layout (location = 1) in vec3 i_normal;
-layout (location = 2) in vec2 i_uv0;
-layout (location = 3) in vec2 i_uv1;
 
 // Camera set
 layout (set = 0, binding = 0) uniform Camera
@@ -13,6 +10,12 @@ layout (set = 0, binding = 0) uniform Camera
 	vec3 position;
 } u_camera;
 
+// Dequantization of the mesh positions
+layout (push_constant) uniform Mesh {
+	vec4 positionOffset;
+	vec4 positionScale;
+} pc_mesh;
+
 layout (location = 0) out vec3 o_uvw;
 
 out gl_PerVertex 
@@ -22,7 +25,8 @@ out gl_PerVertex
 
 void main() 
 {
-	o_uvw = i_position;
+	vec3 position = pc_mesh.positionOffset.xyz + pc_mesh.positionScale.xyz * i_position;
+	o_uvw = position;
 	mat4 viewNoTranslation = mat4(mat3(u_camera.view));
-	gl_Position = u_camera.projection * viewNoTranslation * vec4(i_position.xyz, 1.0);
+	gl_Position = u_camera.projection * viewNoTranslation * vec4(position, 1.0);
 }
@@ -55,31 +55,28 @@ glm::mat4 CameraComponent::GetPerspectiveMatrix() const
 }
 
 const std::vector<VkDescriptorSetLayoutBinding> CameraComponentResource::ms_bindings = {
-    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }
+    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }
 };
 
 CameraComponentResource::CameraComponentResource(CameraComponent const&)
 {
-    BufferInfo bufferCreationInfo;
-    bufferCreationInfo.m_size = sizeof(UniformData);
-    bufferCreationInfo.m_usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    bufferCreationInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-    m_uniformBuffer = CreateResourceInFlight<Buffer>(bufferCreationInfo);
+    m_uniformOffset = CreateResourceInFlight<uint32_t>(0u);
     m_descriptorSet = CreateResourceInFlight<DescriptorSet>(CameraComponentResource::ms_bindings);
 
     Renderer const& renderer = Renderer::GetInstance();
 
+    // The uniform data lives in the frame's uniform allocator, the descriptor is rebased with a dynamic offset
     uint8_t i = 0;
     for (DescriptorSet& set : m_descriptorSet)
     {
         VkDescriptorBufferInfo bufferInfo = {};
-        bufferInfo.buffer = m_uniformBuffer[i].GetBuffer();
+        bufferInfo.buffer = renderer.GetUniformAllocator().GetBuffer(i);
         bufferInfo.offset = 0;
         bufferInfo.range = sizeof(UniformData);
 
         VkWriteDescriptorSet writeDescriptorSet = {};
         writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeDescriptorSet.descriptorCount = 1;
         writeDescriptorSet.dstSet = set.GetDescriptorSet();
         writeDescriptorSet.dstBinding = 0;
@@ -124,8 +121,7 @@ void CameraResourceSystem::UpdateCameraResource(CameraComponentResource& cameraR
     data.m_position = scene.GetWorldTranslation();
     data.m_view = camera.GetViewMatrix(data.m_position, scene.GetWorldRotation());
 
-    Buffer& buffer = cameraResource.m_uniformBuffer.GetResource();
-    buffer.CopyDataToBuffer(&data, sizeof(CameraComponentResource::UniformData));
+    cameraResource.m_uniformOffset.GetResource() = Renderer::GetInstance().GetUniformAllocator().Allocate(data).m_offset;
 }
 
 void CameraResourceSystem::OnSwapchainRecreated(VkExtent2D const& newExtent)
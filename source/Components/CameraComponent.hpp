@@ -20,6 +20,10 @@ public:
     void SetAspectRatio(float aspectRatio);
     void SetFollowResolutionAsAspectRatio(bool shouldFollow) { m_shouldFollowResolutionAsAspectRatio = shouldFollow; }
 
+    float GetFieldOfVision() const { return m_fov; }
+    float GetNearPlane() const { return m_near; }
+    float GetFarPlane() const { return m_far; }
+    float GetAspectRatio() const { return m_aspectRatio; }
     bool GetFollowResolutionAsAspectRatio() const { return m_shouldFollowResolutionAsAspectRatio; }
     glm::mat4 GetPerspectiveMatrix() const;
     static glm::mat4 GetViewMatrix(glm::vec3 const& worldPosition, glm::quat const& worldRotation);
@@ -60,9 +64,12 @@ public:
 
 public:
     CameraComponentResource(CameraComponent const& camera);
+
+    // Offset of the uniform data in the frame's uniform allocator, bound as a dynamic offset
+    uint32_t GetUniformOffset() const { return m_uniformOffset.GetResource(); }
     
 public:
-    ResourceInFlight<Buffer> m_uniformBuffer;
+    ResourceInFlight<uint32_t> m_uniformOffset;
 
     static const std::vector<VkDescriptorSetLayoutBinding> ms_bindings;
 };
@@ -1,17 +1,41 @@
 #include <Components/IBLComponent.hpp>
 
+#include <Resources/Buffer.hpp>
 #include <Resources/TextureResource.hpp>
 #include <Systems/Renderer.hpp>
 
 const std::vector<VkDescriptorSetLayoutBinding> IBLComponent::ms_bindings = {
     { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }, // BRDFLUT
     { 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }, // Irradiance
-    { 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr } // Prefilter
+    { 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }, // Prefilter
+    { 3, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr } // Irradiance SH
 };
 
 IBLComponent::IBLComponent()
     : ComponentResource(IBLComponent::ms_bindings)
 {
+    // Always bound so the shading pipeline stays valid whichever irradiance it reads
+    BufferInfo bufferCreationInfo;
+    bufferCreationInfo.m_size = sizeof(IrradianceSH);
+    bufferCreationInfo.m_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    bufferCreationInfo.m_memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
+    m_irradianceSH = std::make_shared<Buffer>(bufferCreationInfo);
+
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = m_irradianceSH->GetBuffer();
+    bufferInfo.offset = 0;
+    bufferInfo.range = sizeof(IrradianceSH);
+
+    VkWriteDescriptorSet writeDescriptorSet = {};
+    writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.dstSet = m_descriptorSet.GetDescriptorSet();
+    writeDescriptorSet.dstBinding = 3;
+    writeDescriptorSet.pBufferInfo = &bufferInfo;
+
+    Renderer const& renderer = Renderer::GetInstance();
+    vkUpdateDescriptorSets(renderer.GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
 }
 
 void IBLComponent::SetBrdflut(TextureResource& brdflutImage)
@@ -68,4 +92,11 @@ void IBLComponent::SetPrefiltered(SharedPtr<TextureResource>& prefilteredImage)
 
     Renderer const& renderer = Renderer::GetInstance();
     vkUpdateDescriptorSets(renderer.GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
+
+    if (!m_irradianceCube)
+    {
+        // Without an irradiance cube the diffuse term comes from SH, the cube binding is never sampled but must stay valid
+        writeDescriptorSet.dstBinding = 1;
+        vkUpdateDescriptorSets(renderer.GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
+    }
 }
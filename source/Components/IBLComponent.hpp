@@ -4,6 +4,7 @@
 #include <Resources/ResourceComponent.hpp>
 #include <Utilities/Helpers.hpp>
 
+class Buffer;
 class TextureResource;
 
 class IBLComponent : public ComponentResource
@@ -22,4 +23,10 @@ public:
     SharedPtr<TextureResource> m_brdflut;
     SharedPtr<TextureResource> m_irradianceCube;
     SharedPtr<TextureResource> m_prefilteredCube;
+    SharedPtr<Buffer> m_irradianceSH; // Nine coefficients, written by the SH irradiance pass
+};
+
+struct IrradianceSH
+{
+    glm::vec4 m_coefficients[9]; // The w components are padding
 };
@@ -1,20 +1,36 @@
 #include <Components/LightComponent.hpp>
 
+#include <Components/CameraComponent.hpp>
 #include <Components/SceneComponent.hpp>
+#include <Components/ShadowComponent.hpp>
 #include <Systems/EntitySystem.hpp>
 #include <Systems/Renderer.hpp>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define LIGHT_CLUSTERS_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+static void FillLightData(LightComponentGlobalResource::LightData& lightData, LightComponent const& light, SceneComponent const& scene);
+
 const std::vector<VkDescriptorSetLayoutBinding> LightComponentGlobalResource::ms_bindings = {
-    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }
+    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr },
+    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr },
+    { 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }
 };
 
 LightComponentGlobalResource::LightComponentGlobalResource()
 {
     BufferInfo bufferCreationInfo;
-    bufferCreationInfo.m_size = sizeof(UniformData);
+    bufferCreationInfo.m_size = sizeof(ClusterHeader) + sizeof(ClusterData) * ms_clusterCount;
     bufferCreationInfo.m_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
     bufferCreationInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-    m_uniformBuffer = CreateResourceInFlight<Buffer>(bufferCreationInfo);
+    m_clusterBuffer = CreateResourceInFlight<Buffer>(bufferCreationInfo);
+
+    bufferCreationInfo.m_size = sizeof(uint32_t) * ms_maxClusterLightIndices;
+    m_lightIndexBuffer = CreateResourceInFlight<Buffer>(bufferCreationInfo);
+
+    m_lightCapacity = CreateResourceInFlight<uint32_t>(0u);
     m_descriptorSet = CreateResourceInFlight<DescriptorSet>(LightComponentGlobalResource::ms_bindings);
 
     Renderer const& renderer = Renderer::GetInstance();
@@ -22,52 +38,400 @@ LightComponentGlobalResource::LightComponentGlobalResource()
     uint8_t i = 0;
     for (DescriptorSet& set : m_descriptorSet)
     {
-        VkDescriptorBufferInfo bufferInfo = {};
-        bufferInfo.buffer = m_uniformBuffer[i].GetBuffer();
-        bufferInfo.offset = 0;
-        bufferInfo.range = sizeof(UniformData);
+        std::array<VkDescriptorBufferInfo, 2> bufferInfos = {};
+        bufferInfos[0].buffer = m_clusterBuffer[i].GetBuffer();
+        bufferInfos[0].offset = 0;
+        bufferInfos[0].range = sizeof(ClusterHeader) + sizeof(ClusterData) * ms_clusterCount;
+        bufferInfos[1].buffer = m_lightIndexBuffer[i].GetBuffer();
+        bufferInfos[1].offset = 0;
+        bufferInfos[1].range = sizeof(uint32_t) * ms_maxClusterLightIndices;
 
-        VkWriteDescriptorSet writeDescriptorSet = {};
-        writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        writeDescriptorSet.descriptorCount = 1;
-        writeDescriptorSet.dstSet = set.GetDescriptorSet();
-        writeDescriptorSet.dstBinding = 0;
-        writeDescriptorSet.pBufferInfo = &bufferInfo;
+        std::array<VkWriteDescriptorSet, 2> writeDescriptorSets = {};
+        for (uint32_t b = 0; b < writeDescriptorSets.size(); b++)
+        {
+            writeDescriptorSets[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSets[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writeDescriptorSets[b].descriptorCount = 1;
+            writeDescriptorSets[b].dstSet = set.GetDescriptorSet();
+            writeDescriptorSets[b].dstBinding = b + 1;
+            writeDescriptorSets[b].pBufferInfo = &bufferInfos[b];
+        }
 
-        vkUpdateDescriptorSets(renderer.GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
+        vkUpdateDescriptorSets(renderer.GetDevice(), writeDescriptorSets.size(), writeDescriptorSets.data(), 0, nullptr);
+
+        ReserveLightSlots(ms_initialLightCapacity, i);
 
         i++;
     }
 }
 
+uint32_t LightComponentGlobalResource::AllocateLightSlot()
+{
+    // Reuse freed slots first to keep the buffer dense
+    if (!m_freeSlots.empty())
+    {
+        uint32_t const slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+
+    m_lights.push_back({});
+    m_dirtyFrames.push_back(0);
+    return m_lights.size() - 1;
+}
+
+void LightComponentGlobalResource::FreeLightSlot(uint32_t slot)
+{
+    m_freeSlots.push_back(slot);
+}
+
+void LightComponentGlobalResource::SetLightData(uint32_t slot, LightData const& data)
+{
+    if (memcmp(&m_lights[slot], &data, sizeof(LightData)) == 0)
+    {
+        return;
+    }
+
+    m_lights[slot] = data;
+    m_dirtyFrames[slot] = (1 << ResourceInFlight<Buffer>::FramesInFlight) - 1;
+}
+
+void LightComponentGlobalResource::UploadLights()
+{
+    uint8_t const frameIndex = Renderer::GetInstance().GetCurrentFrame();
+    uint8_t const frameBit = 1 << frameIndex;
+    ReserveLightSlots(m_lights.size(), frameIndex);
+
+    Buffer& buffer = m_lightBuffer[frameIndex];
+    LightData* mappedMemory = nullptr;
+    for (uint32_t slot = 0; slot < m_lights.size(); slot++)
+    {
+        if ((m_dirtyFrames[slot] & frameBit) == 0)
+        {
+            continue;
+        }
+
+        if (!mappedMemory)
+        {
+            mappedMemory = static_cast<LightData*>(buffer.MapMemory());
+        }
+
+        mappedMemory[slot] = m_lights[slot];
+        m_dirtyFrames[slot] &= ~frameBit;
+    }
+
+    if (mappedMemory)
+    {
+        buffer.UnmapMemory();
+    }
+}
+
+void LightComponentGlobalResource::ReserveLightSlots(uint32_t slotCount, uint8_t frameIndex)
+{
+    if (slotCount <= m_lightCapacity[frameIndex])
+    {
+        return;
+    }
+
+    uint32_t const capacity = std::max(slotCount, 2 * m_lightCapacity[frameIndex]);
+
+    BufferInfo bufferCreationInfo;
+    bufferCreationInfo.m_size = sizeof(LightData) * capacity;
+    bufferCreationInfo.m_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferCreationInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    m_lightBuffer[frameIndex] = Buffer(bufferCreationInfo);
+    m_lightCapacity[frameIndex] = capacity;
+
+    // The new buffer of this frame starts empty
+    for (uint8_t& dirtyFrames : m_dirtyFrames)
+    {
+        dirtyFrames |= 1 << frameIndex;
+    }
+
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = m_lightBuffer[frameIndex].GetBuffer();
+    bufferInfo.offset = 0;
+    bufferInfo.range = bufferCreationInfo.m_size;
+
+    VkWriteDescriptorSet writeDescriptorSet = {};
+    writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.dstSet = m_descriptorSet[frameIndex].GetDescriptorSet();
+    writeDescriptorSet.dstBinding = 0;
+    writeDescriptorSet.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(Renderer::GetInstance().GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
+}
+
+void LightGlobalResourceSystem::Init()
+{
+    GlobalResourceSystem<LightComponentGlobalResource>::Init();
+
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    entitySystem.AddOnConstructEvent<LightComponent, &LightGlobalResourceSystem::OnLightComponentCreated>(*this);
+    entitySystem.AddOnDestroyEvent<LightComponent, &LightGlobalResourceSystem::OnLightComponentDestroyed>(*this);
+}
+
+void LightGlobalResourceSystem::Terminate()
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    entitySystem.RemoveOnConstructEvent<LightComponent, &LightGlobalResourceSystem::OnLightComponentCreated>(*this);
+    entitySystem.RemoveOnDestroyEvent<LightComponent, &LightGlobalResourceSystem::OnLightComponentDestroyed>(*this);
+
+    GlobalResourceSystem<LightComponentGlobalResource>::Terminate();
+}
+
+void LightGlobalResourceSystem::OnLightComponentCreated(entt::registry&, entt::entity entity)
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    LightComponentGlobalResource& globalResource = entitySystem.GetComponent<LightComponentGlobalResource>(entitySystem.GetGlobalEntity());
+    entitySystem.AddComponent<LightComponentResource>(entity, globalResource.AllocateLightSlot());
+}
+
+void LightGlobalResourceSystem::OnLightComponentDestroyed(entt::registry&, entt::entity entity)
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    LightComponentGlobalResource& globalResource = entitySystem.GetComponent<LightComponentGlobalResource>(entitySystem.GetGlobalEntity());
+    globalResource.FreeLightSlot(entitySystem.GetComponent<LightComponentResource>(entity).GetLightSlot());
+    entitySystem.RemoveComponent<LightComponentResource>(entity);
+}
+
 void LightGlobalResourceSystem::Update()
 {
     EntitySystem& entitySystem = EntitySystem::GetInstance();
-    auto const& view = entitySystem.GetView<SceneComponent const, LightComponent const>();
-    
-    LightComponentGlobalResource::UniformData data;
+    LightComponentGlobalResource& globalResource = entitySystem.GetComponent<LightComponentGlobalResource>(entitySystem.GetGlobalEntity());
+    auto const& view = entitySystem.GetView<LightComponentResource const, LightComponent const, SceneComponent const>();
 
-    data.m_nrLights = 0;
-    for (entt::entity entity : view)
+    LightComponentGlobalResource::ClusterHeader header;
+    header.m_clusterCount = glm::uvec4(LightComponentGlobalResource::ms_clusterCountX, LightComponentGlobalResource::ms_clusterCountY, LightComponentGlobalResource::ms_clusterCountZ, 0);
+    header.m_clusterParameters = glm::vec4(0.0f);
+
+    m_clusterLightCounts.assign(LightComponentGlobalResource::ms_clusterCount, 0);
+    m_clusterLights.resize(LightComponentGlobalResource::ms_clusterCount * LightComponentGlobalResource::ms_maxLightsPerCluster);
+    m_unboundedLights.clear();
+
+    // Clusters are built in the view space of the camera
+    glm::mat4 viewMatrix = glm::mat4(1.0f);
+    auto const& cameraView = entitySystem.GetView<CameraComponent const, SceneComponent const>();
+    Entity const cameraEntity = cameraView.front();
+    bool const hasCamera = EntitySystem::IsEntityValid(cameraEntity);
+    if (hasCamera)
     {
-        if (data.m_nrLights >= LightComponentGlobalResource::ms_maxNumberOfLights)
-            break;
+        CameraComponent const& camera = cameraView.Get<CameraComponent const>(cameraEntity);
+        SceneComponent const& cameraScene = cameraView.Get<SceneComponent const>(cameraEntity);
+        viewMatrix = CameraComponent::GetViewMatrix(cameraScene.GetWorldTranslation(), cameraScene.GetWorldRotation());
 
-        SceneComponent const& scene = view.Get<SceneComponent const>(entity);
+        UpdateClusterBounds(camera.GetFieldOfVision(), camera.GetAspectRatio(), camera.GetNearPlane(), camera.GetFarPlane());
+
+        VkExtent2D const extent = Renderer::GetInstance().GetSwapchainExtent();
+        header.m_clusterParameters.x = static_cast<float>(LightComponentGlobalResource::ms_clusterCountX) / std::max(extent.width, 1u);
+        header.m_clusterParameters.y = static_cast<float>(LightComponentGlobalResource::ms_clusterCountY) / std::max(extent.height, 1u);
+        header.m_clusterParameters.z = m_clusterDepthScale;
+        header.m_clusterParameters.w = m_clusterDepthBias;
+    }
+
+    // Every light keeps its slot, only the ones that changed since the last upload to a buffer are written to it.
+    // Unbounded lights shade every fragment, the others only reach the clusters they overlap.
+    for (entt::entity entity : view)
+    {
+        uint32_t const slot = view.Get<LightComponentResource const>(entity).GetLightSlot();
         LightComponent const& light = view.Get<LightComponent const>(entity);
+        SceneComponent const& scene = view.Get<SceneComponent const>(entity);
+
+        LightComponentGlobalResource::LightData data;
+        FillLightData(data, light, scene);
+        data.m_color = glm::pow(light.m_color, glm::vec3(ms_colorGamma)); // Converted from sRGB once instead of per fragment
+        ShadowComponentResource const* shadow = entitySystem.TryGetComponent<ShadowComponentResource const>(entity);
+        data.m_shadowIndex = shadow ? shadow->m_firstShadowView : UINT32_MAX;
+        globalResource.SetLightData(slot, data);
 
-        data.m_lights[data.m_nrLights].m_color = glm::vec4(light.m_color, 1.0f);
-        data.m_lights[data.m_nrLights].m_worldPosition = glm::vec4(scene.GetWorldTranslation(), 1.0f);
-    
-        ++data.m_nrLights;
+        if (light.m_type == LightComponent::Type::Directional || light.m_range <= 0.0f)
+        {
+            m_unboundedLights.push_back(slot);
+        }
+        else if (hasCamera)
+        {
+            glm::vec3 viewPosition = glm::vec3(viewMatrix * glm::vec4(scene.GetWorldTranslation(), 1.0f));
+            viewPosition.z = -viewPosition.z;
+            AssignLightsToClusters(viewPosition, light.m_range, slot);
+        }
     }
 
-    LightComponentGlobalResource& globalResource = entitySystem.GetComponent<LightComponentGlobalResource>(entitySystem.GetGlobalEntity());
+    header.m_clusterCount.w = m_unboundedLights.size();
+
+    // The light buffers of this frame may still be read by the GPU
+    Renderer::GetInstance().WaitForCurrentFrameInFlight();
+    globalResource.UploadLights();
+
+    // Unbounded lights come first in the light index buffer, followed by the compacted lists of the clusters
+    Buffer& clusterBuffer = globalResource.m_clusterBuffer.GetResource();
+    Buffer& lightIndexBuffer = globalResource.m_lightIndexBuffer.GetResource();
+    uint8_t* mappedClusterMemory = static_cast<uint8_t*>(clusterBuffer.MapMemory());
+    uint32_t* mappedLightIndices = static_cast<uint32_t*>(lightIndexBuffer.MapMemory());
+
+    memcpy(mappedClusterMemory, &header, sizeof(header));
+    LightComponentGlobalResource::ClusterData* mappedClusters = reinterpret_cast<LightComponentGlobalResource::ClusterData*>(mappedClusterMemory + sizeof(header));
+
+    uint32_t lightIndexCount = std::min<uint32_t>(m_unboundedLights.size(), LightComponentGlobalResource::ms_maxClusterLightIndices);
+    memcpy(mappedLightIndices, m_unboundedLights.data(), sizeof(uint32_t) * lightIndexCount);
+
+    for (uint32_t cluster = 0; cluster < LightComponentGlobalResource::ms_clusterCount; cluster++)
+    {
+        uint32_t const clusterLightCount = std::min(m_clusterLightCounts[cluster], LightComponentGlobalResource::ms_maxClusterLightIndices - lightIndexCount);
+        memcpy(&mappedLightIndices[lightIndexCount], &m_clusterLights[cluster * LightComponentGlobalResource::ms_maxLightsPerCluster], sizeof(uint32_t) * clusterLightCount);
+
+        mappedClusters[cluster].m_firstLightIndex = lightIndexCount;
+        mappedClusters[cluster].m_lightCount = clusterLightCount;
+        lightIndexCount += clusterLightCount;
+    }
+
+    lightIndexBuffer.UnmapMemory();
+    clusterBuffer.UnmapMemory();
+}
+
+void LightGlobalResourceSystem::UpdateClusterBounds(float fov, float aspectRatio, float nearPlane, float farPlane)
+{
+    glm::vec4 const projection = glm::vec4(fov, aspectRatio, nearPlane, farPlane);
+    if (projection == m_clusterProjection)
+    {
+        return;
+    }
+
+    m_clusterProjection = projection;
 
-    Buffer& buffer = globalResource.m_uniformBuffer.GetResource();
-    LightComponentGlobalResource::UniformData* mappedMemory = static_cast<LightComponentGlobalResource::UniformData*>(buffer.MapMemory());
-    memcpy(&mappedMemory->m_nrLights, &data.m_nrLights, sizeof(data.m_nrLights));
-    memcpy(&mappedMemory->m_lights, &data.m_lights, sizeof(LightComponentGlobalResource::UniformData::LightUniformData) * data.m_nrLights);
-    buffer.UnmapMemory();
+    uint32_t const clusterCount = LightComponentGlobalResource::ms_clusterCount;
+    m_clusterMinimumX.resize(clusterCount);
+    m_clusterMinimumY.resize(clusterCount);
+    m_clusterMinimumDepth.resize(clusterCount);
+    m_clusterMaximumX.resize(clusterCount);
+    m_clusterMaximumY.resize(clusterCount);
+    m_clusterMaximumDepth.resize(clusterCount);
+
+    // Depth slices are spaced exponentially so that clusters keep a similar shape, slice = log(depth) * scale + bias
+    float const depthRatio = std::log(farPlane / nearPlane);
+    m_clusterDepthScale = LightComponentGlobalResource::ms_clusterCountZ / depthRatio;
+    m_clusterDepthBias = -LightComponentGlobalResource::ms_clusterCountZ * std::log(nearPlane) / depthRatio;
+    m_clusterNearPlane = nearPlane;
+
+    float const tanHalfHeight = std::tan(0.5f * fov);
+    float const tanHalfWidth = tanHalfHeight * aspectRatio;
+
+    uint32_t cluster = 0;
+    for (uint32_t z = 0; z < LightComponentGlobalResource::ms_clusterCountZ; z++)
+    {
+        float const nearDepth = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z) / LightComponentGlobalResource::ms_clusterCountZ);
+        float const farDepth = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z + 1) / LightComponentGlobalResource::ms_clusterCountZ);
+
+        for (uint32_t y = 0; y < LightComponentGlobalResource::ms_clusterCountY; y++)
+        {
+            // Rows start at the top of the screen, which is view space +Y
+            float const top = 1.0f - 2.0f * y / LightComponentGlobalResource::ms_clusterCountY;
+            float const bottom = 1.0f - 2.0f * (y + 1) / LightComponentGlobalResource::ms_clusterCountY;
+
+            for (uint32_t x = 0; x < LightComponentGlobalResource::ms_clusterCountX; x++)
+            {
+                float const left = -1.0f + 2.0f * x / LightComponentGlobalResource::ms_clusterCountX;
+                float const right = -1.0f + 2.0f * (x + 1) / LightComponentGlobalResource::ms_clusterCountX;
+
+                m_clusterMinimumX[cluster] = std::min(left * nearDepth, left * farDepth) * tanHalfWidth;
+                m_clusterMaximumX[cluster] = std::max(right * nearDepth, right * farDepth) * tanHalfWidth;
+                m_clusterMinimumY[cluster] = std::min(bottom * nearDepth, bottom * farDepth) * tanHalfHeight;
+                m_clusterMaximumY[cluster] = std::max(top * nearDepth, top * farDepth) * tanHalfHeight;
+                m_clusterMinimumDepth[cluster] = nearDepth;
+                m_clusterMaximumDepth[cluster] = farDepth;
+                cluster++;
+            }
+        }
+    }
+}
+
+void LightGlobalResourceSystem::AssignLightsToClusters(glm::vec3 const& viewPosition, float range, uint32_t lightSlot)
+{
+    if (viewPosition.z + range < m_clusterNearPlane)
+    {
+        return;
+    }
+
+    // Only the depth slices the light sphere overlaps are tested
+    auto const getSlice = [this](float depth) {
+        float const slice = std::log(std::max(depth, m_clusterNearPlane)) * m_clusterDepthScale + m_clusterDepthBias;
+        return std::min(static_cast<uint32_t>(std::max(slice, 0.0f)), LightComponentGlobalResource::ms_clusterCountZ - 1);
+    };
+
+    constexpr uint32_t clustersPerSlice = LightComponentGlobalResource::ms_clusterCountX * LightComponentGlobalResource::ms_clusterCountY;
+    uint32_t const firstCluster = getSlice(viewPosition.z - range) * clustersPerSlice;
+    uint32_t const lastCluster = (getSlice(viewPosition.z + range) + 1) * clustersPerSlice;
+
+    auto const addLight = [this, lightSlot](uint32_t cluster) {
+        uint32_t& count = m_clusterLightCounts[cluster];
+        if (count < LightComponentGlobalResource::ms_maxLightsPerCluster)
+        {
+            m_clusterLights[cluster * LightComponentGlobalResource::ms_maxLightsPerCluster + count] = lightSlot;
+            count++;
+        }
+    };
+
+#ifdef LIGHT_CLUSTERS_USE_SSE
+    // Sphere against box distance of four clusters at a time, a slice always holds a multiple of four clusters
+    static_assert(clustersPerSlice % 4 == 0);
+
+    __m128 const centerX = _mm_set1_ps(viewPosition.x);
+    __m128 const centerY = _mm_set1_ps(viewPosition.y);
+    __m128 const centerDepth = _mm_set1_ps(viewPosition.z);
+    __m128 const rangeSquared = _mm_set1_ps(range * range);
+    __m128 const zero = _mm_setzero_ps();
+
+    for (uint32_t cluster = firstCluster; cluster < lastCluster; cluster += 4)
+    {
+        __m128 const distanceX = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_clusterMinimumX[cluster]), centerX), _mm_sub_ps(centerX, _mm_loadu_ps(&m_clusterMaximumX[cluster]))), zero);
+        __m128 const distanceY = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_clusterMinimumY[cluster]), centerY), _mm_sub_ps(centerY, _mm_loadu_ps(&m_clusterMaximumY[cluster]))), zero);
+        __m128 const distanceDepth = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_clusterMinimumDepth[cluster]), centerDepth), _mm_sub_ps(centerDepth, _mm_loadu_ps(&m_clusterMaximumDepth[cluster]))), zero);
+        __m128 const distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(distanceX, distanceX), _mm_mul_ps(distanceY, distanceY)), _mm_mul_ps(distanceDepth, distanceDepth));
+
+        int const mask = _mm_movemask_ps(_mm_cmple_ps(distanceSquared, rangeSquared));
+        if (mask == 0)
+        {
+            continue;
+        }
+
+        for (uint32_t lane = 0; lane < 4; lane++)
+        {
+            if (mask & (1 << lane))
+            {
+                addLight(cluster + lane);
+            }
+        }
+    }
+#else
+    for (uint32_t cluster = firstCluster; cluster < lastCluster; cluster++)
+    {
+        float const distanceX = std::max({ m_clusterMinimumX[cluster] - viewPosition.x, viewPosition.x - m_clusterMaximumX[cluster], 0.0f });
+        float const distanceY = std::max({ m_clusterMinimumY[cluster] - viewPosition.y, viewPosition.y - m_clusterMaximumY[cluster], 0.0f });
+        float const distanceDepth = std::max({ m_clusterMinimumDepth[cluster] - viewPosition.z, viewPosition.z - m_clusterMaximumDepth[cluster], 0.0f });
+        if (distanceX * distanceX + distanceY * distanceY + distanceDepth * distanceDepth <= range * range)
+        {
+            addLight(cluster);
+        }
+    }
+#endif
+}
+
+static void FillLightData(LightComponentGlobalResource::LightData& lightData, LightComponent const& light, SceneComponent const& scene)
+{
+    lightData = {};
+    lightData.m_range = light.m_type == LightComponent::Type::Directional ? 0.0f : light.m_range;
+    lightData.m_worldPosition = scene.GetWorldTranslation();
+    lightData.m_type = static_cast<uint32_t>(light.m_type);
+    lightData.m_direction = glm::normalize(scene.GetWorldRotation() * glm::vec3(0.0f, 0.0f, -1.0f));
+
+    // Cone attenuation as in KHR_lights_punctual, point lights are left fully lit
+    lightData.m_spotAngleScale = 0.0f;
+    lightData.m_spotAngleOffset = 1.0f;
+    if (light.m_type == LightComponent::Type::Spot)
+    {
+        float const cosOuter = std::cos(light.m_outerConeAngle);
+        lightData.m_spotAngleScale = 1.0f / std::max(std::cos(light.m_innerConeAngle) - cosOuter, 0.001f);
+        lightData.m_spotAngleOffset = -cosOuter * lightData.m_spotAngleScale;
+    }
 }
@@ -11,38 +11,129 @@
 class LightComponent : public EntityComponent
 {
 public:
+    enum class Type : uint8_t
+    {
+        Point,
+        Spot,
+        Directional
+    };
+
+public:
+    Type m_type = Type::Point;
     glm::vec3 m_color{ 1.0f };
+    float m_range = 0.0f; // Distance at which the light fades out, zero is unbounded
+    float m_innerConeAngle = 0.0f; // Spot lights only, the direction is the -Z axis of the entity
+    float m_outerConeAngle = glm::quarter_pi<float>();
+    bool m_castsShadows = false;
+};
+
+// Slot of the light in the light buffer
+class LightComponentResource : public EntityComponent
+{
+public:
+    explicit LightComponentResource(uint32_t lightSlot) : m_lightSlot(lightSlot) {}
+
+    uint32_t GetLightSlot() const { return m_lightSlot; }
+
+private:
+    uint32_t m_lightSlot = 0;
 };
 
 class LightComponentGlobalResource : public ComponentResourceInFlight
 {
 public:
-    static constexpr uint32_t ms_maxNumberOfLights = 128;
+    // The view frustum is split in froxels, screen tiles subdivided exponentially in depth
+    static constexpr uint32_t ms_clusterCountX = 16;
+    static constexpr uint32_t ms_clusterCountY = 9;
+    static constexpr uint32_t ms_clusterCountZ = 24;
+    static constexpr uint32_t ms_clusterCount = ms_clusterCountX * ms_clusterCountY * ms_clusterCountZ;
+    static constexpr uint32_t ms_maxLightsPerCluster = 64;
+    static constexpr uint32_t ms_maxClusterLightIndices = ms_clusterCount * 16;
+
+    struct LightData
+    {
+        glm::vec3 m_color; // Linear
+        float m_range;
+        glm::vec3 m_worldPosition;
+        uint32_t m_type;
+        glm::vec3 m_direction;
+        float m_spotAngleScale;
+        float m_spotAngleOffset;
+        uint32_t m_shadowIndex; // First view in the shadow view buffer, UINT32_MAX when the light is not shadowed
+        float m_padding[2];
+    };
+
+    struct ClusterHeader
+    {
+        glm::uvec4 m_clusterCount; // w is the number of lights shading every cluster, listed first in the light index buffer
+        glm::vec4 m_clusterParameters; // Clusters per pixel in xy, depth slice scale and bias in zw
+    };
 
-    struct UniformData 
+    // Range of the light index buffer affecting a cluster
+    struct ClusterData
     {
-        struct LightUniformData
-        {
-            glm::vec4 m_color;
-            glm::vec4 m_worldPosition;
-        };
-
-        LightUniformData m_lights[ms_maxNumberOfLights];
-        uint32_t m_nrLights = 0;
+        uint32_t m_firstLightIndex;
+        uint32_t m_lightCount;
     };
 
 public:
     LightComponentGlobalResource();
+
+    uint32_t AllocateLightSlot();
+    void FreeLightSlot(uint32_t slot);
+    void SetLightData(uint32_t slot, LightData const& data);
+
+    // Grows the light buffer of the current frame and uploads the lights it misses
+    void UploadLights();
+
+private:
+    void ReserveLightSlots(uint32_t slotCount, uint8_t frameIndex);
     
 public:
-    ResourceInFlight<Buffer> m_uniformBuffer;
+    ResourceInFlight<Buffer> m_lightBuffer;
+    ResourceInFlight<Buffer> m_clusterBuffer;
+    ResourceInFlight<Buffer> m_lightIndexBuffer;
 
+    static constexpr uint32_t ms_initialLightCapacity = 128;
     static const std::vector<VkDescriptorSetLayoutBinding> ms_bindings;
+
+private:
+    ResourceInFlight<uint32_t> m_lightCapacity;
+    std::vector<LightData> m_lights; // Copy of every slot
+    std::vector<uint8_t> m_dirtyFrames; // One bit per frame in flight whose buffer misses the last change of the slot
+    std::vector<uint32_t> m_freeSlots;
 };
 
 class LightGlobalResourceSystem
     : public GlobalResourceSystem<LightComponentGlobalResource>, public Singleton<LightGlobalResourceSystem>
 {
 public:
+    void Init() override;
+    void Terminate() override;
     void Update() override;
+
+private:
+    void OnLightComponentCreated(entt::registry& registry, entt::entity entity);
+    void OnLightComponentDestroyed(entt::registry& registry, entt::entity entity);
+    void UpdateClusterBounds(float fov, float aspectRatio, float nearPlane, float farPlane);
+    void AssignLightsToClusters(glm::vec3 const& viewPosition, float range, uint32_t lightSlot);
+
+private:
+    // View space bounds of every cluster in structure of arrays layout, depth is positive away from the camera
+    std::vector<float> m_clusterMinimumX;
+    std::vector<float> m_clusterMinimumY;
+    std::vector<float> m_clusterMinimumDepth;
+    std::vector<float> m_clusterMaximumX;
+    std::vector<float> m_clusterMaximumY;
+    std::vector<float> m_clusterMaximumDepth;
+    glm::vec4 m_clusterProjection = glm::vec4(0.0f); // Projection the bounds were computed for
+    float m_clusterDepthScale = 0.0f;
+    float m_clusterDepthBias = 0.0f;
+    float m_clusterNearPlane = 0.0f;
+
+    std::vector<uint32_t> m_clusterLightCounts;
+    std::vector<uint32_t> m_clusterLights; // ms_maxLightsPerCluster entries per cluster
+    std::vector<uint32_t> m_unboundedLights;
+
+    static constexpr float ms_colorGamma = 2.2f; // Matches c_gamma in Pbr.frag
 };
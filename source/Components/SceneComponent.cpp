@@ -324,56 +324,171 @@ void SceneComponent::Transform::Scale(glm::vec3 const& scale)
     m_isMatrixDirty = true;
 }
 
-const std::vector<VkDescriptorSetLayoutBinding> SceneComponentResource::ms_bindings = {
-    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr }
+const std::vector<VkDescriptorSetLayoutBinding> SceneComponentGlobalResource::ms_bindings = {
+    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr } // world matrices
 };
 
-SceneComponentResource::SceneComponentResource(SceneComponent const&)
+SceneComponentGlobalResource::SceneComponentGlobalResource()
 {
+    m_transformCapacity = CreateResourceInFlight<uint32_t>(0u);
+    m_descriptorSet = CreateResourceInFlight<DescriptorSet>(SceneComponentGlobalResource::ms_bindings);
+
+    for (uint8_t i = 0; i < ResourceInFlight<Buffer>::FramesInFlight; i++)
+    {
+        ReserveTransformSlots(ms_initialTransformCapacity, i);
+    }
+}
+
+uint32_t SceneComponentGlobalResource::AllocateTransformSlot()
+{
+    // Reuse freed slots first to keep the buffer dense
+    if (!m_freeSlots.empty())
+    {
+        uint32_t const slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+
+    return m_slotCount++;
+}
+
+void SceneComponentGlobalResource::FreeTransformSlot(uint32_t slot)
+{
+    m_freeSlots.push_back(slot);
+}
+
+void SceneComponentGlobalResource::ReserveTransformSlots()
+{
+    ReserveTransformSlots(m_slotCount, Renderer::GetInstance().GetCurrentFrame());
+}
+
+void SceneComponentGlobalResource::ReserveTransformSlots(uint32_t slotCount, uint8_t frameIndex)
+{
+    if (slotCount <= m_transformCapacity[frameIndex])
+    {
+        return;
+    }
+
+    uint32_t const capacity = std::max(slotCount, 2 * m_transformCapacity[frameIndex]);
+
     BufferInfo bufferCreationInfo;
-    bufferCreationInfo.m_size = sizeof(UniformData);
-    bufferCreationInfo.m_usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    bufferCreationInfo.m_size = sizeof(glm::mat4) * capacity;
+    bufferCreationInfo.m_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
     bufferCreationInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-    m_uniformBuffer = CreateResourceInFlight<Buffer>(bufferCreationInfo);
-    m_descriptorSet = CreateResourceInFlight<DescriptorSet>(SceneComponentResource::ms_bindings);
+    m_transformBuffer[frameIndex] = Buffer(bufferCreationInfo);
+    m_transformCapacity[frameIndex] = capacity;
+
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = m_transformBuffer[frameIndex].GetBuffer();
+    bufferInfo.offset = 0;
+    bufferInfo.range = bufferCreationInfo.m_size;
+
+    VkWriteDescriptorSet writeDescriptorSet = {};
+    writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.dstSet = m_descriptorSet[frameIndex].GetDescriptorSet();
+    writeDescriptorSet.dstBinding = 0;
+    writeDescriptorSet.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(Renderer::GetInstance().GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
+}
+
+void SceneResourceSystem::Init()
+{
+    GlobalResourceSystem<SceneComponentGlobalResource>::Init();
+
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    entitySystem.AddOnConstructEvent<SceneComponent, &SceneResourceSystem::OnSceneComponentCreated>(*this);
+    entitySystem.AddOnDestroyEvent<SceneComponent, &SceneResourceSystem::OnSceneComponentDestroyed>(*this);
+    entitySystem.AddOnDestroyEvent<SceneInstancesComponent, &SceneResourceSystem::OnSceneInstancesComponentDestroyed>(*this);
+}
+
+void SceneResourceSystem::Terminate()
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    entitySystem.RemoveOnConstructEvent<SceneComponent, &SceneResourceSystem::OnSceneComponentCreated>(*this);
+    entitySystem.RemoveOnDestroyEvent<SceneComponent, &SceneResourceSystem::OnSceneComponentDestroyed>(*this);
+    entitySystem.RemoveOnDestroyEvent<SceneInstancesComponent, &SceneResourceSystem::OnSceneInstancesComponentDestroyed>(*this);
+
+    GlobalResourceSystem<SceneComponentGlobalResource>::Terminate();
+}
+
+void SceneResourceSystem::OnSceneComponentCreated(entt::registry&, entt::entity entity)
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    SceneComponentGlobalResource& globalResource = entitySystem.GetComponent<SceneComponentGlobalResource>(entitySystem.GetGlobalEntity());
+    entitySystem.AddComponent<SceneComponentResource>(entity, globalResource.AllocateTransformSlot());
+}
 
-    Renderer const& renderer = Renderer::GetInstance();
+void SceneResourceSystem::OnSceneComponentDestroyed(entt::registry&, entt::entity entity)
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    SceneComponentGlobalResource& globalResource = entitySystem.GetComponent<SceneComponentGlobalResource>(entitySystem.GetGlobalEntity());
+    globalResource.FreeTransformSlot(entitySystem.GetComponent<SceneComponentResource>(entity).GetTransformSlot());
+    entitySystem.RemoveComponent<SceneComponentResource>(entity);
+}
+
+void SceneResourceSystem::OnSceneInstancesComponentDestroyed(entt::registry&, entt::entity entity)
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    SceneComponentGlobalResource& globalResource = entitySystem.GetComponent<SceneComponentGlobalResource>(entitySystem.GetGlobalEntity());
 
-    uint8_t i = 0;
-    for (DescriptorSet& set : m_descriptorSet)
+    for (uint32_t const slot : entitySystem.GetComponent<SceneInstancesComponent>(entity).m_transformSlots)
     {
-        VkDescriptorBufferInfo bufferInfo = {};
-        bufferInfo.buffer = m_uniformBuffer[i].GetBuffer();
-        bufferInfo.offset = 0;
-        bufferInfo.range = sizeof(UniformData);
-
-        VkWriteDescriptorSet writeDescriptorSet = {};
-        writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        writeDescriptorSet.descriptorCount = 1;
-        writeDescriptorSet.dstSet = set.GetDescriptorSet();
-        writeDescriptorSet.dstBinding = 0;
-        writeDescriptorSet.pBufferInfo = &bufferInfo;
-
-        vkUpdateDescriptorSets(renderer.GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
-
-        i++;
+        globalResource.FreeTransformSlot(slot);
     }
 }
 
 void SceneResourceSystem::Update()
 {
     EntitySystem& entitySystem = EntitySystem::GetInstance();
-    auto const& view = entitySystem.GetView<SceneComponentResource, const SceneComponent>();
+    SceneComponentGlobalResource& globalResource = entitySystem.GetComponent<SceneComponentGlobalResource>(entitySystem.GetGlobalEntity());
+
+    // Every instance gets its own slot
+    auto const& instancesView = entitySystem.GetView<SceneInstancesComponent, SceneComponent const>();
+    for (entt::entity entity : instancesView)
+    {
+        SceneInstancesComponent& instances = instancesView.Get<SceneInstancesComponent>(entity);
+
+        while (instances.m_transformSlots.size() < instances.m_localTransforms.size())
+        {
+            instances.m_transformSlots.push_back(globalResource.AllocateTransformSlot());
+        }
+
+        while (instances.m_transformSlots.size() > instances.m_localTransforms.size())
+        {
+            globalResource.FreeTransformSlot(instances.m_transformSlots.back());
+            instances.m_transformSlots.pop_back();
+        }
+    }
+
+    // The transform buffer of this frame may still be read by the GPU
+    Renderer::GetInstance().WaitForCurrentFrameInFlight();
+    globalResource.ReserveTransformSlots();
+
+    Buffer& buffer = globalResource.m_transformBuffer.GetResource();
+    glm::mat4* mappedMemory = static_cast<glm::mat4*>(buffer.MapMemory());
+
+    auto const& view = entitySystem.GetView<SceneComponentResource const, SceneComponent const>();
     for (entt::entity entity : view)
     {
-        SceneComponentResource& resourceComponent = view.Get<SceneComponentResource>(entity);
-        SceneComponent const& sceneComponent = view.Get<const SceneComponent>(entity);
+        SceneComponentResource const& resourceComponent = view.Get<SceneComponentResource const>(entity);
+        SceneComponent const& sceneComponent = view.Get<SceneComponent const>(entity);
+
+        mappedMemory[resourceComponent.GetTransformSlot()] = sceneComponent.GetWorldMatrix();
+    }
 
-        SceneComponentResource::UniformData data;
-        data.m_worldMatrix = sceneComponent.GetWorldMatrix();
+    for (entt::entity entity : instancesView)
+    {
+        SceneInstancesComponent const& instances = instancesView.Get<SceneInstancesComponent>(entity);
+        glm::mat4 const& worldMatrix = instancesView.Get<SceneComponent const>(entity).GetWorldMatrix();
 
-        Buffer& buffer = resourceComponent.m_uniformBuffer.GetResource();
-        buffer.CopyDataToBuffer(&data, sizeof(SceneComponentResource::UniformData));
+        for (size_t i = 0; i < instances.m_localTransforms.size(); i++)
+        {
+            mappedMemory[instances.m_transformSlots[i]] = worldMatrix * instances.m_localTransforms[i];
+        }
     }
+
+    buffer.UnmapMemory();
 }
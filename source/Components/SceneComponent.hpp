@@ -93,25 +93,62 @@ private:
     std::vector<entt::entity> m_children;
 };
 
-class SceneComponentResource : public ComponentResourceInFlight
+// Extra instances of the entity, relative to its transform (EXT_mesh_gpu_instancing)
+class SceneInstancesComponent : public EntityComponent
 {
 public:
-    struct UniformData 
-    {
-        glm::mat4 m_worldMatrix;
-    };
+    std::vector<glm::mat4> m_localTransforms;
+    std::vector<uint32_t> m_transformSlots; // Managed by the SceneResourceSystem
+};
+
+// Slot of the entity world matrix in the transform buffer
+class SceneComponentResource : public EntityComponent
+{
+public:
+    explicit SceneComponentResource(uint32_t transformSlot) : m_transformSlot(transformSlot) {}
+
+    uint32_t GetTransformSlot() const { return m_transformSlot; }
+
+private:
+    uint32_t m_transformSlot = 0;
+};
 
+class SceneComponentGlobalResource : public ComponentResourceInFlight
+{
 public:
-    SceneComponentResource(SceneComponent const& scene);
-    
+    SceneComponentGlobalResource();
+
+    uint32_t AllocateTransformSlot();
+    void FreeTransformSlot(uint32_t slot);
+    uint32_t GetTransformSlotCount() const { return m_slotCount; }
+
+    // Grows the transform buffer of the current frame to hold every allocated slot
+    void ReserveTransformSlots();
+
+private:
+    void ReserveTransformSlots(uint32_t slotCount, uint8_t frameIndex);
+
 public:
-    ResourceInFlight<Buffer> m_uniformBuffer;
+    ResourceInFlight<Buffer> m_transformBuffer;
 
+    static constexpr uint32_t ms_initialTransformCapacity = 1024;
     static const std::vector<VkDescriptorSetLayoutBinding> ms_bindings;
+
+private:
+    ResourceInFlight<uint32_t> m_transformCapacity;
+    std::vector<uint32_t> m_freeSlots;
+    uint32_t m_slotCount = 0;
 };
 
-class SceneResourceSystem : public ResourceSystem<SceneComponent, SceneComponentResource>, public Singleton<SceneResourceSystem>
+class SceneResourceSystem : public GlobalResourceSystem<SceneComponentGlobalResource>, public Singleton<SceneResourceSystem>
 {
 public:
+    void Init() override;
+    void Terminate() override;
     void Update() override;
+
+private:
+    void OnSceneComponentCreated(entt::registry& registry, entt::entity entity);
+    void OnSceneComponentDestroyed(entt::registry& registry, entt::entity entity);
+    void OnSceneInstancesComponentDestroyed(entt::registry& registry, entt::entity entity);
 };
@@ -0,0 +1,515 @@
+#include <Components/ShadowComponent.hpp>
+
+#include <Components/CameraComponent.hpp>
+#include <Components/LightComponent.hpp>
+#include <Components/SceneComponent.hpp>
+#include <Components/SkyboxComponent.hpp>
+#include <Components/StaticMeshComponent.hpp>
+#include <Resources/TextureResource.hpp>
+#include <Systems/EntitySystem.hpp>
+#include <Systems/Renderer.hpp>
+
+static glm::vec4 GetCasterBounds(MeshAsset const& meshAsset, glm::mat4 const& worldMatrix, SceneInstancesComponent const* sceneInstances);
+static bool IsSphereInFrustum(glm::mat4 const& viewProjection, glm::vec4 const& sphere);
+
+const std::vector<VkDescriptorSetLayoutBinding> ShadowComponentGlobalResource::ms_bindings = {
+    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }, // Shadow views
+    { 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr } // Shadow atlas
+};
+
+ShadowComponentGlobalResource::ShadowComponentGlobalResource()
+{
+    m_shadowViewCapacity = CreateResourceInFlight<uint32_t>(0u);
+    m_descriptorSet = CreateResourceInFlight<DescriptorSet>(ShadowComponentGlobalResource::ms_bindings);
+
+    for (uint8_t i = 0; i < ResourceInFlight<Buffer>::FramesInFlight; i++)
+    {
+        ReserveShadowViews(ms_initialShadowViewCapacity, i);
+    }
+}
+
+void ShadowComponentGlobalResource::SetShadowAtlas(TextureResource& atlas)
+{
+    if (m_shadowAtlas.get() == &atlas)
+    {
+        return;
+    }
+
+    m_shadowAtlas = atlas.GetSharedPtr();
+    VkDescriptorImageInfo descriptorInfo = m_shadowAtlas->GetDescriptorInfo();
+    descriptorInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    Renderer const& renderer = Renderer::GetInstance();
+    for (DescriptorSet& set : m_descriptorSet)
+    {
+        VkWriteDescriptorSet writeDescriptorSet = {};
+        writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writeDescriptorSet.descriptorCount = 1;
+        writeDescriptorSet.dstSet = set.GetDescriptorSet();
+        writeDescriptorSet.dstBinding = 1;
+        writeDescriptorSet.pImageInfo = &descriptorInfo;
+
+        vkUpdateDescriptorSets(renderer.GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
+    }
+}
+
+void ShadowComponentGlobalResource::ReserveShadowViews(uint32_t viewCount)
+{
+    ReserveShadowViews(viewCount, Renderer::GetInstance().GetCurrentFrame());
+}
+
+void ShadowComponentGlobalResource::ReserveShadowViews(uint32_t viewCount, uint8_t frameIndex)
+{
+    if (viewCount <= m_shadowViewCapacity[frameIndex])
+    {
+        return;
+    }
+
+    uint32_t const capacity = std::max(viewCount, 2 * m_shadowViewCapacity[frameIndex]);
+
+    BufferInfo bufferCreationInfo;
+    bufferCreationInfo.m_size = sizeof(ShadowHeader) + sizeof(ShadowViewData) * capacity;
+    bufferCreationInfo.m_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferCreationInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    m_shadowViewBuffer[frameIndex] = Buffer(bufferCreationInfo);
+    m_shadowViewCapacity[frameIndex] = capacity;
+
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = m_shadowViewBuffer[frameIndex].GetBuffer();
+    bufferInfo.offset = 0;
+    bufferInfo.range = bufferCreationInfo.m_size;
+
+    VkWriteDescriptorSet writeDescriptorSet = {};
+    writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.dstSet = m_descriptorSet[frameIndex].GetDescriptorSet();
+    writeDescriptorSet.dstBinding = 0;
+    writeDescriptorSet.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(Renderer::GetInstance().GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
+}
+
+void ShadowResourceSystem::Init()
+{
+    GlobalResourceSystem<ShadowComponentGlobalResource>::Init();
+
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    entitySystem.AddOnDestroyEvent<ShadowComponentResource, &ShadowResourceSystem::OnShadowComponentDestroyed>(*this);
+}
+
+void ShadowResourceSystem::Terminate()
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    entitySystem.RemoveOnDestroyEvent<ShadowComponentResource, &ShadowResourceSystem::OnShadowComponentDestroyed>(*this);
+
+    m_casters.clear();
+
+    GlobalResourceSystem<ShadowComponentGlobalResource>::Terminate();
+}
+
+void ShadowResourceSystem::OnShadowComponentDestroyed(entt::registry&, entt::entity entity)
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    ShadowComponentGlobalResource& globalResource = entitySystem.GetComponent<ShadowComponentGlobalResource>(entitySystem.GetGlobalEntity());
+    for (ShadowComponentResource::Tile const& tile : entitySystem.GetComponent<ShadowComponentResource const>(entity).m_tiles)
+    {
+        globalResource.m_atlas.Free(tile.m_atlasTile);
+    }
+}
+
+void ShadowResourceSystem::Update()
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    ShadowComponentGlobalResource& globalResource = entitySystem.GetComponent<ShadowComponentGlobalResource>(entitySystem.GetGlobalEntity());
+
+    m_frame++;
+
+    // Cascades and tile sizes follow the camera
+    auto const& cameraView = entitySystem.GetView<CameraComponent const, SceneComponent const>();
+    Entity const cameraEntity = cameraView.front();
+    m_hasCamera = EntitySystem::IsEntityValid(cameraEntity);
+    if (m_hasCamera)
+    {
+        CameraComponent const& camera = cameraView.Get<CameraComponent const>(cameraEntity);
+        SceneComponent const& cameraScene = cameraView.Get<SceneComponent const>(cameraEntity);
+        m_cameraPosition = cameraScene.GetWorldTranslation();
+        m_cameraRotation = cameraScene.GetWorldRotation();
+        m_cameraFov = camera.GetFieldOfVision();
+        m_cameraAspectRatio = camera.GetAspectRatio();
+        m_pixelsPerUnit = Renderer::GetInstance().GetSwapchainExtent().height / (2.0f * std::tan(0.5f * m_cameraFov));
+        UpdateCascadeSplits(camera.GetNearPlane(), std::min(camera.GetFarPlane(), ms_shadowDistance));
+    }
+
+    UpdateMovedCasters();
+
+    // Lights that stopped casting shadows give their tiles back, new shadow casters get theirs below
+    std::vector<Entity> removedShadows;
+    for (Entity entity : entitySystem.GetView<ShadowComponentResource const>())
+    {
+        LightComponent const* light = entitySystem.TryGetComponent<LightComponent const>(entity);
+        if (!light || !light->m_castsShadows)
+        {
+            removedShadows.push_back(entity);
+        }
+    }
+
+    for (Entity entity : removedShadows)
+    {
+        entitySystem.RemoveComponent<ShadowComponentResource>(entity);
+    }
+
+    std::vector<Entity> addedShadows;
+    for (Entity entity : entitySystem.GetView<LightComponent const, SceneComponent const>(entt::exclude_t<ShadowComponentResource>()))
+    {
+        if (entitySystem.GetComponent<LightComponent const>(entity).m_castsShadows)
+        {
+            addedShadows.push_back(entity);
+        }
+    }
+
+    for (Entity entity : addedShadows)
+    {
+        entitySystem.AddComponent<ShadowComponentResource>(entity);
+    }
+
+    auto const& view = entitySystem.GetView<ShadowComponentResource, LightComponent const, SceneComponent const>();
+
+    // Tiles whose view changed or saw a caster move are re-rendered, the others keep their cached depth
+    struct TileCandidate
+    {
+        ShadowComponentResource::Tile* m_tile;
+        uint64_t m_renderedFrame;
+    };
+    std::vector<TileCandidate> candidates;
+
+    for (Entity entity : view)
+    {
+        ShadowComponentResource& shadow = view.Get<ShadowComponentResource>(entity);
+        UpdateLightTiles(shadow, view.Get<LightComponent const>(entity), view.Get<SceneComponent const>(entity));
+
+        for (ShadowComponentResource::Tile& tile : shadow.m_tiles)
+        {
+            if (tile.m_renderedFrame > 0 && !tile.m_isDirty && tile.m_viewProjection == tile.m_renderedViewProjection)
+            {
+                for (glm::vec4 const& bounds : m_movedCasterBounds)
+                {
+                    if (IsSphereInFrustum(tile.m_renderedViewProjection, bounds))
+                    {
+                        tile.m_isDirty = true;
+                        break;
+                    }
+                }
+            }
+
+            if (tile.m_renderedFrame == 0 || tile.m_isDirty || tile.m_viewProjection != tile.m_renderedViewProjection)
+            {
+                candidates.push_back({ &tile, tile.m_renderedFrame });
+            }
+        }
+    }
+
+    // Only a few tiles are rendered per frame, missing ones first then the stalest.
+    // Tiles that wait keep being sampled with the view their depth was rendered with.
+    uint32_t const renderCount = std::min<uint32_t>(candidates.size(), ms_maxTileRendersPerFrame);
+    std::partial_sort(candidates.begin(), candidates.begin() + renderCount, candidates.end(),
+        [](TileCandidate const& a, TileCandidate const& b) { return a.m_renderedFrame < b.m_renderedFrame; });
+
+    globalResource.m_tileRenders.clear();
+    for (uint32_t i = 0; i < renderCount; i++)
+    {
+        ShadowComponentResource::Tile& tile = *candidates[i].m_tile;
+        globalResource.m_tileRenders.push_back({ tile.m_atlasTile, tile.m_viewProjection });
+        tile.m_renderedViewProjection = tile.m_viewProjection;
+        tile.m_renderedFrame = m_frame;
+        tile.m_isDirty = false;
+    }
+
+    // A light is only shadowed once all of its tiles hold depth
+    std::vector<ShadowComponentGlobalResource::ShadowViewData> shadowViews;
+    float const atlasScale = 1.0f / globalResource.m_atlas.GetSize();
+    for (Entity entity : view)
+    {
+        ShadowComponentResource& shadow = view.Get<ShadowComponentResource>(entity);
+        bool const isComplete = !shadow.m_tiles.empty() && std::all_of(shadow.m_tiles.begin(), shadow.m_tiles.end(),
+            [](ShadowComponentResource::Tile const& tile) { return tile.m_renderedFrame > 0; });
+
+        shadow.m_firstShadowView = isComplete ? shadowViews.size() : UINT32_MAX;
+        if (!isComplete)
+        {
+            continue;
+        }
+
+        for (ShadowComponentResource::Tile const& tile : shadow.m_tiles)
+        {
+            ShadowAtlasTile const& atlasTile = tile.m_atlasTile;
+            shadowViews.push_back({ tile.m_renderedViewProjection, glm::vec4(atlasTile.m_x, atlasTile.m_y, atlasTile.m_size, atlasTile.m_size) * atlasScale });
+        }
+    }
+
+    ShadowComponentGlobalResource::ShadowHeader header;
+    header.m_cascadeSplits = glm::vec4(m_cascadeSplits[1], m_cascadeSplits[2], m_cascadeSplits[3], m_cascadeSplits[4]);
+
+    // The shadow view buffer of this frame may still be read by the GPU
+    Renderer::GetInstance().WaitForCurrentFrameInFlight();
+    globalResource.ReserveShadowViews(shadowViews.size());
+
+    Buffer& buffer = globalResource.m_shadowViewBuffer.GetResource();
+    uint8_t* mappedMemory = static_cast<uint8_t*>(buffer.MapMemory());
+    memcpy(mappedMemory, &header, sizeof(header));
+    memcpy(mappedMemory + sizeof(header), shadowViews.data(), sizeof(ShadowComponentGlobalResource::ShadowViewData) * shadowViews.size());
+    buffer.UnmapMemory();
+}
+
+void ShadowResourceSystem::UpdateMovedCasters()
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    m_movedCasterBounds.clear();
+
+    auto const& view = entitySystem.GetView<StaticMeshComponent const, SceneComponent const>(entt::exclude_t<SkyboxComponent>());
+    for (Entity entity : view)
+    {
+        StaticMeshComponent const& staticMesh = view.Get<StaticMeshComponent const>(entity);
+        if (!staticMesh.GetMeshAsset())
+        {
+            continue;
+        }
+
+        glm::mat4 const& worldMatrix = view.Get<SceneComponent const>(entity).GetWorldMatrix();
+        auto const& [it, isNewCaster] = m_casters.try_emplace(entity);
+        CasterState& caster = it->second;
+        caster.m_lastSeenFrame = m_frame;
+
+        if (!isNewCaster && caster.m_worldMatrix == worldMatrix)
+        {
+            continue;
+        }
+
+        // Both where the caster was and where it is now need new shadows
+        if (!isNewCaster)
+        {
+            m_movedCasterBounds.push_back(caster.m_bounds);
+        }
+
+        caster.m_worldMatrix = worldMatrix;
+        caster.m_bounds = GetCasterBounds(*staticMesh.GetMeshAsset(), worldMatrix, entitySystem.TryGetComponent<SceneInstancesComponent const>(entity));
+        m_movedCasterBounds.push_back(caster.m_bounds);
+    }
+
+    // Removed casters leave a hole in the shadows they were part of
+    for (auto it = m_casters.begin(); it != m_casters.end();)
+    {
+        if (it->second.m_lastSeenFrame != m_frame)
+        {
+            m_movedCasterBounds.push_back(it->second.m_bounds);
+            it = m_casters.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void ShadowResourceSystem::UpdateCascadeSplits(float nearPlane, float farPlane)
+{
+    // Practical split scheme, logarithmic splits blended with uniform ones
+    m_cascadeSplits[0] = nearPlane;
+    for (uint32_t i = 1; i <= ms_cascadeCount; i++)
+    {
+        float const ratio = static_cast<float>(i) / ms_cascadeCount;
+        float const logarithmicSplit = nearPlane * std::pow(farPlane / nearPlane, ratio);
+        float const uniformSplit = nearPlane + (farPlane - nearPlane) * ratio;
+        m_cascadeSplits[i] = glm::mix(uniformSplit, logarithmicSplit, ms_cascadeSplitLambda);
+    }
+}
+
+void ShadowResourceSystem::UpdateLightTiles(ShadowComponentResource& shadow, LightComponent const& light, SceneComponent const& scene)
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    ShadowAtlas& atlas = entitySystem.GetComponent<ShadowComponentGlobalResource>(entitySystem.GetGlobalEntity()).m_atlas;
+
+    uint32_t tileCount = 1;
+    uint32_t tileSize = ms_cascadeTileSize;
+    uint32_t const currentTileSize = shadow.m_tiles.empty() ? 0 : shadow.m_tiles.front().m_atlasTile.m_size;
+
+    if (light.m_type == LightComponent::Type::Directional)
+    {
+        tileCount = ms_cascadeCount;
+    }
+    else
+    {
+        tileCount = light.m_type == LightComponent::Type::Point ? 6 : 1;
+        tileSize = GetLightTileSize(light, scene, currentTileSize);
+    }
+
+    // Tiles are reallocated when the light needs a different resolution, their cached depth is lost
+    if (shadow.m_tiles.size() != tileCount || currentTileSize != tileSize)
+    {
+        for (ShadowComponentResource::Tile const& tile : shadow.m_tiles)
+        {
+            atlas.Free(tile.m_atlasTile);
+        }
+
+        shadow.m_tiles.assign(tileCount, {});
+        for (ShadowComponentResource::Tile& tile : shadow.m_tiles)
+        {
+            tile.m_atlasTile = atlas.Allocate(tileSize);
+            if (!tile.m_atlasTile.IsValid())
+            {
+                // The atlas is full, the light stays unshadowed until tiles are freed
+                for (ShadowComponentResource::Tile const& allocatedTile : shadow.m_tiles)
+                {
+                    atlas.Free(allocatedTile.m_atlasTile);
+                }
+
+                shadow.m_tiles.clear();
+                return;
+            }
+        }
+    }
+
+    glm::vec3 const position = scene.GetWorldTranslation();
+    glm::vec3 const direction = glm::normalize(scene.GetWorldRotation() * glm::vec3(0.0f, 0.0f, -1.0f));
+    float const range = light.m_range > 0.0f ? light.m_range : ms_defaultShadowRange;
+
+    if (light.m_type == LightComponent::Type::Point)
+    {
+        // Cube faces in the order the shading pass picks them from the major axis
+        static const std::array<glm::vec3, 6> faceDirections = {
+            glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+            glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+            glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+        };
+        static const std::array<glm::vec3, 6> faceUps = {
+            glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+            glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+            glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)
+        };
+
+        glm::mat4 const projection = glm::perspective(glm::half_pi<float>(), 1.0f, ms_shadowNearPlane, range);
+        for (uint32_t face = 0; face < faceDirections.size(); face++)
+        {
+            shadow.m_tiles[face].m_viewProjection = projection * glm::lookAt(position, position + faceDirections[face], faceUps[face]);
+        }
+    }
+    else if (light.m_type == LightComponent::Type::Spot)
+    {
+        glm::vec3 const up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        float const fov = std::min(2.0f * light.m_outerConeAngle, glm::radians(170.0f));
+        shadow.m_tiles[0].m_viewProjection = glm::perspective(fov, 1.0f, ms_shadowNearPlane, range) * glm::lookAt(position, position + direction, up);
+    }
+    else if (m_hasCamera)
+    {
+        glm::vec3 const up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        float const tanHalfHeight = std::tan(0.5f * m_cameraFov);
+        float const tanHalfWidth = tanHalfHeight * m_cameraAspectRatio;
+
+        for (uint32_t cascade = 0; cascade < ms_cascadeCount; cascade++)
+        {
+            // Bounding sphere of the cascade slice of the view frustum, its radius does not change when the camera rotates
+            std::array<glm::vec3, 8> corners;
+            glm::vec3 viewCenter = glm::vec3(0.0f);
+            for (uint32_t c = 0; c < corners.size(); c++)
+            {
+                float const depth = m_cascadeSplits[cascade + (c >> 2)];
+                corners[c] = glm::vec3((c & 1 ? 1.0f : -1.0f) * depth * tanHalfWidth, (c & 2 ? 1.0f : -1.0f) * depth * tanHalfHeight, -depth);
+                viewCenter += corners[c] / static_cast<float>(corners.size());
+            }
+
+            float radius = 0.0f;
+            for (glm::vec3 const& corner : corners)
+            {
+                radius = std::max(radius, glm::distance(corner, viewCenter));
+            }
+            radius = std::ceil(radius * 16.0f) / 16.0f;
+
+            glm::vec3 const center = m_cameraPosition + m_cameraRotation * viewCenter;
+            glm::mat4 const view = glm::lookAt(center, center + direction, up);
+            glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, -radius - ms_casterDistance, radius);
+
+            // Snap to whole texels so the cascade does not shimmer as the camera moves
+            float const halfTileSize = 0.5f * ms_cascadeTileSize;
+            glm::vec2 const origin = glm::vec2(projection * view * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)) * halfTileSize;
+            glm::vec2 const offset = (glm::round(origin) - origin) / halfTileSize;
+            projection[3][0] += offset.x;
+            projection[3][1] += offset.y;
+
+            shadow.m_tiles[cascade].m_viewProjection = projection * view;
+        }
+    }
+}
+
+uint32_t ShadowResourceSystem::GetLightTileSize(LightComponent const& light, SceneComponent const& scene, uint32_t currentSize) const
+{
+    if (!m_hasCamera)
+    {
+        return std::max(currentSize, ShadowComponentGlobalResource::ms_minTileSize);
+    }
+
+    // Resolution follows the diameter the light influence covers on screen
+    float const range = light.m_range > 0.0f ? light.m_range : ms_defaultShadowRange;
+    float const distance = glm::distance(m_cameraPosition, scene.GetWorldTranslation());
+    float const coverage = distance > range ? 2.0f * range * m_pixelsPerUnit / distance : static_cast<float>(ms_maxTileSize);
+    uint32_t const size = std::clamp(std::bit_ceil(static_cast<uint32_t>(coverage)), ShadowComponentGlobalResource::ms_minTileSize, ms_maxTileSize);
+
+    // Grow at once but only shrink once four times too large, so a light near the threshold keeps its cached tiles
+    if (size < currentSize && size * 4 > currentSize)
+    {
+        return currentSize;
+    }
+
+    return size;
+}
+
+static glm::vec4 GetCasterBounds(MeshAsset const& meshAsset, glm::mat4 const& worldMatrix, SceneInstancesComponent const* sceneInstances)
+{
+    auto const transformBounds = [&meshAsset](glm::mat4 const& matrix) {
+        float const scale = std::max({ glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2])) });
+        return glm::vec4(glm::vec3(matrix * glm::vec4(meshAsset.GetBoundsCenter(), 1.0f)), meshAsset.GetBoundsRadius() * scale);
+    };
+
+    if (!sceneInstances || sceneInstances->m_localTransforms.empty())
+    {
+        return transformBounds(worldMatrix);
+    }
+
+    // Sphere around the spheres of every instance
+    std::vector<glm::vec4> instanceBounds;
+    instanceBounds.reserve(sceneInstances->m_localTransforms.size());
+    glm::vec3 center = glm::vec3(0.0f);
+    for (glm::mat4 const& localTransform : sceneInstances->m_localTransforms)
+    {
+        instanceBounds.push_back(transformBounds(worldMatrix * localTransform));
+        center += glm::vec3(instanceBounds.back()) / static_cast<float>(sceneInstances->m_localTransforms.size());
+    }
+
+    float radius = 0.0f;
+    for (glm::vec4 const& bounds : instanceBounds)
+    {
+        radius = std::max(radius, glm::distance(center, glm::vec3(bounds)) + bounds.w);
+    }
+
+    return glm::vec4(center, radius);
+}
+
+static bool IsSphereInFrustum(glm::mat4 const& viewProjection, glm::vec4 const& sphere)
+{
+    glm::vec4 const rows[] = {
+        glm::vec4(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]),
+        glm::vec4(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]),
+        glm::vec4(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]),
+        glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3])
+    };
+
+    for (glm::vec4 const& plane : { rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[2], rows[3] - rows[2] })
+    {
+        if (glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w < -sphere.w * glm::length(glm::vec3(plane)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
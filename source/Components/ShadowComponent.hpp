@@ -0,0 +1,131 @@
+#pragma once
+
+#include <Components/EntityComponent.hpp>
+#include <Resources/Buffer.hpp>
+#include <Resources/Descriptor.hpp>
+#include <Resources/ResourceComponent.hpp>
+#include <Resources/ResourceInFlight.hpp>
+#include <Systems/ResourceSystem.hpp>
+#include <Utilities/Helpers.hpp>
+#include <Utilities/ShadowAtlas.hpp>
+#include <Utilities/Singleton.hpp>
+
+class LightComponent;
+class SceneComponent;
+class TextureResource;
+
+// Atlas tiles of a shadow casting light, managed by the ShadowResourceSystem.
+// Directional lights have one tile per cascade, point lights one per cube face and spot lights a single one.
+class ShadowComponentResource : public EntityComponent
+{
+public:
+    struct Tile
+    {
+        ShadowAtlasTile m_atlasTile;
+        glm::mat4 m_viewProjection{ 1.0f }; // Wanted this frame
+        glm::mat4 m_renderedViewProjection{ 1.0f }; // The atlas tile holds the depth rendered with it
+        uint64_t m_renderedFrame = 0; // Zero until first rendered
+        bool m_isDirty = false; // A caster moved in its view since it was rendered
+    };
+
+    std::vector<Tile> m_tiles;
+    uint32_t m_firstShadowView = UINT32_MAX; // In the shadow view buffer, only valid once every tile has been rendered
+};
+
+class ShadowComponentGlobalResource : public ComponentResourceInFlight
+{
+public:
+    struct ShadowHeader
+    {
+        glm::vec4 m_cascadeSplits; // View depth at which each cascade of directional lights ends
+    };
+
+    // How the shading pass samples a tile
+    struct ShadowViewData
+    {
+        glm::mat4 m_viewProjection;
+        glm::vec4 m_atlasRect; // Offset and size in atlas UVs
+    };
+
+    // Tile the shadow pass renders this frame
+    struct TileRender
+    {
+        ShadowAtlasTile m_atlasTile;
+        glm::mat4 m_viewProjection;
+    };
+
+public:
+    ShadowComponentGlobalResource();
+
+    void SetShadowAtlas(TextureResource& atlas);
+    bool HasShadowAtlas() const { return m_shadowAtlas != nullptr; }
+
+    // Grows the shadow view buffer of the current frame
+    void ReserveShadowViews(uint32_t viewCount);
+
+private:
+    void ReserveShadowViews(uint32_t viewCount, uint8_t frameIndex);
+
+public:
+    ResourceInFlight<Buffer> m_shadowViewBuffer;
+    std::vector<TileRender> m_tileRenders;
+
+    static constexpr uint32_t ms_atlasSize = 4096;
+    static constexpr uint32_t ms_minTileSize = 128;
+    static constexpr uint32_t ms_initialShadowViewCapacity = 64;
+    static const std::vector<VkDescriptorSetLayoutBinding> ms_bindings;
+
+    ShadowAtlas m_atlas{ ms_atlasSize, ms_minTileSize };
+
+private:
+    ResourceInFlight<uint32_t> m_shadowViewCapacity;
+    SharedPtr<TextureResource> m_shadowAtlas = nullptr;
+};
+
+class ShadowResourceSystem
+    : public GlobalResourceSystem<ShadowComponentGlobalResource>, public Singleton<ShadowResourceSystem>
+{
+public:
+    void Init() override;
+    void Terminate() override;
+    void Update() override;
+
+private:
+    // Bounding sphere of a shadow caster, xyz is the world center and w the radius
+    struct CasterState
+    {
+        glm::mat4 m_worldMatrix;
+        glm::vec4 m_bounds;
+        uint64_t m_lastSeenFrame = 0;
+    };
+
+    void OnShadowComponentDestroyed(entt::registry& registry, entt::entity entity);
+    void UpdateMovedCasters();
+    void UpdateCascadeSplits(float nearPlane, float farPlane);
+    void UpdateLightTiles(ShadowComponentResource& shadow, LightComponent const& light, SceneComponent const& scene);
+    uint32_t GetLightTileSize(LightComponent const& light, SceneComponent const& scene, uint32_t currentSize) const;
+
+private:
+    std::unordered_map<entt::entity, CasterState> m_casters;
+    std::vector<glm::vec4> m_movedCasterBounds; // Old and new bounds of the casters that changed this frame
+    uint64_t m_frame = 0;
+
+    // Camera the cascades and tile sizes are computed for
+    bool m_hasCamera = false;
+    glm::vec3 m_cameraPosition{ 0.0f };
+    glm::quat m_cameraRotation = glm::identity<glm::quat>();
+    float m_cameraFov = 0.0f;
+    float m_cameraAspectRatio = 1.0f;
+    float m_pixelsPerUnit = 0.0f; // Screen pixels covered by one world unit at distance one
+    std::array<float, 5> m_cascadeSplits = {}; // Near plane then the far depth of each cascade
+
+    static constexpr uint32_t ms_cascadeCount = 4;
+    static constexpr uint32_t ms_cascadeTileSize = 1024;
+    static constexpr uint32_t ms_maxTileSize = 1024;
+    static constexpr float ms_cascadeSplitLambda = 0.75f; // Blend between logarithmic and uniform splits
+    static constexpr float ms_shadowDistance = 100.0f; // Directional shadows end there or at the camera far plane
+    static constexpr float ms_casterDistance = 50.0f; // How far behind a cascade casters are still rendered
+    static constexpr float ms_defaultShadowRange = 50.0f; // Far plane of unbounded point and spot lights
+    static constexpr float ms_shadowNearPlane = 0.05f;
+    static constexpr uint32_t ms_maxTileRendersPerFrame = 8;
+};
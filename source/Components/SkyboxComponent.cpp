@@ -16,6 +16,7 @@ const std::vector<VkDescriptorSetLayoutBinding> SkyboxComponentResource::ms_bind
 
 SkyboxComponentResource::SkyboxComponentResource(SkyboxComponent const& skybox)
     : ComponentResource(SkyboxComponentResource::ms_bindings)
+    , m_cubeTexture(skybox.GetTextureCube())
 {
     VkDescriptorImageInfo const& descriptorInfo = skybox.GetTextureCube()->GetDescriptorInfo();
 
@@ -27,6 +28,8 @@ SkyboxComponentResource::SkyboxComponentResource(SkyboxComponent const& skybox)
     writeDescriptorSet.dstBinding = 0;
     writeDescriptorSet.pImageInfo = &descriptorInfo;
 
-    Renderer const& renderer = Renderer::GetInstance();
+    Renderer& renderer = Renderer::GetInstance();
     vkUpdateDescriptorSets(renderer.GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
+
+    renderer.UpdateIBL();
 }
@@ -24,6 +24,8 @@ class SkyboxComponentResource : public ComponentResource
 {
 public:
     SkyboxComponentResource(SkyboxComponent const& skybox);
+
+    SharedPtr<TextureResource> GetTextureCube() const { return m_cubeTexture.lock(); }
     
 public:
     static const std::vector<VkDescriptorSetLayoutBinding> ms_bindings;
@@ -1,144 +1,404 @@
 #include <Components/StaticMeshComponent.hpp>
 
+#include <Components/CameraComponent.hpp>
+#include <Components/SceneComponent.hpp>
+#include <Components/SkyboxComponent.hpp>
 #include <Resources/TextureResource.hpp>
+#include <Systems/EntitySystem.hpp>
 #include <Systems/Renderer.hpp>
 #include <Systems/ResourceManager.hpp>
+#include <Systems/TextureStreamer.hpp>
 
-void StaticMeshComponent::SetVertices(std::vector<Vertex> const& vertices)
+void Material::Init()
 {
-    m_vertices = vertices;
-
-    if (vertices.empty())
+    // Material textures are sampled through the bindless texture array
+    for (SharedPtr<TextureResource> const& texture : { m_baseColorTexture, m_metallicRoughnessTexture, m_normalTexture, m_occlusionTexture, m_emissiveTexture })
     {
-        ThrowError("Static Mesh has no vertices.");
-        return;
+        if (texture)
+        {
+            texture->MakeBindless();
+        }
     }
-    
-    // Create vertex buffer
-    Renderer& renderer = Renderer::GetInstance();
+}
+
+MaterialData Material::GetMaterialData() const
+{
+    uint32_t const emptyTextureIndex = ResourceManager::GetInstance().GetEmptyTexture().GetBindlessIndex();
 
-    VkDeviceSize const bufferSize = sizeof(vertices.front()) * vertices.size();
+    MaterialData materialData = {};
+    materialData.m_baseColorFactor = m_baseColorFactor;
+    materialData.m_emissiveFactor = m_emissiveFactor;
+    materialData.m_metallicFactor = m_metallicFactor;
+    materialData.m_roughnessFactor = m_roughnessFactor;
+    materialData.m_alphaMask = static_cast<float>(m_alphaMode == AlphaMode::Mask);
+    materialData.m_alphaMaskCutoff = m_alphaCutoff;
 
-    BufferInfo bufferInfo;
-    bufferInfo.m_size = bufferSize;
-    bufferInfo.m_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    bufferInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_ONLY;
+    materialData.m_colorTextureIndex = m_baseColorTexture ? m_baseColorTexture->GetBindlessIndex() : emptyTextureIndex;
+    materialData.m_physicalTextureIndex = m_metallicRoughnessTexture ? m_metallicRoughnessTexture->GetBindlessIndex() : emptyTextureIndex;
+    materialData.m_normalTextureIndex = m_normalTexture ? m_normalTexture->GetBindlessIndex() : emptyTextureIndex;
+    materialData.m_occlusionTextureIndex = m_occlusionTexture ? m_occlusionTexture->GetBindlessIndex() : emptyTextureIndex;
+    materialData.m_emissiveTextureIndex = m_emissiveTexture ? m_emissiveTexture->GetBindlessIndex() : emptyTextureIndex;
 
-    Buffer stagingBuffer = Buffer(bufferInfo);
-    stagingBuffer.CopyDataToBuffer(vertices.data(), bufferSize);
+    materialData.m_colorTextureSet = m_baseColorTexture ? m_baseColorTextCoordSet : -1;
+    materialData.m_physicalTextureSet = m_metallicRoughnessTexture ? m_metallicRoughnessTextCoordSet : -1;
+    materialData.m_normalTextureSet = m_normalTexture ? m_normalTextCoordSet : -1;
+    materialData.m_occlusionTextureSet = m_occlusionTexture ? m_occlusionTextCoordSet : -1;
+    materialData.m_emissiveTextureSet = m_emissiveTexture ? m_emissiveTextCoordSet : -1;
 
-    bufferInfo.m_usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-    bufferInfo.m_memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
+    return materialData;
+}
 
-    m_vertexBuffer = Buffer(bufferInfo);
+/*static*/ VkVertexInputBindingDescription MeshInstance::GetBindingDescription()
+{
+    VkVertexInputBindingDescription bindingDescription = {};
+    bindingDescription.binding = 1;
+    bindingDescription.stride = sizeof(MeshInstance);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
 
-    VkCommandBuffer commandBuffer = renderer.BeginSingleUseCommandBuffer();
-    m_vertexBuffer.CopyDataFromBuffer(commandBuffer, stagingBuffer, bufferSize);
-    renderer.EndSingleUseCommandBuffer(commandBuffer);
+    return bindingDescription;
 }
 
-void StaticMeshComponent::SetIndices(std::vector<uint32_t> const& indices)
+/*static*/ VkVertexInputAttributeDescription MeshInstance::GetAttributeDescription()
 {
-    m_indices = indices;
+    VkVertexInputAttributeDescription attributeDescription = {};
+    attributeDescription.binding = 1;
+    attributeDescription.location = 4;
+    attributeDescription.format = VK_FORMAT_R32_UINT;
+    attributeDescription.offset = offsetof(MeshInstance, m_transformSlot);
+
+    return attributeDescription;
+}
 
-    if (indices.empty())
+/// StaticMeshComponentGlobalResource
+
+const std::vector<VkDescriptorSetLayoutBinding> StaticMeshComponentGlobalResource::ms_bindings = {
+    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr } // materials
+};
+
+StaticMeshComponentGlobalResource::StaticMeshComponentGlobalResource()
+{
+    m_instanceCapacity = CreateResourceInFlight<uint32_t>(0u);
+    m_materialCapacity = CreateResourceInFlight<uint32_t>(0u);
+    m_descriptorSet = CreateResourceInFlight<DescriptorSet>(StaticMeshComponentGlobalResource::ms_bindings);
+
+    for (uint8_t i = 0; i < ResourceInFlight<Buffer>::FramesInFlight; i++)
+    {
+        ReserveInstances(ms_initialInstanceCapacity, i);
+        ReserveMaterials(ms_initialMaterialCapacity, i);
+    }
+}
+
+void StaticMeshComponentGlobalResource::ReserveInstances(uint32_t instanceCount)
+{
+    ReserveInstances(instanceCount, Renderer::GetInstance().GetCurrentFrame());
+}
+
+void StaticMeshComponentGlobalResource::ReserveInstances(uint32_t instanceCount, uint8_t frameIndex)
+{
+    if (instanceCount <= m_instanceCapacity[frameIndex])
     {
         return;
     }
-    
-    // Create index buffer
-    Renderer& renderer = Renderer::GetInstance();
 
-    VkDeviceSize const bufferSize = sizeof(indices.front()) * indices.size();
+    uint32_t const capacity = std::max(instanceCount, 2 * m_instanceCapacity[frameIndex]);
+
+    BufferInfo bufferCreationInfo;
+    bufferCreationInfo.m_size = sizeof(MeshInstance) * capacity;
+    bufferCreationInfo.m_usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    bufferCreationInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    m_instanceBuffer[frameIndex] = Buffer(bufferCreationInfo);
+    m_instanceCapacity[frameIndex] = capacity;
+}
+
+void StaticMeshComponentGlobalResource::ReserveMaterials(uint32_t materialCount)
+{
+    ReserveMaterials(materialCount, Renderer::GetInstance().GetCurrentFrame());
+}
+
+void StaticMeshComponentGlobalResource::ReserveMaterials(uint32_t materialCount, uint8_t frameIndex)
+{
+    if (materialCount <= m_materialCapacity[frameIndex])
+    {
+        return;
+    }
 
-    BufferInfo bufferInfo;
-    bufferInfo.m_size = bufferSize;
-    bufferInfo.m_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    bufferInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_ONLY;
+    uint32_t const capacity = std::max(materialCount, 2 * m_materialCapacity[frameIndex]);
 
-    Buffer stagingBuffer = Buffer(bufferInfo);
-    stagingBuffer.CopyDataToBuffer(indices.data(), bufferSize);
+    BufferInfo bufferCreationInfo;
+    bufferCreationInfo.m_size = sizeof(MaterialData) * capacity;
+    bufferCreationInfo.m_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferCreationInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    m_materialBuffer[frameIndex] = Buffer(bufferCreationInfo);
+    m_materialCapacity[frameIndex] = capacity;
 
-    bufferInfo.m_usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-    bufferInfo.m_memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = m_materialBuffer[frameIndex].GetBuffer();
+    bufferInfo.offset = 0;
+    bufferInfo.range = bufferCreationInfo.m_size;
 
-    m_indexBuffer = Buffer(bufferInfo);
+    VkWriteDescriptorSet writeDescriptorSet = {};
+    writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.dstSet = m_descriptorSet[frameIndex].GetDescriptorSet();
+    writeDescriptorSet.dstBinding = 0;
+    writeDescriptorSet.pBufferInfo = &bufferInfo;
 
-    VkCommandBuffer commandBuffer = renderer.BeginSingleUseCommandBuffer();
-    m_indexBuffer.CopyDataFromBuffer(commandBuffer, stagingBuffer, bufferSize);
-    renderer.EndSingleUseCommandBuffer(commandBuffer);
+    vkUpdateDescriptorSets(Renderer::GetInstance().GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
 }
 
-const std::vector<VkDescriptorSetLayoutBinding> Material::ms_bindings = {
-    { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }, // albedo
-    { 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }, // physical
-    { 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }, // normal
-    { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }, // ambient occlusion
-    { 4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr }, // emission
-};
+void StaticMeshGlobalResourceSystem::Update()
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    StaticMeshComponentGlobalResource& globalResource = entitySystem.GetComponent<StaticMeshComponentGlobalResource>(entitySystem.GetGlobalEntity());
 
-void Material::Init()
+    // Levels of detail are selected from the error they project on screen from the camera, clusters are culled against its frustum
+    m_pixelsPerUnit = 0.0f;
+    auto const& cameraView = entitySystem.GetView<CameraComponent const, SceneComponent const>();
+    Entity const cameraEntity = cameraView.front();
+    m_hasCamera = EntitySystem::IsEntityValid(cameraEntity);
+    if (m_hasCamera)
+    {
+        CameraComponent const& camera = cameraView.Get<CameraComponent const>(cameraEntity);
+        SceneComponent const& cameraScene = cameraView.Get<SceneComponent const>(cameraEntity);
+        m_cameraPosition = cameraScene.GetWorldTranslation();
+        m_pixelsPerUnit = Renderer::GetInstance().GetSwapchainExtent().height / (2.0f * std::tan(0.5f * camera.GetFieldOfVision()));
+
+        glm::mat4 const viewProjection = camera.GetPerspectiveMatrix() * CameraComponent::GetViewMatrix(m_cameraPosition, cameraScene.GetWorldRotation());
+        glm::vec4 const rows[] = {
+            glm::vec4(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]),
+            glm::vec4(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]),
+            glm::vec4(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]),
+            glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3])
+        };
+        m_frustumPlanes = { rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[2], rows[3] - rows[2] };
+        for (glm::vec4& plane : m_frustumPlanes)
+        {
+            plane /= glm::length(glm::vec3(plane));
+        }
+    }
+
+    // Group entities that share the same mesh asset and level of detail, each group is drawn with a single instanced draw per primitive
+    std::map<std::pair<MeshAsset const*, uint32_t>, size_t> batchIndices;
+    std::unordered_map<MeshAsset const*, uint32_t> meshFirstPrimitives;
+    std::vector<std::vector<MeshInstance>> batchInstances;
+    globalResource.m_batches.clear();
+    globalResource.m_draws.clear();
+
+    // Materials shared by several primitives are uploaded once, each draw indexes them through a push constant
+    std::unordered_map<Material const*, uint32_t> materialIndices;
+    std::vector<MaterialData> materials;
+    globalResource.m_primitiveMaterials.clear();
+
+    auto const& view = entitySystem.GetView<SceneComponentResource const, SceneComponent const, StaticMeshComponent>(entt::exclude_t<SkyboxComponent>());
+    for (Entity entity : view)
+    {
+        SceneComponentResource const& sceneResource = view.Get<SceneComponentResource const>(entity);
+        SceneComponent const& scene = view.Get<SceneComponent const>(entity);
+        StaticMeshComponent& staticMesh = view.Get<StaticMeshComponent>(entity);
+
+        if (!staticMesh.GetMeshAsset())
+        {
+            continue;
+        }
+
+        MeshAsset const* meshAsset = staticMesh.GetMeshAsset().get();
+
+        auto const& [firstPrimitiveIt, isNewMesh] = meshFirstPrimitives.try_emplace(meshAsset, globalResource.m_primitiveMaterials.size());
+        if (isNewMesh)
+        {
+            for (Primitive const& primitive : staticMesh.GetPrimitives())
+            {
+                auto const& [materialIt, isNewMaterial] = materialIndices.try_emplace(primitive.m_material.get(), materials.size());
+                if (isNewMaterial)
+                {
+                    materials.push_back(primitive.m_material->GetMaterialData());
+                }
+
+                globalResource.m_primitiveMaterials.push_back(materialIt->second);
+            }
+        }
+
+        auto const addInstance = [&](uint32_t transformSlot, uint8_t lod)
+        {
+            auto const& [batchIt, isNewBatch] = batchIndices.try_emplace({ meshAsset, lod }, globalResource.m_batches.size());
+            if (isNewBatch)
+            {
+                StaticMeshComponentGlobalResource::InstanceBatch batch;
+                batch.m_entity = entity;
+                batch.m_firstPrimitive = firstPrimitiveIt->second;
+                batch.m_lod = lod;
+                globalResource.m_batches.push_back(batch);
+                batchInstances.emplace_back();
+            }
+
+            batchInstances[batchIt->second].push_back({ transformSlot });
+        };
+
+        std::vector<uint8_t>& lodLevels = staticMesh.GetLodLevels();
+
+        if (SceneInstancesComponent const* sceneInstances = entitySystem.TryGetComponent<SceneInstancesComponent const>(entity))
+        {
+            lodLevels.resize(sceneInstances->m_transformSlots.size(), 0);
+            for (size_t i = 0; i < sceneInstances->m_transformSlots.size(); i++)
+            {
+                glm::mat4 const worldMatrix = scene.GetWorldMatrix() * sceneInstances->m_localTransforms[i];
+                lodLevels[i] = SelectLod(*meshAsset, worldMatrix, lodLevels[i]);
+                RequestTextureMips(*meshAsset, worldMatrix);
+                addInstance(sceneInstances->m_transformSlots[i], lodLevels[i]);
+            }
+        }
+        else
+        {
+            lodLevels.resize(1, 0);
+            lodLevels[0] = SelectLod(*meshAsset, scene.GetWorldMatrix(), lodLevels[0]);
+            RequestTextureMips(*meshAsset, scene.GetWorldMatrix());
+            addInstance(sceneResource.GetTransformSlot(), lodLevels[0]);
+        }
+    }
+
+    uint32_t instanceCount = 0;
+    for (size_t i = 0; i < globalResource.m_batches.size(); i++)
+    {
+        globalResource.m_batches[i].m_firstInstance = instanceCount;
+        globalResource.m_batches[i].m_instanceCount = batchInstances[i].size();
+        instanceCount += batchInstances[i].size();
+        AddBatchDraws(globalResource, globalResource.m_batches[i]);
+    }
+
+    if (instanceCount == 0)
+    {
+        return;
+    }
+
+    // The instance and material buffers of this frame may still be read by the GPU
+    Renderer::GetInstance().WaitForCurrentFrameInFlight();
+    globalResource.ReserveInstances(instanceCount);
+    globalResource.ReserveMaterials(materials.size());
+
+    Buffer& buffer = globalResource.m_instanceBuffer.GetResource();
+    MeshInstance* mappedMemory = static_cast<MeshInstance*>(buffer.MapMemory());
+    for (std::vector<MeshInstance> const& instances : batchInstances)
+    {
+        memcpy(mappedMemory, instances.data(), sizeof(MeshInstance) * instances.size());
+        mappedMemory += instances.size();
+    }
+    buffer.UnmapMemory();
+
+    Buffer& materialBuffer = globalResource.m_materialBuffer.GetResource();
+    materialBuffer.CopyDataToBuffer(materials.data(), sizeof(MaterialData) * materials.size());
+}
+
+float StaticMeshGlobalResourceSystem::GetProjectedScale(MeshAsset const& meshAsset, glm::mat4 const& worldMatrix) const
 {
-    m_descriptorSet = DescriptorSet{Material::ms_bindings};
+    float const scale = std::max({ glm::length(glm::vec3(worldMatrix[0])), glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2])) });
+    glm::vec3 const center = glm::vec3(worldMatrix * glm::vec4(meshAsset.GetBoundsCenter(), 1.0f));
+    float const distance = std::max(glm::distance(center, m_cameraPosition) - meshAsset.GetBoundsRadius() * scale, 0.1f);
+    return scale / distance * m_pixelsPerUnit;
+}
 
-    VkDescriptorImageInfo const& emptyTextureDescriptor = ResourceManager::GetInstance().GetEmptyTexture().GetDescriptorInfo();
+uint8_t StaticMeshGlobalResourceSystem::SelectLod(MeshAsset const& meshAsset, glm::mat4 const& worldMatrix, uint8_t previousLod) const
+{
+    if (meshAsset.GetLodCount() <= 1 || m_pixelsPerUnit <= 0.0f)
+    {
+        return 0;
+    }
 
-    std::vector<VkDescriptorImageInfo> const imageDescriptors = {
-        m_baseColorTexture ? m_baseColorTexture->GetDescriptorInfo() : emptyTextureDescriptor,
-        m_metallicRoughnessTexture ? m_metallicRoughnessTexture->GetDescriptorInfo() : emptyTextureDescriptor,
-        m_normalTexture ? m_normalTexture->GetDescriptorInfo() : emptyTextureDescriptor,
-        m_occlusionTexture ? m_occlusionTexture->GetDescriptorInfo() : emptyTextureDescriptor,
-        m_emissiveTexture ? m_emissiveTexture->GetDescriptorInfo() : emptyTextureDescriptor
-    };
+    float const errorScale = GetProjectedScale(meshAsset, worldMatrix);
 
-    std::array<VkWriteDescriptorSet, 5> writeDescriptorSets{};
-    for (size_t i = 0; i < writeDescriptorSets.size(); i++)
+    // Refining happens as soon as the error is visible, coarsening only once it is well below the threshold to avoid popping
+    uint8_t lod = 0;
+    for (uint32_t level = 1; level < meshAsset.GetLodCount(); level++)
     {
-        writeDescriptorSets[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSets[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        writeDescriptorSets[i].descriptorCount = 1;
-        writeDescriptorSets[i].dstSet = m_descriptorSet.GetDescriptorSet();
-        writeDescriptorSets[i].dstBinding = i;
-        writeDescriptorSets[i].pImageInfo = &imageDescriptors[i];
+        float const threshold = level > previousLod ? ms_lodPixelError * (1.0f - ms_lodHysteresis) : ms_lodPixelError;
+        if (meshAsset.GetLodError(level) * errorScale > threshold)
+        {
+            break;
+        }
+
+        lod = level;
     }
 
-    Renderer& renderer = Renderer::GetInstance();
-    vkUpdateDescriptorSets(renderer.GetDevice(), writeDescriptorSets.size(), writeDescriptorSets.data(), 0, nullptr);
+    return lod;
 }
 
-/*static*/ VkVertexInputBindingDescription Vertex::GetBindingDescription()
+void StaticMeshGlobalResourceSystem::RequestTextureMips(MeshAsset const& meshAsset, glm::mat4 const& worldMatrix) const
 {
-    VkVertexInputBindingDescription bindingDescription = {};
-    bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(Vertex);
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    if (m_pixelsPerUnit <= 0.0f)
+    {
+        return;
+    }
 
-    return bindingDescription;
+    // Meshes outside of the frustum need no more than the resident mips
+    float const scale = std::max({ glm::length(glm::vec3(worldMatrix[0])), glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2])) });
+    glm::vec4 const center = worldMatrix * glm::vec4(meshAsset.GetBoundsCenter(), 1.0f);
+    for (glm::vec4 const& plane : m_frustumPlanes)
+    {
+        if (glm::dot(glm::vec3(plane), glm::vec3(center)) + plane.w < -meshAsset.GetBoundsRadius() * scale)
+        {
+            return;
+        }
+    }
+
+    TextureStreamer& textureStreamer = TextureStreamer::GetInstance();
+    float const projectedScale = GetProjectedScale(meshAsset, worldMatrix);
+    for (Primitive const& primitive : meshAsset.GetPrimitives())
+    {
+        textureStreamer.RequestMips(primitive, projectedScale);
+    }
 }
 
-/*static*/ std::array<VkVertexInputAttributeDescription, 4> Vertex::GetAttributeDescriptions()
+void StaticMeshGlobalResourceSystem::AddBatchDraws(StaticMeshComponentGlobalResource& globalResource, StaticMeshComponentGlobalResource::InstanceBatch& batch) const
 {
-    std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions = {};
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    StaticMeshComponent const& staticMesh = entitySystem.GetComponent<StaticMeshComponent const>(batch.m_entity);
+    std::vector<Primitive> const& primitives = staticMesh.GetPrimitives();
 
-    attributeDescriptions[0].binding = 0;
-    attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[0].offset = offsetof(Vertex, m_position);
+    batch.m_firstDraw = globalResource.m_draws.size();
 
-    attributeDescriptions[1].binding = 0;
-    attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[1].offset = offsetof(Vertex, m_normal);
+    // Clusters can only be culled for a single instance, the draw is shared by every instance otherwise
+    bool const cullClusters = m_hasCamera && batch.m_lod == 0 && batch.m_instanceCount == 1 && !entitySystem.TryGetComponent<SceneInstancesComponent const>(batch.m_entity);
 
-    attributeDescriptions[2].binding = 0;
-    attributeDescriptions[2].location = 2;
-    attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-    attributeDescriptions[2].offset = offsetof(Vertex, m_uvSet0);
+    glm::mat4 worldMatrix = glm::mat4(1.0f);
+    float worldScale = 1.0f;
+    if (cullClusters)
+    {
+        worldMatrix = entitySystem.GetComponent<SceneComponent const>(batch.m_entity).GetWorldMatrix();
+        worldScale = std::max({ glm::length(glm::vec3(worldMatrix[0])), glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2])) });
+    }
 
-    attributeDescriptions[3].binding = 0;
-    attributeDescriptions[3].location = 3;
-    attributeDescriptions[3].format = VK_FORMAT_R32G32_SFLOAT;
-    attributeDescriptions[3].offset = offsetof(Vertex, m_uvSet1);
+    for (uint32_t p = 0; p < primitives.size(); p++)
+    {
+        Primitive const& primitive = primitives[p];
+
+        if (!cullClusters || primitive.m_meshlets.empty())
+        {
+            PrimitiveLod const lod = primitive.GetLod(batch.m_lod);
+            globalResource.m_draws.push_back({ p, lod.m_firstIndex, lod.m_indexCount });
+            continue;
+        }
+
+        // Meshlets are contiguous in the index buffer, consecutive visible ones are merged into a single draw
+        bool canMerge = false;
+        for (Meshlet const& meshlet : primitive.m_meshlets)
+        {
+            if (IsMeshletCulled(meshlet, worldMatrix, worldScale, m_frustumPlanes, m_cameraPosition))
+            {
+                canMerge = false;
+                continue;
+            }
+
+            if (canMerge)
+            {
+                globalResource.m_draws.back().m_indexCount += meshlet.m_indexCount;
+            }
+            else
+            {
+                globalResource.m_draws.push_back({ p, meshlet.m_firstIndex, meshlet.m_indexCount });
+                canMerge = true;
+            }
+        }
+    }
 
-    return attributeDescriptions;
+    batch.m_drawCount = globalResource.m_draws.size() - batch.m_firstDraw;
 }
@@ -3,10 +3,39 @@
 #include <Components/EntityComponent.hpp>
 #include <Resources/Buffer.hpp>
 #include <Resources/Descriptor.hpp>
+#include <Resources/MeshAsset.hpp>
+#include <Resources/ResourceComponent.hpp>
+#include <Resources/ResourceInFlight.hpp>
+#include <Systems/ResourceSystem.hpp>
 #include <Utilities/Helpers.hpp>
+#include <Utilities/Singleton.hpp>
 
 class TextureResource;
 
+// Material parameters as laid out in the material storage buffer
+struct MaterialData
+{
+    glm::vec4 m_baseColorFactor;
+    glm::vec3 m_emissiveFactor;
+    float m_metallicFactor;
+    float m_roughnessFactor;
+    float m_alphaMask;
+    float m_alphaMaskCutoff;
+    // Indices into the bindless texture array
+    uint32_t m_colorTextureIndex;
+    uint32_t m_physicalTextureIndex;
+    uint32_t m_normalTextureIndex;
+    uint32_t m_occlusionTextureIndex;
+    uint32_t m_emissiveTextureIndex;
+    // -1 == texture not used for this material; >= 0 texture used and index of texture coordinate set
+    int32_t m_colorTextureSet;
+    int32_t m_physicalTextureSet;
+    int32_t m_normalTextureSet;
+    int32_t m_occlusionTextureSet;
+    int32_t m_emissiveTextureSet;
+    uint32_t m_padding[3];
+};
+
 struct Material
 {
     enum class AlphaMode : uint8_t
@@ -36,49 +65,105 @@ struct Material
     AlphaMode m_alphaMode = AlphaMode::Opaque;
     float m_alphaCutoff = 0.5f;
 
-    DescriptorSet m_descriptorSet;
-    static const std::vector<VkDescriptorSetLayoutBinding> ms_bindings;
-
 public:
     void Init();
+    MaterialData GetMaterialData() const;
+};
+
+class StaticMeshComponent : public EntityComponent
+{
+public:
+    explicit StaticMeshComponent(SharedPtr<MeshAsset> const& meshAsset) : m_meshAsset(meshAsset) {}
+
+    SharedPtr<MeshAsset> const& GetMeshAsset() const { return m_meshAsset; }
+    VkBuffer GetPositionBuffer() const { return m_meshAsset->GetPositionBuffer(); }
+    VkBuffer GetIndexBuffer() const { return m_meshAsset->GetIndexBuffer(); }
+    VkIndexType GetIndexType() const { return m_meshAsset->GetIndexType(); }
+    std::vector<Primitive> const& GetPrimitives() const { return m_meshAsset->GetPrimitives(); }
+    std::vector<uint8_t>& GetLodLevels() { return m_lodLevels; }
+
+protected:
+    // Shared between every entity that references the same mesh
+    SharedPtr<MeshAsset> m_meshAsset;
+    // Level of detail drawn for each instance last frame
+    std::vector<uint8_t> m_lodLevels;
 };
 
-struct Vertex
+// Per instance vertex data, the slot of the instance world matrix in the transform buffer
+struct MeshInstance
 {
-    glm::vec3 m_position;
-    glm::vec3 m_normal;
-    glm::vec2 m_uvSet0;
-    glm::vec2 m_uvSet1;
+    uint32_t m_transformSlot;
 
     static VkVertexInputBindingDescription GetBindingDescription();
-    static std::array<VkVertexInputAttributeDescription, 4> GetAttributeDescriptions();
+    static VkVertexInputAttributeDescription GetAttributeDescription();
 };
 
-struct Primitive
+class StaticMeshComponentGlobalResource : public ComponentResourceInFlight
 {
-    uint32_t m_firstIndex  = 0;
-    uint32_t m_indexCount  = 0;
-    uint64_t m_vertexCount = 0;
-    bool m_hasIndices = false;
-    SharedPtr<Material> m_material;
+public:
+    struct InstanceBatch
+    {
+        Entity m_entity = entt::null; // Any entity of the batch, its mesh is drawn for every instance
+        uint32_t m_firstInstance = 0;
+        uint32_t m_instanceCount = 0;
+        uint32_t m_firstPrimitive = 0; // First material index of the batch primitives in m_primitiveMaterials
+        uint32_t m_lod = 0; // Level of detail of the mesh drawn for every instance
+        uint32_t m_firstDraw = 0;
+        uint32_t m_drawCount = 0;
+    };
+
+    // Index range of a primitive drawn for every instance of a batch
+    struct PrimitiveDraw
+    {
+        uint32_t m_primitive = 0; // Index of the primitive in the mesh
+        uint32_t m_firstIndex = 0;
+        uint32_t m_indexCount = 0;
+    };
+
+public:
+    StaticMeshComponentGlobalResource();
+
+    // Grows the instance and material buffers of the current frame
+    void ReserveInstances(uint32_t instanceCount);
+    void ReserveMaterials(uint32_t materialCount);
+
+private:
+    void ReserveInstances(uint32_t instanceCount, uint8_t frameIndex);
+    void ReserveMaterials(uint32_t materialCount, uint8_t frameIndex);
+
+public:
+    ResourceInFlight<Buffer> m_instanceBuffer;
+    ResourceInFlight<uint32_t> m_instanceCapacity;
+    ResourceInFlight<Buffer> m_materialBuffer;
+    ResourceInFlight<uint32_t> m_materialCapacity;
+    std::vector<InstanceBatch> m_batches;
+    std::vector<PrimitiveDraw> m_draws;
+    std::vector<uint32_t> m_primitiveMaterials;
+
+    static constexpr uint32_t ms_initialInstanceCapacity = 1024;
+    static constexpr uint32_t ms_initialMaterialCapacity = 256;
+    static const std::vector<VkDescriptorSetLayoutBinding> ms_bindings;
 };
 
-class StaticMeshComponent : public EntityComponent
+class StaticMeshGlobalResourceSystem
+    : public GlobalResourceSystem<StaticMeshComponentGlobalResource>, public Singleton<StaticMeshGlobalResourceSystem>
 {
 public:
-    void SetVertices(std::vector<Vertex> const& vertices);
-    void SetIndices(std::vector<uint32_t> const& indices);
-    void SetPrimitives(std::vector<Primitive> const& primitives) { m_primitives = primitives; }
+    void Update() override;
 
-    VkBuffer GetVertexBuffer() const { return m_vertexBuffer.GetBuffer(); }
-    VkBuffer GetIndexBuffer() const { return m_indexBuffer.GetBuffer(); }
-    std::vector<Primitive> const& GetPrimitives() const { return m_primitives; }
+private:
+    // Pixels covered on screen by one object space unit at the closest point of the mesh bounds
+    float GetProjectedScale(MeshAsset const& meshAsset, glm::mat4 const& worldMatrix) const;
+    uint8_t SelectLod(MeshAsset const& meshAsset, glm::mat4 const& worldMatrix, uint8_t previousLod) const;
+    void RequestTextureMips(MeshAsset const& meshAsset, glm::mat4 const& worldMatrix) const;
+    void AddBatchDraws(StaticMeshComponentGlobalResource& globalResource, StaticMeshComponentGlobalResource::InstanceBatch& batch) const;
 
-protected:
-    std::vector<Primitive> m_primitives;
-    std::vector<Vertex> m_vertices;
-    std::vector<uint32_t> m_indices;
+private:
+    glm::vec3 m_cameraPosition = glm::vec3(0.0f);
+    std::array<glm::vec4, 6> m_frustumPlanes;
+    bool m_hasCamera = false;
+    float m_pixelsPerUnit = 0.0f; // Projected size in pixels of one unit at unit distance
 
-    Buffer m_vertexBuffer;
-    Buffer m_indexBuffer;
+    static constexpr float ms_lodPixelError = 1.0f; // Maximum projected error of a level of detail
+    static constexpr float ms_lodHysteresis = 0.25f; // Margin required to move to a coarser level
 };
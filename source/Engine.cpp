@@ -3,24 +3,30 @@
 #include <Components/CameraComponent.hpp>
 #include <Components/LightComponent.hpp>
 #include <Components/SceneComponent.hpp>
+#include <Components/ShadowComponent.hpp>
 #include <Components/SkyboxComponent.hpp>
+#include <Components/StaticMeshComponent.hpp>
 #include <Systems/EntitySystem.hpp>
 #include <Systems/Loader.hpp>
 #include <Systems/Renderer.hpp>
 #include <Systems/ResourceManager.hpp>
 #include <Systems/System.hpp>
+#include <Systems/TextureStreamer.hpp>
 #include <Utilities/Helpers.hpp>
 
 Engine::Engine()
 {
     AddEngineSystem<Renderer>();
     AddEngineSystem<ResourceManager>();
+    AddEngineSystem<TextureStreamer>();
     AddEngineSystem<Loader>();
     AddEngineSystem<EntitySystem>();
     AddEngineSystem<SceneResourceSystem>();
     AddEngineSystem<CameraResourceSystem>();
     AddEngineSystem<SkyboxResourceSystem>();
+    AddEngineSystem<ShadowResourceSystem>();
     AddEngineSystem<LightGlobalResourceSystem>();
+    AddEngineSystem<StaticMeshGlobalResourceSystem>();
 }
 
 void Engine::Init()
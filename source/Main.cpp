@@ -58,12 +58,15 @@ void TestSystem::Init()
     Entity lightEntity0 = entitySystem.CreateEntity();
     LightComponent& light0 = entitySystem.AddComponent<LightComponent>(lightEntity0);
     light0.m_color = glm::vec3(4.0f, 0.0f, 0.0f);
+    light0.m_range = 10.0f;
+    light0.m_castsShadows = true;
     SceneComponent& lightScene0 = entitySystem.AddComponent<SceneComponent>(lightEntity0);
     lightScene0.SetWorldTranslation(glm::vec3(1.0f, 1.0f, 1.0f));
 
     Entity lightEntity1 = entitySystem.CreateEntity();
     LightComponent& light1 = entitySystem.AddComponent<LightComponent>(lightEntity1);
     light1.m_color = glm::vec3(0.0f, 0.0f, 4.0f);
+    light1.m_range = 10.0f;
     SceneComponent& lightScene1 = entitySystem.AddComponent<SceneComponent>(lightEntity1);
     lightScene1.SetWorldTranslation(glm::vec3(-1.0f, 1.0f, 1.0f));
 
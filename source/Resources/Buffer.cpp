@@ -15,19 +15,31 @@ Buffer::Buffer(BufferInfo const& info)
     VmaAllocationCreateInfo allocationInfo = {};
     allocationInfo.usage = info.m_memoryUsage;
 
-    if (vmaCreateBuffer(Renderer::GetInstance().GetAllocator(), &bufferInfo, &allocationInfo, &m_buffer, &m_allocation, nullptr) != VK_SUCCESS)
+    // Mapping once at creation saves a map and unmap on every write
+    bool const isHostVisible = info.m_memoryUsage == VMA_MEMORY_USAGE_CPU_ONLY || info.m_memoryUsage == VMA_MEMORY_USAGE_CPU_TO_GPU || info.m_memoryUsage == VMA_MEMORY_USAGE_GPU_TO_CPU;
+    if (isHostVisible)
+    {
+        allocationInfo.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    }
+
+    VmaAllocationInfo allocationResult = {};
+    if (vmaCreateBuffer(Renderer::GetInstance().GetAllocator(), &bufferInfo, &allocationInfo, &m_buffer, &m_allocation, &allocationResult) != VK_SUCCESS)
     {
         ThrowError("Failed to create buffer.");
     }
+
+    m_mappedMemory = allocationResult.pMappedData;
 }
 
 Buffer::Buffer(Buffer&& other) noexcept
 {
     m_buffer = other.m_buffer;
     m_allocation = other.m_allocation;
+    m_mappedMemory = other.m_mappedMemory;
 
     other.m_buffer = VK_NULL_HANDLE;
     other.m_allocation = VK_NULL_HANDLE;
+    other.m_mappedMemory = nullptr;
 }
 
 Buffer& Buffer::operator=(Buffer&& other) noexcept
@@ -41,9 +53,11 @@ Buffer& Buffer::operator=(Buffer&& other) noexcept
 
     m_buffer = other.m_buffer;
     m_allocation = other.m_allocation;
+    m_mappedMemory = other.m_mappedMemory;
 
     other.m_buffer = VK_NULL_HANDLE;
     other.m_allocation = VK_NULL_HANDLE;
+    other.m_mappedMemory = nullptr;
 
     return *this;
 }
@@ -63,10 +77,16 @@ void Buffer::Destroy()
 
     m_buffer = VK_NULL_HANDLE;
     m_allocation = VK_NULL_HANDLE;
+    m_mappedMemory = nullptr;
 }
 
 void* Buffer::MapMemory()
 {
+    if (m_mappedMemory)
+    {
+        return m_mappedMemory;
+    }
+
     void* mappedMemory;
     vmaMapMemory(Renderer::GetInstance().GetAllocator(), m_allocation, &mappedMemory);
     return mappedMemory;
@@ -74,13 +94,30 @@ void* Buffer::MapMemory()
 
 void Buffer::UnmapMemory()
 {
+    if (m_mappedMemory)
+    {
+        FlushMemory(0, VK_WHOLE_SIZE);
+        return;
+    }
+
     vmaUnmapMemory(Renderer::GetInstance().GetAllocator(), m_allocation); 
 }
 
+void Buffer::FlushMemory(VkDeviceSize offset, VkDeviceSize size)
+{
+    // Does nothing on host coherent memory
+    vmaFlushAllocation(Renderer::GetInstance().GetAllocator(), m_allocation, offset, size);
+}
+
+void Buffer::InvalidateMemory(VkDeviceSize offset, VkDeviceSize size)
+{
+    // Makes device writes visible to the host, does nothing on host coherent memory
+    vmaInvalidateAllocation(Renderer::GetInstance().GetAllocator(), m_allocation, offset, size);
+}
+
 void Buffer::CopyDataToBuffer(void const* const data, VkDeviceSize size)
 {
-    void* mappedMemory = MapMemory();
-    memcpy(mappedMemory, data, size);
+    memcpy(MapMemory(), data, size);
     UnmapMemory();
 }
 
@@ -125,12 +162,8 @@ void SelfUpdatableBuffer::Update()
 {
     if (IsDirty() && m_updateCallback)
     {
-        Renderer& renderer = Renderer::GetInstance();
-
-        void* mappedData;
-        vmaMapMemory(renderer.GetAllocator(), m_allocation, &mappedData);
-            m_updateCallback(mappedData);
-        vmaUnmapMemory(renderer.GetAllocator(), m_allocation);
+        m_updateCallback(MapMemory());
+        UnmapMemory();
 
         m_isDirty = false;
     }
@@ -24,12 +24,16 @@ public:
 
     void Destroy();
 
+    // Host visible buffers stay mapped for their whole life, unmapping only flushes the writes
     void* MapMemory();
     void UnmapMemory();
+    void FlushMemory(VkDeviceSize offset, VkDeviceSize size);
+    void InvalidateMemory(VkDeviceSize offset, VkDeviceSize size);
 
 protected:
     VkBuffer m_buffer = VK_NULL_HANDLE;
     VmaAllocation m_allocation = VK_NULL_HANDLE;
+    void* m_mappedMemory = nullptr;
 };
 
 
@@ -0,0 +1,141 @@
+#include <Resources/IBLCache.hpp>
+
+#include <Systems/Renderer.hpp>
+
+static IBLCacheLayout GetCacheLayout(ImageCreateInfo const& imageInfo);
+static void GetCopyRegions(IBLCacheLayout const& layout, std::vector<VkBufferImageCopy>& regions);
+
+bool IBLCache::RecordLoad(uint64_t key, ImageResource& image, VkCommandBuffer commandBuffer)
+{
+    std::string const filePath = GetIBLCacheFilePath(m_name, key);
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    IBLCacheLayout const layout = GetCacheLayout(image.GetCreationInfo());
+    IBLCacheHeader const expectedHeader = layout.GetHeader(key);
+
+    IBLCacheHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(IBLCacheHeader));
+    if (!file || memcmp(&header, &expectedHeader, sizeof(IBLCacheHeader)) != 0)
+    {
+        Warn("Ignoring outdated IBL cache file: %s.", filePath.c_str());
+        return false;
+    }
+
+    BufferInfo bufferInfo;
+    bufferInfo.m_size = header.m_dataSize;
+    bufferInfo.m_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_ONLY;
+    m_transferBuffer = Buffer(bufferInfo);
+
+    file.read(static_cast<char*>(m_transferBuffer.MapMemory()), header.m_dataSize);
+    m_transferBuffer.UnmapMemory();
+
+    if (!file)
+    {
+        Warn("Ignoring truncated IBL cache file: %s.", filePath.c_str());
+        m_transferBuffer.Destroy();
+        return false;
+    }
+
+    std::vector<VkBufferImageCopy> regions;
+    GetCopyRegions(layout, regions);
+
+    image.TransitionLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, commandBuffer);
+    vkCmdCopyBufferToImage(commandBuffer, m_transferBuffer.GetBuffer(), image.GetImage(), image.GetCurrentLayout(), regions.size(), regions.data());
+    image.TransitionLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, commandBuffer);
+
+    Log("Load IBL cache: %s", filePath.c_str());
+    return true;
+}
+
+void IBLCache::RecordStore(uint64_t key, ImageResource& image, VkCommandBuffer commandBuffer)
+{
+    IBLCacheLayout const layout = GetCacheLayout(image.GetCreationInfo());
+
+    std::vector<VkBufferImageCopy> regions;
+    GetCopyRegions(layout, regions);
+
+    BufferInfo bufferInfo;
+    bufferInfo.m_size = layout.GetDataSize();
+    bufferInfo.m_usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.m_memoryUsage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+    m_transferBuffer = Buffer(bufferInfo);
+
+    VkImageLayout const imageLayout = image.GetCurrentLayout();
+    image.TransitionLayout(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, commandBuffer);
+    vkCmdCopyImageToBuffer(commandBuffer, image.GetImage(), image.GetCurrentLayout(), m_transferBuffer.GetBuffer(), regions.size(), regions.data());
+    image.TransitionLayout(imageLayout, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, commandBuffer);
+
+    m_pendingStoreKey = key;
+    m_pendingStoreLayout = layout;
+}
+
+void IBLCache::OnTransferCompleted()
+{
+    if (m_pendingStoreKey != 0)
+    {
+        std::string const filePath = GetIBLCacheFilePath(m_name, m_pendingStoreKey);
+        IBLCacheHeader const header = m_pendingStoreLayout.GetHeader(m_pendingStoreKey);
+
+        std::error_code error;
+        std::filesystem::create_directories(s_iblCacheDirectory, error);
+
+        std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+        if (file.is_open())
+        {
+            m_transferBuffer.InvalidateMemory(0, VK_WHOLE_SIZE);
+            file.write(reinterpret_cast<char const*>(&header), sizeof(IBLCacheHeader));
+            file.write(static_cast<char const*>(m_transferBuffer.MapMemory()), header.m_dataSize);
+            Log("Store IBL cache: %s", filePath.c_str());
+        }
+        else
+        {
+            Warn("Failed to write IBL cache file: %s.", filePath.c_str());
+        }
+
+        m_pendingStoreKey = 0;
+    }
+
+    m_transferBuffer.Destroy();
+}
+
+static IBLCacheLayout GetCacheLayout(ImageCreateInfo const& imageInfo)
+{
+    VkExtent2D const extent = ImageResource::GetExtent(imageInfo);
+
+    IBLCacheLayout layout;
+    layout.m_format = imageInfo.m_format;
+    layout.m_width = extent.width;
+    layout.m_height = extent.height;
+    layout.m_mipLevels = imageInfo.m_mipLevels;
+    layout.m_layers = imageInfo.m_layers;
+    return layout;
+}
+
+static void GetCopyRegions(IBLCacheLayout const& layout, std::vector<VkBufferImageCopy>& regions)
+{
+    // One region per mip, the layers of a mip follow each other
+    regions.clear();
+    regions.reserve(layout.m_mipLevels);
+
+    uint64_t offset = 0;
+    for (uint32_t mipLevel = 0; mipLevel < layout.m_mipLevels; mipLevel++)
+    {
+        VkExtent2D const extent = layout.GetMipExtent(mipLevel);
+
+        VkBufferImageCopy region = {};
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = mipLevel;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = layout.m_layers;
+        region.imageExtent = { extent.width, extent.height, 1 };
+        regions.push_back(region);
+
+        offset += layout.GetMipSize(mipLevel);
+    }
+}
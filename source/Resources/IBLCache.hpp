@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Resources/Buffer.hpp>
+#include <Resources/IBLCacheFormat.hpp>
+#include <Resources/ImageResource.hpp>
+#include <Utilities/Helpers.hpp>
+
+// Disk cache of an image based lighting product, so an environment is only filtered the first time it is seen.
+// A file holds every mip of every layer of the image, see IBLCacheLayout.
+class IBLCache
+{
+public:
+    IBLCache(std::string const& name) : m_name(name) {}
+
+    // Records the upload of the cached image, leaving it ready to be sampled. Returns false when nothing matches the key.
+    bool RecordLoad(uint64_t key, ImageResource& image, VkCommandBuffer commandBuffer);
+    // Records the readback of the image, it is written to disk by OnTransferCompleted
+    void RecordStore(uint64_t key, ImageResource& image, VkCommandBuffer commandBuffer);
+    // Call once the recorded commands have completed
+    void OnTransferCompleted();
+
+private:
+    std::string m_name;
+    Buffer m_transferBuffer;
+    uint64_t m_pendingStoreKey = 0; // Zero when no readback is pending
+    IBLCacheLayout m_pendingStoreLayout;
+};
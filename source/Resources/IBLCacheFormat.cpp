@@ -0,0 +1,109 @@
+#include <Resources/IBLCacheFormat.hpp>
+
+#include <Utilities/Helpers.hpp>
+
+VkExtent2D IBLCacheLayout::GetMipExtent(uint32_t mipLevel) const
+{
+    return { std::max(m_width >> mipLevel, 1u), std::max(m_height >> mipLevel, 1u) };
+}
+
+uint64_t IBLCacheLayout::GetMipSize(uint32_t mipLevel) const
+{
+    VkExtent2D const extent = GetMipExtent(mipLevel);
+    return static_cast<uint64_t>(extent.width) * extent.height * GetTexelSize(m_format) * m_layers;
+}
+
+uint64_t IBLCacheLayout::GetDataSize() const
+{
+    uint64_t size = 0;
+    for (uint32_t mipLevel = 0; mipLevel < m_mipLevels; mipLevel++)
+    {
+        size += GetMipSize(mipLevel);
+    }
+
+    return size;
+}
+
+IBLCacheHeader IBLCacheLayout::GetHeader(uint64_t key) const
+{
+    IBLCacheHeader header;
+    header.m_magic = s_iblCacheMagic;
+    header.m_version = s_iblCacheVersion;
+    header.m_key = key;
+    header.m_format = static_cast<uint32_t>(m_format);
+    header.m_width = m_width;
+    header.m_height = m_height;
+    header.m_mipLevels = m_mipLevels;
+    header.m_layers = m_layers;
+    header.m_dataSize = GetDataSize();
+    return header;
+}
+
+/*static*/ uint32_t IBLCacheLayout::GetTexelSize(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_R16G16_SFLOAT:
+        return 4;
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+        return 8;
+    case VK_FORMAT_R32G32B32A32_SFLOAT:
+        return 16;
+    default:
+        ThrowError("Unsupported IBL cache format %d.", format);
+        return 0;
+    }
+}
+
+uint64_t BrdflutSettings::GetCacheKey() const
+{
+    uint64_t key = HashBytes(&m_format, sizeof(m_format));
+    key = HashBytes(&m_resolution, sizeof(m_resolution), key);
+    key = HashBytes(&m_sampleCount, sizeof(m_sampleCount), key);
+    return key;
+}
+
+uint64_t IrradianceSettings::GetCacheKey(uint64_t sourceHash) const
+{
+    uint64_t key = HashBytes(&m_format, sizeof(m_format), sourceHash);
+    key = HashBytes(&m_resolution, sizeof(m_resolution), key);
+    key = HashBytes(&m_phiSteps, sizeof(m_phiSteps), key);
+    key = HashBytes(&m_thetaSteps, sizeof(m_thetaSteps), key);
+    return key;
+}
+
+uint64_t PrefilterSettings::GetCacheKey(uint64_t sourceHash) const
+{
+    uint64_t key = HashBytes(&m_format, sizeof(m_format), sourceHash);
+    key = HashBytes(&m_resolution, sizeof(m_resolution), key);
+    key = HashBytes(&m_sampleCount, sizeof(m_sampleCount), key);
+    return key;
+}
+
+uint64_t GetIBLSourceHash(VkExtent2D extent, float const* data)
+{
+    uint64_t const faceSize = static_cast<uint64_t>(extent.width) * extent.height * 4;
+    uint64_t hash = GetIBLSourceHashSeed(extent);
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        hash = HashIBLSourceFace(extent, data + i * faceSize, hash);
+    }
+    return hash;
+}
+
+uint64_t GetIBLSourceHashSeed(VkExtent2D extent)
+{
+    return HashBytes(&extent, sizeof(extent));
+}
+
+uint64_t HashIBLSourceFace(VkExtent2D extent, float const* face, uint64_t hash)
+{
+    // The hash is chained, so faces apart hash the same as faces one after the other
+    uint64_t const faceSize = static_cast<uint64_t>(extent.width) * extent.height * 4 * sizeof(float);
+    return HashBytes(face, faceSize, hash);
+}
+
+std::string GetIBLCacheFilePath(std::string const& name, uint64_t key)
+{
+    return StringFormat("%s/%s_%016llx.bin", s_iblCacheDirectory, name.c_str(), static_cast<unsigned long long>(key));
+}
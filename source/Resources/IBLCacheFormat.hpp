@@ -0,0 +1,75 @@
+#pragma once
+
+// On disk layout of the IBL cache and the parameters its keys are made of.
+// Shared with the offline baker, so it must not depend on a device.
+
+struct IBLCacheHeader
+{
+    uint32_t m_magic = 0;
+    uint32_t m_version = 0;
+    uint64_t m_key = 0;
+    uint32_t m_format = 0;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_mipLevels = 0;
+    uint32_t m_layers = 0;
+    uint32_t m_padding = 0;
+    uint64_t m_dataSize = 0;
+};
+
+// The data holds one block per mip, the layers of a mip follow each other tightly packed
+struct IBLCacheLayout
+{
+    VkFormat m_format = VK_FORMAT_UNDEFINED;
+    uint32_t m_width = 1;
+    uint32_t m_height = 1;
+    uint32_t m_mipLevels = 1;
+    uint32_t m_layers = 1;
+
+    VkExtent2D GetMipExtent(uint32_t mipLevel) const;
+    uint64_t GetMipSize(uint32_t mipLevel) const;
+    uint64_t GetDataSize() const;
+    IBLCacheHeader GetHeader(uint64_t key) const;
+
+    static uint32_t GetTexelSize(VkFormat format);
+};
+
+struct BrdflutSettings
+{
+    VkFormat m_format = VK_FORMAT_R16G16_SFLOAT;
+    uint16_t m_resolution = 512;
+    uint32_t m_sampleCount = 1024;
+
+    // The lookup table does not depend on the environment
+    uint64_t GetCacheKey() const;
+};
+
+struct IrradianceSettings
+{
+    VkFormat m_format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    uint16_t m_resolution = 64;
+    float m_phiSteps = 180.0f;
+    float m_thetaSteps = 64.0f;
+
+    uint64_t GetCacheKey(uint64_t sourceHash) const;
+};
+
+struct PrefilterSettings
+{
+    VkFormat m_format = VK_FORMAT_R16G16B16A16_SFLOAT;
+    uint16_t m_resolution = 512;
+    uint32_t m_sampleCount = 32;
+
+    uint64_t GetCacheKey(uint64_t sourceHash) const;
+};
+
+// Hash of an RGBA float cube, faces one after the other, keying the products filtered from it
+uint64_t GetIBLSourceHash(VkExtent2D extent, float const* data);
+// The same hash a face at a time, from the seed of the extent, so the faces don't have to be in memory together
+uint64_t GetIBLSourceHashSeed(VkExtent2D extent);
+uint64_t HashIBLSourceFace(VkExtent2D extent, float const* face, uint64_t hash);
+std::string GetIBLCacheFilePath(std::string const& name, uint64_t key);
+
+static constexpr char const* s_iblCacheDirectory = "cache/ibl";
+static constexpr uint32_t s_iblCacheMagic = 0x43424949; // "IIBC"
+static constexpr uint32_t s_iblCacheVersion = 2; // Bump when the filtering shaders change
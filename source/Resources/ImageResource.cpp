@@ -41,7 +41,8 @@ void ImageResource::CreateImageView()
     VkImageViewCreateInfo imageViewInfo = {};
     imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     imageViewInfo.image = m_image;
-    imageViewInfo.viewType = (m_creationInfo.m_layers == 6) ? VK_IMAGE_VIEW_TYPE_CUBE : VK_IMAGE_VIEW_TYPE_2D;
+    // A 2D view covers a single layer, the view below covers all of them
+    imageViewInfo.viewType = (m_creationInfo.m_layers == 6) ? VK_IMAGE_VIEW_TYPE_CUBE : (m_creationInfo.m_layers > 1) ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
     imageViewInfo.format = m_creationInfo.m_format;
     imageViewInfo.subresourceRange.aspectMask = aspectFlags;
     imageViewInfo.subresourceRange.baseMipLevel = 0;
@@ -55,6 +56,28 @@ void ImageResource::CreateImageView()
     }
 }
 
+VkImageView ImageResource::CreateMipImageView(uint8_t mipLevel) const
+{
+    VkImageViewCreateInfo imageViewInfo = {};
+    imageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    imageViewInfo.image = m_image;
+    imageViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    imageViewInfo.format = m_creationInfo.m_format;
+    imageViewInfo.subresourceRange.aspectMask = Renderer::GetAspectFlagsFromFormat(m_creationInfo.m_format);
+    imageViewInfo.subresourceRange.baseMipLevel = mipLevel;
+    imageViewInfo.subresourceRange.levelCount = 1;
+    imageViewInfo.subresourceRange.baseArrayLayer = 0;
+    imageViewInfo.subresourceRange.layerCount = m_creationInfo.m_layers;
+
+    VkImageView imageView = VK_NULL_HANDLE;
+    if (vkCreateImageView(Renderer::GetInstance().GetDevice(), &imageViewInfo, nullptr, &imageView) != VK_SUCCESS)
+    {
+        ThrowError("Failed to create mip image view.");
+    }
+
+    return imageView;
+}
+
 void ImageResource::Destroy()
 {
     Renderer& renderer = Renderer::GetInstance();
@@ -30,6 +30,8 @@ public:
 
     void CreateImage();
     void CreateImageView();
+    // Creates a 2D array view of a single mip covering every layer, owned by the caller
+    VkImageView CreateMipImageView(uint8_t mipLevel) const;
     void Destroy();
 
     VkImage GetImage() const { return m_image; }
@@ -0,0 +1,78 @@
+#include <Resources/LinearUniformAllocator.hpp>
+
+#include <Systems/Renderer.hpp>
+#include <Utilities/Helpers.hpp>
+
+void LinearUniformAllocator::Create(VkDeviceSize capacity, uint16_t frameCount)
+{
+    Renderer const& renderer = Renderer::GetInstance();
+    m_alignment = std::max<VkDeviceSize>(renderer.GetPhysicalDeviceInfo().m_properties.limits.minUniformBufferOffsetAlignment, 1);
+    m_capacity = capacity;
+
+    BufferInfo bufferCreationInfo;
+    bufferCreationInfo.m_size = capacity;
+    bufferCreationInfo.m_usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    bufferCreationInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+
+    m_buffers.clear();
+    for (uint16_t i = 0; i < frameCount; i++)
+    {
+        m_buffers.emplace_back(bufferCreationInfo);
+    }
+
+    m_offsets.assign(frameCount, 0);
+    m_needsReset.assign(frameCount, false);
+}
+
+void LinearUniformAllocator::Destroy()
+{
+    m_buffers.clear();
+    m_offsets.clear();
+    m_needsReset.clear();
+}
+
+UniformAllocation LinearUniformAllocator::Allocate(VkDeviceSize size)
+{
+    Renderer const& renderer = Renderer::GetInstance();
+    uint16_t const frameIndex = renderer.GetCurrentFrame();
+
+    // The first allocation after the frame was submitted waits for the GPU to be done with its buffer
+    if (m_needsReset[frameIndex])
+    {
+        renderer.WaitForCurrentFrameInFlight();
+        OnFrameRetired(frameIndex);
+    }
+
+    VkDeviceSize const offset = (m_offsets[frameIndex] + m_alignment - 1) / m_alignment * m_alignment;
+    if (offset + size > m_capacity)
+    {
+        ThrowError("Uniform allocator out of memory, %llu bytes requested.", static_cast<unsigned long long>(size));
+    }
+
+    m_offsets[frameIndex] = offset + size;
+
+    UniformAllocation allocation;
+    allocation.m_buffer = m_buffers[frameIndex].GetBuffer();
+    allocation.m_offset = static_cast<uint32_t>(offset);
+    allocation.m_data = static_cast<uint8_t*>(m_buffers[frameIndex].MapMemory()) + offset;
+    return allocation;
+}
+
+void LinearUniformAllocator::EndFrame(uint16_t frameIndex)
+{
+    if (m_offsets[frameIndex] > 0)
+    {
+        m_buffers[frameIndex].FlushMemory(0, m_offsets[frameIndex]);
+    }
+
+    m_needsReset[frameIndex] = true;
+}
+
+void LinearUniformAllocator::OnFrameRetired(uint16_t frameIndex)
+{
+    if (m_needsReset[frameIndex])
+    {
+        m_offsets[frameIndex] = 0;
+        m_needsReset[frameIndex] = false;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Resources/Buffer.hpp>
+
+// Suballocation of a frame's uniform buffer, valid until the frame in flight retires
+struct UniformAllocation
+{
+    VkBuffer m_buffer = VK_NULL_HANDLE;
+    uint32_t m_offset = 0; // Dynamic offset to bind the descriptor with
+    void* m_data = nullptr;
+};
+
+// Linear allocator over one persistently mapped uniform buffer per frame in flight.
+// Allocations are never freed one by one, the whole buffer of a frame is reused once its fence has been waited on.
+class LinearUniformAllocator
+{
+public:
+    void Create(VkDeviceSize capacity, uint16_t frameCount);
+    void Destroy();
+
+    UniformAllocation Allocate(VkDeviceSize size);
+    template<typename T>
+    UniformAllocation Allocate(T const& data);
+
+    // Makes the writes of the frame visible to the device, its allocations are released once its fence is waited on
+    void EndFrame(uint16_t frameIndex);
+    // Called after waiting on the frame's fence, also resets frames nothing was allocated for since they were submitted
+    void OnFrameRetired(uint16_t frameIndex);
+
+    VkBuffer GetBuffer(uint16_t frameIndex) const { return m_buffers[frameIndex].GetBuffer(); }
+
+private:
+    std::vector<Buffer> m_buffers;
+    std::vector<VkDeviceSize> m_offsets;
+    std::vector<bool> m_needsReset;
+    VkDeviceSize m_capacity = 0;
+    VkDeviceSize m_alignment = 1;
+};
+
+template<typename T>
+UniformAllocation LinearUniformAllocator::Allocate(T const& data)
+{
+    UniformAllocation allocation = Allocate(sizeof(T));
+    memcpy(allocation.m_data, &data, sizeof(T));
+    return allocation;
+}
@@ -0,0 +1,217 @@
+#include <Resources/MeshAsset.hpp>
+
+#include <Systems/Renderer.hpp>
+
+static glm::i16vec2 EncodeOctahedralNormal(glm::vec3 const& normal)
+{
+    float const length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (length <= 0.0f)
+    {
+        return glm::i16vec2(0);
+    }
+
+    glm::vec2 encoded = glm::vec2(normal) / length;
+    if (normal.z < 0.0f)
+    {
+        glm::vec2 const signs = glm::vec2(encoded.x >= 0.0f ? 1.0f : -1.0f, encoded.y >= 0.0f ? 1.0f : -1.0f);
+        encoded = (1.0f - glm::abs(glm::vec2(encoded.y, encoded.x))) * signs;
+    }
+
+    return glm::i16vec2(glm::round(glm::clamp(encoded, -1.0f, 1.0f) * 32767.0f));
+}
+
+static glm::u16vec2 EncodeHalfUv(glm::vec2 const& uv)
+{
+    uint32_t const packed = glm::packHalf2x16(uv);
+    return glm::u16vec2(packed & 0xFFFF, packed >> 16);
+}
+
+MeshAsset::MeshAsset(std::vector<SourceVertex> const& vertices, std::vector<uint32_t> const& indices, std::vector<Primitive> const& primitives, std::vector<float> const& lodErrors)
+    : m_primitives(primitives)
+    , m_lodErrors(lodErrors)
+{
+    if (m_lodErrors.empty())
+    {
+        m_lodErrors.push_back(0.0f);
+    }
+
+    ComputeBounds(vertices);
+    CreateVertexBuffers(vertices);
+    CreateUvSet1Buffer(vertices);
+    CreateIndexBuffer(indices, vertices.size());
+}
+
+MeshPushConstantBlock MeshAsset::GetMeshPushConstantBlock() const
+{
+    MeshPushConstantBlock pushBlock = {};
+    pushBlock.m_positionOffset = glm::vec4(m_boundsMinimum, 0.0f);
+    pushBlock.m_positionScale = glm::vec4(m_boundsMaximum - m_boundsMinimum, 0.0f);
+    return pushBlock;
+}
+
+void MeshAsset::ComputeBounds(std::vector<SourceVertex> const& vertices)
+{
+    if (vertices.empty())
+    {
+        return;
+    }
+
+    m_boundsMinimum = vertices.front().m_position;
+    m_boundsMaximum = vertices.front().m_position;
+    for (SourceVertex const& vertex : vertices)
+    {
+        m_boundsMinimum = glm::min(m_boundsMinimum, vertex.m_position);
+        m_boundsMaximum = glm::max(m_boundsMaximum, vertex.m_position);
+    }
+
+    m_boundsCenter = 0.5f * (m_boundsMinimum + m_boundsMaximum);
+    for (SourceVertex const& vertex : vertices)
+    {
+        m_boundsRadius = std::max(m_boundsRadius, glm::distance(m_boundsCenter, vertex.m_position));
+    }
+}
+
+void MeshAsset::CreateVertexBuffers(std::vector<SourceVertex> const& vertices)
+{
+    if (vertices.empty())
+    {
+        ThrowError("Static Mesh has no vertices.");
+        return;
+    }
+
+    glm::vec3 const extent = m_boundsMaximum - m_boundsMinimum;
+    glm::vec3 const inverseExtent = glm::vec3(
+        extent.x > 0.0f ? 1.0f / extent.x : 0.0f, 
+        extent.y > 0.0f ? 1.0f / extent.y : 0.0f, 
+        extent.z > 0.0f ? 1.0f / extent.z : 0.0f
+    );
+
+    std::vector<VertexPosition> positions(vertices.size());
+    std::vector<VertexAttributes> attributes(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        glm::vec3 const normalizedPosition = glm::clamp((vertices[i].m_position - m_boundsMinimum) * inverseExtent, 0.0f, 1.0f);
+        positions[i].m_position = glm::u16vec4(glm::round(normalizedPosition * 65535.0f), 0);
+        attributes[i].m_normal = EncodeOctahedralNormal(vertices[i].m_normal);
+        attributes[i].m_uvSet0 = EncodeHalfUv(vertices[i].m_uvSet0);
+    }
+
+    CreateDeviceBuffer(m_positionBuffer, positions.data(), sizeof(VertexPosition) * positions.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    CreateDeviceBuffer(m_attributeBuffer, attributes.data(), sizeof(VertexAttributes) * attributes.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+}
+
+void MeshAsset::CreateUvSet1Buffer(std::vector<SourceVertex> const& vertices)
+{
+    // Models without a second uv set leave it zeroed, the stream is skipped for them
+    bool const hasUvSet1 = std::any_of(vertices.begin(), vertices.end(), [](SourceVertex const& vertex) { return vertex.m_uvSet1 != glm::vec2(0.0f); });
+    if (!hasUvSet1)
+    {
+        return;
+    }
+
+    std::vector<glm::u16vec2> uvs(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        uvs[i] = EncodeHalfUv(vertices[i].m_uvSet1);
+    }
+
+    CreateDeviceBuffer(m_uvSet1Buffer, uvs.data(), sizeof(glm::u16vec2) * uvs.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+}
+
+void MeshAsset::CreateIndexBuffer(std::vector<uint32_t> const& indices, size_t vertexCount)
+{
+    if (indices.empty())
+    {
+        return;
+    }
+
+    if (vertexCount > std::numeric_limits<uint16_t>::max() + 1)
+    {
+        m_indexType = VK_INDEX_TYPE_UINT32;
+        CreateDeviceBuffer(m_indexBuffer, indices.data(), sizeof(uint32_t) * indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        return;
+    }
+
+    // Every vertex of the mesh is addressable with 16 bits
+    std::vector<uint16_t> const shortIndices(indices.begin(), indices.end());
+    m_indexType = VK_INDEX_TYPE_UINT16;
+    CreateDeviceBuffer(m_indexBuffer, shortIndices.data(), sizeof(uint16_t) * shortIndices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+}
+
+void MeshAsset::CreateDeviceBuffer(Buffer& buffer, void const* data, VkDeviceSize size, VkBufferUsageFlags usage)
+{
+    Renderer& renderer = Renderer::GetInstance();
+
+    BufferInfo bufferInfo;
+    bufferInfo.m_size = size;
+    bufferInfo.m_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_ONLY;
+
+    Buffer stagingBuffer = Buffer(bufferInfo);
+    stagingBuffer.CopyDataToBuffer(data, size);
+
+    bufferInfo.m_usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage;
+    bufferInfo.m_memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    buffer = Buffer(bufferInfo);
+
+    VkCommandBuffer commandBuffer = renderer.BeginSingleUseCommandBuffer();
+    buffer.CopyDataFromBuffer(commandBuffer, stagingBuffer, size);
+    renderer.EndSingleUseCommandBuffer(commandBuffer);
+}
+
+PrimitiveLod Primitive::GetLod(uint32_t lod) const
+{
+    if (lod == 0 || m_lods.empty())
+    {
+        return { m_firstIndex, m_indexCount };
+    }
+
+    return m_lods[std::min<size_t>(lod, m_lods.size()) - 1];
+}
+
+/*static*/ std::array<VkVertexInputBindingDescription, 3> Vertex::GetBindingDescriptions()
+{
+    std::array<VkVertexInputBindingDescription, 3> bindingDescriptions = {};
+
+    bindingDescriptions[0].binding = ms_positionBinding;
+    bindingDescriptions[0].stride = sizeof(VertexPosition);
+    bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    bindingDescriptions[1].binding = ms_attributeBinding;
+    bindingDescriptions[1].stride = sizeof(VertexAttributes);
+    bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    bindingDescriptions[2].binding = ms_uvSet1Binding;
+    bindingDescriptions[2].stride = sizeof(glm::u16vec2);
+    bindingDescriptions[2].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    return bindingDescriptions;
+}
+
+/*static*/ std::array<VkVertexInputAttributeDescription, 4> Vertex::GetAttributeDescriptions()
+{
+    std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions = {};
+
+    attributeDescriptions[0].binding = ms_positionBinding;
+    attributeDescriptions[0].location = 0;
+    attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+    attributeDescriptions[0].offset = offsetof(VertexPosition, m_position);
+
+    attributeDescriptions[1].binding = ms_attributeBinding;
+    attributeDescriptions[1].location = 1;
+    attributeDescriptions[1].format = VK_FORMAT_R16G16_SNORM;
+    attributeDescriptions[1].offset = offsetof(VertexAttributes, m_normal);
+
+    attributeDescriptions[2].binding = ms_attributeBinding;
+    attributeDescriptions[2].location = 2;
+    attributeDescriptions[2].format = VK_FORMAT_R16G16_SFLOAT;
+    attributeDescriptions[2].offset = offsetof(VertexAttributes, m_uvSet0);
+
+    attributeDescriptions[3].binding = ms_uvSet1Binding;
+    attributeDescriptions[3].location = 3;
+    attributeDescriptions[3].format = VK_FORMAT_R16G16_SFLOAT;
+    attributeDescriptions[3].offset = 0;
+
+    return attributeDescriptions;
+}
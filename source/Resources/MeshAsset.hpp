@@ -0,0 +1,112 @@
+#pragma once
+
+#include <Resources/Buffer.hpp>
+#include <Utilities/Helpers.hpp>
+#include <Utilities/MeshletBuilder.hpp>
+
+struct Material;
+
+// Full precision vertex built by the loader, quantized into a Vertex when the mesh is uploaded
+struct SourceVertex
+{
+    glm::vec3 m_position;
+    glm::vec3 m_normal;
+    glm::vec2 m_uvSet0;
+    glm::vec2 m_uvSet1;
+};
+
+// Position stream, the only one fetched by depth, skybox and image based lighting passes
+struct VertexPosition
+{
+    glm::u16vec4 m_position; // Normalized to the mesh bounds, w is unused
+};
+
+// Shading attribute stream
+struct VertexAttributes
+{
+    glm::i16vec2 m_normal; // Octahedral encoding
+    glm::u16vec2 m_uvSet0; // Half floats
+};
+
+// Vertex input layout of the mesh streams, the second uv set has its own stream and only exists when the mesh has one
+struct Vertex
+{
+    static constexpr uint32_t ms_positionBinding = 0;
+    static constexpr uint32_t ms_attributeBinding = 2; // Binding 1 holds the mesh instances
+    static constexpr uint32_t ms_uvSet1Binding = 3;
+
+    static std::array<VkVertexInputBindingDescription, 3> GetBindingDescriptions();
+    static std::array<VkVertexInputAttributeDescription, 4> GetAttributeDescriptions();
+};
+
+// Dequantizes the vertex positions of a mesh, object position = offset + scale * position
+struct MeshPushConstantBlock
+{
+    glm::vec4 m_positionOffset;
+    glm::vec4 m_positionScale;
+};
+
+// Range of the index buffer drawn at a level of detail
+struct PrimitiveLod
+{
+    uint32_t m_firstIndex = 0;
+    uint32_t m_indexCount = 0;
+};
+
+struct Primitive
+{
+    uint32_t m_firstIndex  = 0;
+    uint32_t m_indexCount  = 0;
+    uint64_t m_vertexCount = 0;
+    bool m_hasIndices = false;
+    SharedPtr<Material> m_material;
+    std::vector<PrimitiveLod> m_lods; // Simplified levels, level 0 is the full primitive
+    std::vector<Meshlet> m_meshlets; // Clusters of the full primitive
+    std::array<float, 2> m_uvDensity = { 0.0f, 0.0f }; // Object space length per uv unit of each set, zero when degenerate
+
+    PrimitiveLod GetLod(uint32_t lod) const;
+};
+
+// Geometry of a mesh uploaded to the GPU, shared by every entity that draws it
+class MeshAsset
+{
+public:
+    MeshAsset(std::vector<SourceVertex> const& vertices, std::vector<uint32_t> const& indices, std::vector<Primitive> const& primitives, std::vector<float> const& lodErrors = {});
+
+    MeshAsset(MeshAsset const&) = delete;
+    MeshAsset& operator=(MeshAsset const&) = delete;
+
+    VkBuffer GetPositionBuffer() const { return m_positionBuffer.GetBuffer(); }
+    VkBuffer GetAttributeBuffer() const { return m_attributeBuffer.GetBuffer(); }
+    VkBuffer GetUvSet1Buffer() const { return m_uvSet1Buffer.GetBuffer(); }
+    VkBuffer GetIndexBuffer() const { return m_indexBuffer.GetBuffer(); }
+    VkIndexType GetIndexType() const { return m_indexType; }
+    std::vector<Primitive> const& GetPrimitives() const { return m_primitives; }
+    uint32_t GetLodCount() const { return m_lodErrors.size(); }
+    float GetLodError(uint32_t lod) const { return m_lodErrors[lod]; }
+    glm::vec3 const& GetBoundsCenter() const { return m_boundsCenter; }
+    float GetBoundsRadius() const { return m_boundsRadius; }
+    MeshPushConstantBlock GetMeshPushConstantBlock() const;
+
+private:
+    void CreateVertexBuffers(std::vector<SourceVertex> const& vertices);
+    void CreateUvSet1Buffer(std::vector<SourceVertex> const& vertices);
+    void CreateIndexBuffer(std::vector<uint32_t> const& indices, size_t vertexCount);
+    void CreateDeviceBuffer(Buffer& buffer, void const* data, VkDeviceSize size, VkBufferUsageFlags usage);
+    void ComputeBounds(std::vector<SourceVertex> const& vertices);
+
+private:
+    std::vector<Primitive> m_primitives;
+    std::vector<float> m_lodErrors; // Object space error of each level of detail
+
+    glm::vec3 m_boundsMinimum = glm::vec3(0.0f);
+    glm::vec3 m_boundsMaximum = glm::vec3(0.0f);
+    glm::vec3 m_boundsCenter = glm::vec3(0.0f);
+    float m_boundsRadius = 0.0f;
+
+    Buffer m_positionBuffer;
+    Buffer m_attributeBuffer;
+    Buffer m_uvSet1Buffer;
+    Buffer m_indexBuffer;
+    VkIndexType m_indexType = VK_INDEX_TYPE_UINT32;
+};
@@ -0,0 +1,80 @@
+#include <Resources/StagingAllocator.hpp>
+
+void StagingAllocator::Destroy()
+{
+    std::lock_guard<std::mutex> const lock(m_mutex);
+    m_blocks.clear();
+}
+
+StagingAllocation StagingAllocator::Allocate(uint64_t size)
+{
+    std::lock_guard<std::mutex> const lock(m_mutex);
+
+    Block* block = nullptr;
+    uint64_t offset = 0;
+    for (UniquePtr<Block>& candidate : m_blocks)
+    {
+        offset = (candidate->m_offset + ms_alignment - 1) / ms_alignment * ms_alignment;
+        if (offset + size <= candidate->m_capacity)
+        {
+            block = candidate.get();
+            break;
+        }
+    }
+
+    if (!block)
+    {
+        BufferInfo bufferInfo;
+        bufferInfo.m_size = std::max(size, ms_blockSize);
+        bufferInfo.m_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        bufferInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_ONLY;
+
+        block = m_blocks.emplace_back(std::make_unique<Block>()).get();
+        block->m_buffer = Buffer(bufferInfo);
+        block->m_capacity = bufferInfo.m_size;
+        offset = 0;
+    }
+
+    block->m_offset = offset + size;
+    block->m_allocationCount++;
+
+    StagingAllocation allocation;
+    allocation.m_buffer = &block->m_buffer;
+    allocation.m_offset = offset;
+    allocation.m_data = static_cast<uint8_t*>(block->m_buffer.MapMemory()) + offset;
+    return allocation;
+}
+
+void StagingAllocator::Free(StagingAllocation& allocation)
+{
+    if (!allocation.IsValid())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> const lock(m_mutex);
+
+    auto const foundIt = std::find_if(m_blocks.begin(), m_blocks.end(), [&](UniquePtr<Block> const& block) { return &block->m_buffer == allocation.m_buffer; });
+    Assert(foundIt != m_blocks.end(), "Freeing a staging allocation of another allocator");
+
+    Block& block = **foundIt;
+    if (--block.m_allocationCount == 0)
+    {
+        // A single empty block of the regular size is kept for the next loads
+        bool const hasOtherEmptyBlock = std::any_of(m_blocks.begin(), m_blocks.end(), [&](UniquePtr<Block> const& other)
+        {
+            return other.get() != &block && other->m_allocationCount == 0;
+        });
+
+        if (block.m_capacity > ms_blockSize || hasOtherEmptyBlock)
+        {
+            m_blocks.erase(foundIt);
+        }
+        else
+        {
+            block.m_offset = 0;
+        }
+    }
+
+    allocation = {};
+}
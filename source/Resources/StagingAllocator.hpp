@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Resources/Buffer.hpp>
+#include <Utilities/Helpers.hpp>
+
+// Suballocation of the staging memory, written by the CPU and copied from by transfer commands
+struct StagingAllocation
+{
+    Buffer const* m_buffer = nullptr;
+    uint64_t m_offset = 0;
+    void* m_data = nullptr; // Mapped memory at the offset
+
+    bool IsValid() const { return m_buffer != nullptr; }
+};
+
+// Linear allocator over persistently mapped transfer source blocks, so data can be written where the upload reads it.
+// A block is reused once every allocation made from it is freed. Allocating and freeing are thread safe.
+class StagingAllocator
+{
+public:
+    void Destroy();
+
+    StagingAllocation Allocate(uint64_t size);
+    void Free(StagingAllocation& allocation);
+
+private:
+    struct Block
+    {
+        Buffer m_buffer;
+        uint64_t m_capacity = 0;
+        uint64_t m_offset = 0;
+        uint32_t m_allocationCount = 0;
+    };
+
+    std::vector<UniquePtr<Block>> m_blocks;
+    std::mutex m_mutex;
+
+public:
+    static constexpr uint64_t ms_blockSize = 64 * 1024 * 1024; // Larger allocations get a block of their own
+    static constexpr uint64_t ms_alignment = 16; // Of every allocation, a multiple of any texel or block size
+};
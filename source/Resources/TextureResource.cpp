@@ -2,6 +2,9 @@
 
 #include <Resources/Buffer.hpp>
 #include <Systems/Renderer.hpp>
+#include <Systems/ResourceManager.hpp>
+
+static ImageCreateInfo GetMipChainCreateInfo(ImageCreateInfo const& imageCreateInfo, uint8_t firstMip);
 
 TextureResource::TextureResource(TextureCreationInfo const& creationInfo)
 {
@@ -15,11 +18,17 @@ TextureResource::TextureResource(TextureCreationInfo const& creationInfo)
         m_creationInfo.m_imageCreateInfo.m_mipLevels = floor(log2(std::max(extent.width, extent.height))) + 1;
     }
 
-    ImageCreateInfo const& imageCreateInfo = m_creationInfo.m_imageCreateInfo;
-    m_image->SetCreationInfo(imageCreateInfo);
+    m_firstMip = std::min<uint8_t>(m_creationInfo.m_firstMip, m_creationInfo.m_imageCreateInfo.m_mipLevels - 1);
+    m_image->SetCreationInfo(GetMipChainCreateInfo(m_creationInfo.m_imageCreateInfo, m_firstMip));
 
     CreateImage();
 
+    // The data belongs to the caller and is only valid during the upload, the kept creation info must not point to it
+    m_creationInfo.m_data = nullptr;
+    m_creationInfo.m_mipOffsets = nullptr;
+    m_creationInfo.m_dataSize = 0;
+    m_creationInfo.m_stagingData = {};
+
     m_image->CreateImageView();
     
     CreateTextureSampler();
@@ -34,10 +43,19 @@ void TextureResource::CreateFromImage(SharedPtr<ImageResource>& image)
 
 void TextureResource::Destroy()
 {
+    if (m_bindlessIndex != ms_invalidBindlessIndex)
+    {
+        // The slot is recycled once no frame in flight can sample it
+        ResourceManager::GetInstance().FreeBindlessTexture(m_bindlessIndex);
+        m_bindlessIndex = ms_invalidBindlessIndex;
+    }
+
     m_image = std::make_shared<ImageResource>();
     m_creationInfo = TextureCreationInfo();
     m_readInPasses.clear();
     m_isPersistent = false;
+    m_contentHash = 0;
+    m_firstMip = 0;
 
     if (m_sampler != VK_NULL_HANDLE)
     {
@@ -60,9 +78,13 @@ TextureResource::TextureResource(TextureResource&& other) noexcept
     m_sampler = other.m_sampler;
     m_readInPasses = std::move(other.m_readInPasses);
     m_isPersistent = other.m_isPersistent;
+    m_contentHash = other.m_contentHash;
+    m_firstMip = other.m_firstMip;
+    m_bindlessIndex = other.m_bindlessIndex;
 
     other.m_image = nullptr;
     other.m_sampler = VK_NULL_HANDLE;
+    other.m_bindlessIndex = ms_invalidBindlessIndex;
 }
 
 TextureResource& TextureResource::operator=(TextureResource&& other) noexcept
@@ -79,16 +101,20 @@ TextureResource& TextureResource::operator=(TextureResource&& other) noexcept
     m_sampler = other.m_sampler;
     m_readInPasses = std::move(other.m_readInPasses);
     m_isPersistent = other.m_isPersistent;
+    m_contentHash = other.m_contentHash;
+    m_firstMip = other.m_firstMip;
+    m_bindlessIndex = other.m_bindlessIndex;
 
     other.m_image = nullptr;
     other.m_sampler = VK_NULL_HANDLE;
+    other.m_bindlessIndex = ms_invalidBindlessIndex;
 
     return *this;
 }
 
 void TextureResource::CreateImage()
 {
-    if (m_creationInfo.m_data != nullptr)
+    if (m_creationInfo.m_data != nullptr || m_creationInfo.m_stagingData.IsValid())
     {
         CreateImageWithData();
     }
@@ -104,31 +130,45 @@ void TextureResource::CreateImageWithData()
     ImageCreateInfo& imageCreateInfo = m_creationInfo.m_imageCreateInfo;
     VkExtent2D const extent = m_image->GetExtent();
 
-    uint64_t const imageSize = extent.width * extent.height * m_creationInfo.m_channels * m_creationInfo.m_bytesPerChannel * imageCreateInfo.m_layers;
+    uint64_t const imageSize = m_creationInfo.m_mipOffsets != nullptr ? m_creationInfo.m_dataSize :
+        extent.width * extent.height * m_creationInfo.m_channels * m_creationInfo.m_bytesPerChannel * imageCreateInfo.m_layers;
 
-    BufferInfo bufferInfo;
-    bufferInfo.m_size = imageSize;
-    bufferInfo.m_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    bufferInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_ONLY;
-
-    Buffer stagingBuffer = Buffer(bufferInfo);
-    stagingBuffer.CopyDataToBuffer(m_creationInfo.m_data, imageSize);
+    // Data that is not staged yet is copied to staging memory of its own for the upload
+    StagingAllocator& stagingAllocator = renderer.GetStagingAllocator();
+    StagingAllocation stagingData = m_creationInfo.m_stagingData;
+    if (!stagingData.IsValid())
+    {
+        stagingData = stagingAllocator.Allocate(imageSize);
+        memcpy(stagingData.m_data, m_creationInfo.m_data, imageSize);
+    }
 
-    m_image->AddImageUsageFlags(VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+    m_image->AddImageUsageFlags(VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | m_creationInfo.m_usage);
     m_image->CreateImage();
 
     VkCommandBuffer commandBuffer = renderer.BeginSingleUseCommandBuffer();
     m_image->TransitionLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, commandBuffer);
-    CopyFromBuffer(commandBuffer, stagingBuffer);
-    m_image->GenerateMipmaps(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    CopyFromBuffer(commandBuffer, *stagingData.m_buffer, stagingData.m_offset);
+    if (m_creationInfo.m_mipOffsets != nullptr)
+    {
+        m_image->TransitionLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, commandBuffer);
+    }
+    else
+    {
+        m_image->GenerateMipmaps(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
     renderer.EndSingleUseCommandBuffer(commandBuffer);
+
+    if (!m_creationInfo.m_stagingData.IsValid())
+    {
+        stagingAllocator.Free(stagingData);
+    }
 }
 
 void TextureResource::CreateImageWithoutData()
 {
     Renderer& renderer = Renderer::GetInstance();
 
-    m_image->AddImageUsageFlags(VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+    m_image->AddImageUsageFlags(VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | m_creationInfo.m_usage);
     m_image->CreateImage();
 
     VkCommandBuffer commandBuffer = renderer.BeginSingleUseCommandBuffer();
@@ -153,8 +193,8 @@ void TextureResource::CreateTextureSampler()
     samplerInfo.addressModeV = m_creationInfo.m_samplerInfo.m_addressModeV;
     samplerInfo.addressModeW = m_creationInfo.m_samplerInfo.m_addressModeW;
     samplerInfo.unnormalizedCoordinates = VK_FALSE;
-    samplerInfo.compareEnable = VK_FALSE;
-    samplerInfo.compareOp = VK_COMPARE_OP_NEVER;
+    samplerInfo.compareEnable = m_creationInfo.m_samplerInfo.m_compareOp != VK_COMPARE_OP_NEVER;
+    samplerInfo.compareOp = m_creationInfo.m_samplerInfo.m_compareOp;
     samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
     samplerInfo.maxAnisotropy = renderSettings.m_useAnisotropy ? m_creationInfo.m_samplerInfo.m_anisotropy : 1.0f;
     samplerInfo.anisotropyEnable = renderSettings.m_useAnisotropy && samplerInfo.maxAnisotropy > 1.0f;
@@ -168,16 +208,40 @@ void TextureResource::CreateTextureSampler()
     }
 }
 
-void TextureResource::CopyFromBuffer(VkCommandBuffer commandBuffer, Buffer const& buffer)
+void TextureResource::CopyFromBuffer(VkCommandBuffer commandBuffer, Buffer const& buffer, uint64_t bufferOffset)
 {
     VkImageAspectFlags const aspectFlags = Renderer::GetAspectFlagsFromFormat(m_creationInfo.m_imageCreateInfo.m_format);
     VkExtent2D const extent = m_image->GetExtent();
+
+    if (m_creationInfo.m_mipOffsets != nullptr)
+    {
+        // A region per mip of the image covering every layer, the layers of a mip follow each other tightly packed
+        uint8_t const mipLevels = m_image->GetCreationInfo().m_mipLevels;
+        std::vector<VkBufferImageCopy> mipCopyRegions;
+        mipCopyRegions.reserve(mipLevels);
+
+        for (uint32_t mipLevel = 0; mipLevel < mipLevels; mipLevel++)
+        {
+            VkBufferImageCopy bufferCopyRegion = {};
+            bufferCopyRegion.bufferOffset = bufferOffset + m_creationInfo.m_mipOffsets[mipLevel];
+            bufferCopyRegion.imageSubresource.aspectMask = aspectFlags;
+            bufferCopyRegion.imageSubresource.mipLevel = mipLevel;
+            bufferCopyRegion.imageSubresource.baseArrayLayer = 0;
+            bufferCopyRegion.imageSubresource.layerCount = m_creationInfo.m_imageCreateInfo.m_layers;
+            bufferCopyRegion.imageExtent = { std::max(extent.width >> mipLevel, 1u), std::max(extent.height >> mipLevel, 1u), 1 };
+            mipCopyRegions.push_back(bufferCopyRegion);
+        }
+
+        vkCmdCopyBufferToImage(commandBuffer, buffer.GetBuffer(), m_image->GetImage(), m_image->GetCurrentLayout(), mipCopyRegions.size(), mipCopyRegions.data());
+        return;
+    }
+
     uint64_t const layerSize = extent.width * extent.height * m_creationInfo.m_channels * m_creationInfo.m_bytesPerChannel;
 
     std::vector<VkBufferImageCopy> bufferCopyRegions;
     bufferCopyRegions.reserve(m_creationInfo.m_imageCreateInfo.m_layers);
     
-    uint64_t offset = 0;
+    uint64_t offset = bufferOffset;
     for (uint32_t layer = 0; layer < m_creationInfo.m_imageCreateInfo.m_layers; layer++)
     {
         VkBufferImageCopy bufferCopyRegion = {};
@@ -199,6 +263,69 @@ void TextureResource::CopyFromBuffer(VkCommandBuffer commandBuffer, Buffer const
     vkCmdCopyBufferToImage(commandBuffer, buffer.GetBuffer(), m_image->GetImage(), m_image->GetCurrentLayout(), bufferCopyRegions.size(), bufferCopyRegions.data());
 }
 
+SharedPtr<ImageResource> TextureResource::RecordFirstMipChange(uint8_t firstMip, Buffer const& buffer, std::vector<uint64_t> const& bufferOffsets, VkCommandBuffer commandBuffer)
+{
+    ImageCreateInfo const& imageCreateInfo = m_creationInfo.m_imageCreateInfo;
+    VkImageAspectFlags const aspectFlags = Renderer::GetAspectFlagsFromFormat(imageCreateInfo.m_format);
+    VkExtent2D const extent = ImageResource::GetExtent(imageCreateInfo);
+
+    SharedPtr<ImageResource> const previousImage = m_image;
+    uint8_t const previousFirstMip = m_firstMip;
+
+    m_image = std::make_shared<ImageResource>();
+    m_image->SetCreationInfo(GetMipChainCreateInfo(imageCreateInfo, firstMip));
+    m_image->AddImageUsageFlags(previousImage->GetImageUsage());
+    m_image->CreateImage();
+    m_image->CreateImageView();
+    m_firstMip = firstMip;
+
+    m_image->TransitionLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, commandBuffer);
+
+    // Frames in flight may still sample the previous image, it goes back to being readable once copied
+    std::vector<VkImageCopy> imageCopyRegions;
+    for (uint32_t mipLevel = std::max(firstMip, previousFirstMip); mipLevel < imageCreateInfo.m_mipLevels; mipLevel++)
+    {
+        VkImageCopy imageCopyRegion = {};
+        imageCopyRegion.srcSubresource = { aspectFlags, mipLevel - previousFirstMip, 0, imageCreateInfo.m_layers };
+        imageCopyRegion.dstSubresource = { aspectFlags, mipLevel - firstMip, 0, imageCreateInfo.m_layers };
+        imageCopyRegion.extent = { std::max(extent.width >> mipLevel, 1u), std::max(extent.height >> mipLevel, 1u), 1 };
+        imageCopyRegions.push_back(imageCopyRegion);
+    }
+
+    VkImageLayout const previousLayout = previousImage->GetCurrentLayout();
+    previousImage->TransitionLayout(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, commandBuffer);
+    vkCmdCopyImage(commandBuffer, previousImage->GetImage(), previousImage->GetCurrentLayout(), m_image->GetImage(), m_image->GetCurrentLayout(), imageCopyRegions.size(), imageCopyRegions.data());
+    previousImage->TransitionLayout(previousLayout, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, commandBuffer);
+
+    // The mips the previous image did not hold come from the buffer
+    std::vector<VkBufferImageCopy> bufferCopyRegions;
+    for (uint32_t mipLevel = firstMip; mipLevel < previousFirstMip; mipLevel++)
+    {
+        VkBufferImageCopy bufferCopyRegion = {};
+        bufferCopyRegion.bufferOffset = bufferOffsets[mipLevel - firstMip];
+        bufferCopyRegion.imageSubresource = { aspectFlags, mipLevel - firstMip, 0, imageCreateInfo.m_layers };
+        bufferCopyRegion.imageExtent = { std::max(extent.width >> mipLevel, 1u), std::max(extent.height >> mipLevel, 1u), 1 };
+        bufferCopyRegions.push_back(bufferCopyRegion);
+    }
+
+    if (!bufferCopyRegions.empty())
+    {
+        vkCmdCopyBufferToImage(commandBuffer, buffer.GetBuffer(), m_image->GetImage(), m_image->GetCurrentLayout(), bufferCopyRegions.size(), bufferCopyRegions.data());
+    }
+
+    m_image->TransitionLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, commandBuffer);
+
+    // A new slot, the previous one is recycled once no frame in flight samples it
+    if (IsBindless())
+    {
+        ResourceManager& resourceManager = ResourceManager::GetInstance();
+        resourceManager.FreeBindlessTexture(m_bindlessIndex);
+        m_bindlessIndex = resourceManager.AllocateBindlessTexture(GetDescriptorInfo());
+    }
+
+    return previousImage;
+}
+
 bool TextureResource::IsValid() const
 {
     return m_image && m_image->IsValid()
@@ -213,3 +340,31 @@ VkDescriptorImageInfo TextureResource::GetDescriptorInfo() const
     descriptorInfo.sampler = m_sampler;
     return descriptorInfo;
 }
+
+void TextureResource::MakeBindless()
+{
+    if (IsBindless())
+    {
+        return;
+    }
+
+    m_bindlessIndex = ResourceManager::GetInstance().AllocateBindlessTexture(GetDescriptorInfo());
+}
+
+static ImageCreateInfo GetMipChainCreateInfo(ImageCreateInfo const& imageCreateInfo, uint8_t firstMip)
+{
+    if (firstMip == 0)
+    {
+        // Keeps the size relative to the swapchain
+        return imageCreateInfo;
+    }
+
+    VkExtent2D const extent = ImageResource::GetExtent(imageCreateInfo);
+
+    ImageCreateInfo mipChainCreateInfo = imageCreateInfo;
+    mipChainCreateInfo.m_width = static_cast<float>(std::max(extent.width >> firstMip, 1u));
+    mipChainCreateInfo.m_height = static_cast<float>(std::max(extent.height >> firstMip, 1u));
+    mipChainCreateInfo.m_sizeType = SizeType::Absolute;
+    mipChainCreateInfo.m_mipLevels = imageCreateInfo.m_mipLevels - firstMip;
+    return mipChainCreateInfo;
+}
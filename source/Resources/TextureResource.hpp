@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Resources/ImageResource.hpp>
+#include <Resources/StagingAllocator.hpp>
 #include <Utilities/Helpers.hpp>
 
 class Buffer;
@@ -13,6 +14,7 @@ struct TextureSampler
     VkSamplerAddressMode m_addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
     VkSamplerAddressMode m_addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
     float m_anisotropy = FLT_MAX;
+    VkCompareOp m_compareOp = VK_COMPARE_OP_NEVER; // Anything else makes a depth comparison sampler
 };
 
 struct TextureCreationInfo
@@ -21,7 +23,16 @@ struct TextureCreationInfo
     uint8_t m_channels = 0;
     uint8_t m_bytesPerChannel = 0;
     TextureSampler m_samplerInfo;
+    VkImageUsageFlags m_usage = 0; // Added to the transfer and sampled usages
+    // The data fields are only read while the texture is created, they are cleared from the creation info it keeps
     void const* m_data = nullptr;
+    // Prebuilt mips, an offset into the data per level. They are uploaded as they are instead of generated.
+    uint64_t const* m_mipOffsets = nullptr;
+    uint64_t m_dataSize = 0; // Only needed with prebuilt mips
+    // The image only holds the mips from this one down, the data starts with it. See TextureStreamer.
+    uint8_t m_firstMip = 0;
+    // Data already written to staging memory, uploaded from there instead of m_data. The caller frees it.
+    StagingAllocation m_stagingData;
 };
 
 class TextureResource 
@@ -53,8 +64,21 @@ public:
     bool IsPersistent() { return m_isPersistent; }
     bool IsValid() const;
     VkDescriptorImageInfo GetDescriptorInfo() const;
+    uint64_t GetContentHash() const { return m_contentHash; }
+    void SetContentHash(uint64_t hash) { m_contentHash = hash; }
 
-    void CopyFromBuffer(VkCommandBuffer commandBuffer, Buffer const& buffer);
+    // Bindless
+    void MakeBindless();
+    uint32_t GetBindlessIndex() const { return m_bindlessIndex; }
+    bool IsBindless() const { return m_bindlessIndex != ms_invalidBindlessIndex; }
+
+    void CopyFromBuffer(VkCommandBuffer commandBuffer, Buffer const& buffer, uint64_t bufferOffset = 0);
+
+    // Streaming
+    uint8_t GetFirstMip() const { return m_firstMip; }
+    // Swaps the image for one holding the mips from firstMip down. The mips held by both are copied over, the others
+    // are read from the buffer at an offset per mip. Returns the previous image, which must outlive the frames in flight.
+    SharedPtr<ImageResource> RecordFirstMipChange(uint8_t firstMip, Buffer const& buffer, std::vector<uint64_t> const& bufferOffsets, VkCommandBuffer commandBuffer);
 
 private:
     void CreateImage();
@@ -71,4 +95,11 @@ private:
     TextureCreationInfo m_creationInfo;
     std::set<uint64_t> m_readInPasses;
     bool m_isPersistent = false;
+    uint64_t m_contentHash = 0; // Of the source data, zero when unknown
+    uint8_t m_firstMip = 0; // Largest mip held by the image
+
+    uint32_t m_bindlessIndex = ms_invalidBindlessIndex;
+
+public:
+    static constexpr uint32_t ms_invalidBindlessIndex = UINT32_MAX;
 };
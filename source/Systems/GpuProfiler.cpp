@@ -0,0 +1,146 @@
+#include <Systems/GpuProfiler.hpp>
+
+#include <Systems/Renderer.hpp>
+
+void GpuProfiler::Init()
+{
+    Renderer& renderer = Renderer::GetInstance();
+    VkPhysicalDeviceLimits const& limits = renderer.GetPhysicalDeviceInfo().m_properties.limits;
+
+    m_isSupported = renderer.GetRenderSettings().m_useGpuProfiler && limits.timestampComputeAndGraphics;
+    if (!m_isSupported)
+    {
+        return;
+    }
+
+    m_timestampPeriod = limits.timestampPeriod;
+    m_frameScopes.resize(Renderer::RenderSettings::m_maxFramesInFlight);
+
+    // Two timestamps per scope, one range of scopes per frame in flight
+    VkQueryPoolCreateInfo queryPoolInfo = {};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = 2 * ms_maxScopesPerFrame * Renderer::RenderSettings::m_maxFramesInFlight;
+
+    if (vkCreateQueryPool(renderer.GetDevice(), &queryPoolInfo, nullptr, &m_queryPool) != VK_SUCCESS)
+    {
+        ThrowError("Failed to create timestamp query pool.");
+    }
+}
+
+void GpuProfiler::Terminate()
+{
+    if (m_queryPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(Renderer::GetInstance().GetDevice(), m_queryPool, nullptr);
+        m_queryPool = VK_NULL_HANDLE;
+    }
+
+    m_frameScopes.clear();
+    m_accumulatedTimes.clear();
+    m_averageTimes.clear();
+    m_accumulatedFrames = 0;
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer)
+{
+    if (!m_isSupported)
+    {
+        return;
+    }
+
+    // The renderer waited for the fence of this frame in flight, its previous queries are complete
+    uint16_t const frameIndex = Renderer::GetInstance().GetCurrentFrame();
+    ReadFrameResults(frameIndex);
+
+    vkCmdResetQueryPool(commandBuffer, m_queryPool, 2 * ms_maxScopesPerFrame * frameIndex, 2 * ms_maxScopesPerFrame);
+    m_frameScopes[frameIndex].clear();
+}
+
+void GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, std::string const& name)
+{
+    if (!m_isSupported)
+    {
+        return;
+    }
+
+    uint16_t const frameIndex = Renderer::GetInstance().GetCurrentFrame();
+    std::vector<std::string>& scopes = m_frameScopes[frameIndex];
+    if (scopes.size() >= ms_maxScopesPerFrame)
+    {
+        return;
+    }
+
+    uint32_t const query = 2 * (ms_maxScopesPerFrame * frameIndex + scopes.size());
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, query);
+    scopes.push_back(name);
+    m_isScopeOpen = true;
+}
+
+void GpuProfiler::EndScope(VkCommandBuffer commandBuffer)
+{
+    // Scopes over the per frame limit are not recorded
+    if (!m_isSupported || !m_isScopeOpen)
+    {
+        return;
+    }
+
+    uint16_t const frameIndex = Renderer::GetInstance().GetCurrentFrame();
+    std::vector<std::string> const& scopes = m_frameScopes[frameIndex];
+    m_isScopeOpen = false;
+
+    uint32_t const query = 2 * (ms_maxScopesPerFrame * frameIndex + scopes.size() - 1) + 1;
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, query);
+}
+
+float GpuProfiler::GetScopeTime(std::string const& name) const
+{
+    auto foundIt = m_averageTimes.find(name);
+    return foundIt != m_averageTimes.end() ? foundIt->second : 0.0f;
+}
+
+void GpuProfiler::ReadFrameResults(uint16_t frameIndex)
+{
+    std::vector<std::string> const& scopes = m_frameScopes[frameIndex];
+    if (scopes.empty())
+    {
+        return;
+    }
+
+    std::vector<uint64_t> timestamps(2 * scopes.size());
+    VkResult const result = vkGetQueryPoolResults(Renderer::GetInstance().GetDevice(), m_queryPool,
+        2 * ms_maxScopesPerFrame * frameIndex, timestamps.size(),
+        timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT);
+
+    if (result != VK_SUCCESS)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < scopes.size(); i++)
+    {
+        double const ticks = static_cast<double>(timestamps[2 * i + 1] - timestamps[2 * i]);
+        m_accumulatedTimes[scopes[i]] += ticks * m_timestampPeriod * 1e-6;
+    }
+
+    if (++m_accumulatedFrames >= ms_logInterval)
+    {
+        LogScopeTimes();
+    }
+}
+
+void GpuProfiler::LogScopeTimes()
+{
+    std::string message = StringFormat("GPU times over %u frames:", m_accumulatedFrames);
+    for (auto const& [name, time] : m_accumulatedTimes)
+    {
+        m_averageTimes[name] = static_cast<float>(time / m_accumulatedFrames);
+        message += StringFormat(" %s %.3f ms", name.c_str(), m_averageTimes[name]);
+    }
+
+    Log("%s", message.c_str());
+
+    m_accumulatedTimes.clear();
+    m_accumulatedFrames = 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Utilities/Helpers.hpp>
+
+// Measures the GPU time of named scopes of the frame with timestamp queries
+class GpuProfiler
+{
+public:
+    void Init();
+    void Terminate();
+
+    // Reads back the timings of the last submission of this frame in flight and resets its queries
+    void BeginFrame(VkCommandBuffer commandBuffer);
+    void BeginScope(VkCommandBuffer commandBuffer, std::string const& name);
+    void EndScope(VkCommandBuffer commandBuffer);
+
+    // Average time in milliseconds of a scope over the last logging interval
+    float GetScopeTime(std::string const& name) const;
+
+private:
+    void ReadFrameResults(uint16_t frameIndex);
+    void LogScopeTimes();
+
+private:
+    VkQueryPool m_queryPool = VK_NULL_HANDLE;
+    float m_timestampPeriod = 1.0f; // Nanoseconds per tick
+    bool m_isSupported = false;
+    bool m_isScopeOpen = false;
+
+    std::vector<std::vector<std::string>> m_frameScopes;
+    std::map<std::string, double> m_accumulatedTimes;
+    std::map<std::string, float> m_averageTimes;
+    uint32_t m_accumulatedFrames = 0;
+
+    static constexpr uint32_t ms_maxScopesPerFrame = 32;
+    static constexpr uint32_t ms_logInterval = 600;
+};
@@ -4,14 +4,40 @@
 #include <Components/SceneComponent.hpp>
 #include <Components/StaticMeshComponent.hpp>
 #include <Resources/Descriptor.hpp>
+#include <Resources/IBLCacheFormat.hpp>
 #include <Resources/ImageResource.hpp>
+#include <Resources/MeshAsset.hpp>
 #include <Resources/TextureResource.hpp>
 #include <Systems/EntitySystem.hpp>
+#include <Systems/Renderer.hpp>
+#include <Systems/ResourceManager.hpp>
+#include <Systems/TextureStreamer.hpp>
+#include <Utilities/Ktx2.hpp>
+#include <Utilities/MeshOptimizer.hpp>
+#include <Utilities/MeshSimplifier.hpp>
+#include <Utilities/ParallelFor.hpp>
+
+// Decoded glTF image, its texels are in staging memory unless they are kept on the CPU to stream the texture
+struct GltfImageData
+{
+    StagingAllocation m_stagingData; // Invalid when the texels are in the tinygltf image
+    uint64_t m_contentHash = 0; // Of the image as stored
+};
 
 static bool IsValidTextureSampler(TextureSampler const& sampler);
 static VkSamplerAddressMode GetVkWrapModeFromGltf(int32_t const wrapMode);
 static VkFilter GetVkFilterModeFromGltf(int32_t const filterMode);
 static VkFormat GetImageFormat(uint8_t channels, uint8_t bytesPerChannel, bool isHdr = false);
+static VkFormat GetUnormFormat(VkFormat format);
+static SharedPtr<TextureResource> CreateTextureKtx2(void const* data, size_t size, Ktx2Header const& header, TextureSampler const& textureSampler, bool isStreamed = false);
+static StreamedTextureData GenerateStreamedMips(uint8_t const* texels, uint32_t width, uint32_t height, uint32_t channels);
+static int32_t GetGltfKtx2Source(tinygltf::Texture const& gltfTexture);
+static bool LoadGltfImageData(tinygltf::Image* image, int imageIndex, std::string* error, std::string* warning, int requestedWidth, int requestedHeight, unsigned char const* bytes, int size, void* userData);
+static void DecodeGltfImages(tinygltf::Model& gltfModel, std::vector<GltfImageData>& images);
+static void OptimizePrimitive(std::vector<SourceVertex>& vertices, std::vector<uint32_t>& indices, Primitive& primitive, uint64_t vertexStart, VertexCacheStatistics& sourceStatistics);
+static void ComputeUvDensity(std::vector<SourceVertex> const& vertices, std::vector<uint32_t> const& indices, Primitive& primitive);
+static VertexCacheStatistics AnalyzeMeshVertexCache(std::vector<uint32_t> const& indices, std::vector<Primitive> const& primitives);
+static std::vector<float> GenerateMeshLods(std::vector<SourceVertex> const& vertices, std::vector<uint32_t>& indices, std::vector<Primitive>& primitives);
 
 void Loader::Init()
 {
@@ -41,6 +67,7 @@ void Loader::LoadModel(entt::entity entity, std::string const& filePath, std::fu
     tinygltf::Model gltfModel;
     tinygltf::TinyGLTF gltfContext;
     std::string loadError, loadWarning;
+    gltfContext.SetImageLoader(&LoadGltfImageData, nullptr);
 
     bool const fileLoaded = binary ? 
         gltfContext.LoadBinaryFromFile(&gltfModel, &loadError, &loadWarning, filePath.c_str()) :
@@ -58,10 +85,24 @@ void Loader::LoadModel(entt::entity entity, std::string const& filePath, std::fu
         return;
     }
 
+    std::vector<GltfImageData> images;
+    DecodeGltfImages(gltfModel, images);
+
+    // Mesh assets and textures are cached by file, the same file loaded twice shares them
+    std::string const canonicalFilePath = std::filesystem::weakly_canonical(filePath).string();
+
     std::vector<TextureSampler> textureSamplers;
     LoadTextureSamplers(gltfModel, textureSamplers);
     std::vector<SharedPtr<TextureResource>> textures;
-    LoadTextures(gltfModel, textures, textureSamplers);
+    LoadTextures(gltfModel, images, textures, textureSamplers, canonicalFilePath);
+
+    // Every texture has been uploaded
+    StagingAllocator& stagingAllocator = Renderer::GetInstance().GetStagingAllocator();
+    for (GltfImageData& imageData : images)
+    {
+        stagingAllocator.Free(imageData.m_stagingData);
+    }
+
     std::vector<SharedPtr<Material>> materials;
     LoadMaterials(gltfModel, materials, textures);
 
@@ -73,11 +114,11 @@ void Loader::LoadModel(entt::entity entity, std::string const& filePath, std::fu
     for (int32_t const& nodeIndex : gltfScene.nodes)
     {
         tinygltf::Node const& gltfNode = gltfModel.nodes[nodeIndex];
-        LoadModelNode(rootSceneComponent, gltfNode, gltfModel, materials, nodeLoadedCallback);
+        LoadModelNode(rootSceneComponent, gltfNode, gltfModel, materials, canonicalFilePath, nodeLoadedCallback);
     }
 }
 
-void Loader::LoadModelNode(SceneComponent& parentSceneComponent, tinygltf::Node const& gltfNode, tinygltf::Model const& gltfModel, std::vector<SharedPtr<Material>> const& materials, std::function<void(entt::entity)> const& nodeLoadedCallback)
+void Loader::LoadModelNode(SceneComponent& parentSceneComponent, tinygltf::Node const& gltfNode, tinygltf::Model const& gltfModel, std::vector<SharedPtr<Material>> const& materials, std::string const& filePath, std::function<void(entt::entity)> const& nodeLoadedCallback)
 {
     EntitySystem& entitySystem = EntitySystem::GetInstance();
     Entity nodeEntity = entitySystem.CreateEntity();
@@ -107,14 +148,20 @@ void Loader::LoadModelNode(SceneComponent& parentSceneComponent, tinygltf::Node
     // Node contains mesh data
     if (gltfNode.mesh >= 0)
     {
-        LoadMesh(nodeEntity, gltfNode, gltfModel, materials);
+        LoadMesh(nodeEntity, gltfNode, gltfModel, materials, filePath);
+
+        auto const& instancingIt = gltfNode.extensions.find("EXT_mesh_gpu_instancing");
+        if (instancingIt != gltfNode.extensions.end())
+        {
+            LoadMeshInstances(nodeEntity, instancingIt->second, gltfModel);
+        }
     }
 
     // Load children
     for (int32_t const& childIndex : gltfNode.children)
     {
         tinygltf::Node const& childNode = gltfModel.nodes[childIndex];
-        LoadModelNode(nodeSceneComponent, childNode, gltfModel, materials);
+        LoadModelNode(nodeSceneComponent, childNode, gltfModel, materials, filePath);
     }
 
     if (nodeLoadedCallback)
@@ -123,16 +170,25 @@ void Loader::LoadModelNode(SceneComponent& parentSceneComponent, tinygltf::Node
     }
 }
 
-void Loader::LoadMesh(entt::entity nodeEntity, tinygltf::Node const& gltfNode, tinygltf::Model const& gltfModel, std::vector<SharedPtr<Material>> const& materials)
+void Loader::LoadMesh(entt::entity nodeEntity, tinygltf::Node const& gltfNode, tinygltf::Model const& gltfModel, std::vector<SharedPtr<Material>> const& materials, std::string const& filePath)
 {
     EntitySystem& entitySystem = EntitySystem::GetInstance();
-    StaticMeshComponent& nodeMeshComponent = entitySystem.AddComponent<StaticMeshComponent>(nodeEntity);
+    ResourceManager& resourceManager = ResourceManager::GetInstance();
+
+    // Every node referencing the same mesh shares a single asset
+    std::string const meshAssetName = StringFormat("%s#%d", filePath.c_str(), gltfNode.mesh);
+    if (SharedPtr<MeshAsset> const meshAsset = resourceManager.GetMeshAsset(meshAssetName))
+    {
+        entitySystem.AddComponent<StaticMeshComponent>(nodeEntity, meshAsset);
+        return;
+    }
 
     tinygltf::Mesh const& gltfMesh = gltfModel.meshes[gltfNode.mesh];
     
-    std::vector<Vertex> vertices;
+    std::vector<SourceVertex> vertices;
     std::vector<uint32_t> indices;
     std::vector<Primitive> primitives;
+    VertexCacheStatistics sourceStatistics;
 
     for (tinygltf::Primitive const& gltfPrimitive : gltfMesh.primitives)
     {
@@ -188,7 +244,7 @@ void Loader::LoadMesh(entt::entity nodeEntity, tinygltf::Node const& gltfNode, t
 
             for (uint64_t v = 0; v < positionAccessor.count; v++)
             {
-                Vertex vertex = {};
+                SourceVertex vertex = {};
                 vertex.m_position = glm::make_vec3(&bufferPositions[v * 3]);
                 vertex.m_normal = glm::normalize(glm::vec3(bufferNormals ? glm::make_vec3(&bufferNormals[v * 3]) : glm::vec3(0.0f)));
                 vertex.m_uvSet0 = bufferTexCoordSet0 ? glm::make_vec2(&bufferTexCoordSet0[v * 2]) : glm::vec3(0.0f);
@@ -251,13 +307,75 @@ void Loader::LoadMesh(entt::entity nodeEntity, tinygltf::Node const& gltfNode, t
         primitive.m_vertexCount = vertexCount;
         primitive.m_hasIndices = hasIndices;
         primitive.m_material = gltfPrimitive.material >= 0 ? materials[gltfPrimitive.material] : nullptr;
+
+        OptimizePrimitive(vertices, indices, primitive, vertexStart, sourceStatistics);
+        ComputeUvDensity(vertices, indices, primitive);
         
         primitives.push_back(primitive);
     }
 
-    nodeMeshComponent.SetVertices(vertices);
-    nodeMeshComponent.SetIndices(indices);
-    nodeMeshComponent.SetPrimitives(primitives);
+    VertexCacheStatistics const statistics = AnalyzeMeshVertexCache(indices, primitives);
+    Log("Mesh %s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", meshAssetName.c_str(), 
+        sourceStatistics.GetAcmr(), statistics.GetAcmr(), sourceStatistics.GetAtvr(), statistics.GetAtvr());
+
+    std::vector<float> const lodErrors = GenerateMeshLods(vertices, indices, primitives);
+
+    SharedPtr<MeshAsset> const meshAsset = std::make_shared<MeshAsset>(vertices, indices, primitives, lodErrors);
+    resourceManager.AddMeshAsset(meshAssetName, meshAsset);
+    entitySystem.AddComponent<StaticMeshComponent>(nodeEntity, meshAsset);
+}
+
+void Loader::LoadMeshInstances(entt::entity nodeEntity, tinygltf::Value const& gltfInstancing, tinygltf::Model const& gltfModel)
+{
+    tinygltf::Value const& attributes = gltfInstancing.Get("attributes");
+    if (!attributes.IsObject())
+    {
+        Warn("Mesh instancing extension has no attributes.");
+        return;
+    }
+
+    size_t instanceCount = 0;
+    // The attribute views may be strided, the stride of each attribute is returned in bytes
+    auto const GetAttributeData = [&](std::string const& name, int32_t type, uint32_t componentCount, size_t& stride) -> uint8_t const*
+    {
+        if (!attributes.Has(name))
+        {
+            return nullptr;
+        }
+
+        tinygltf::Accessor const& accessor = gltfModel.accessors[attributes.Get(name).GetNumberAsInt()];
+        if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || accessor.type != type)
+        {
+            Warn("Mesh instancing attribute %s is not stored as floats, ignoring it.", name.c_str());
+            return nullptr;
+        }
+
+        tinygltf::BufferView const& bufferView = gltfModel.bufferViews[accessor.bufferView];
+        // A zero stride means tightly packed
+        stride = bufferView.byteStride != 0 ? bufferView.byteStride : componentCount * sizeof(float);
+        instanceCount = accessor.count;
+        return &(gltfModel.buffers[bufferView.buffer].data[accessor.byteOffset + bufferView.byteOffset]);
+    };
+
+    size_t translationStride = 0;
+    size_t rotationStride = 0;
+    size_t scaleStride = 0;
+    uint8_t const* bufferTranslations = GetAttributeData("TRANSLATION", TINYGLTF_TYPE_VEC3, 3, translationStride);
+    uint8_t const* bufferRotations = GetAttributeData("ROTATION", TINYGLTF_TYPE_VEC4, 4, rotationStride);
+    uint8_t const* bufferScales = GetAttributeData("SCALE", TINYGLTF_TYPE_VEC3, 3, scaleStride);
+
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    SceneInstancesComponent& instancesComponent = entitySystem.AddComponent<SceneInstancesComponent>(nodeEntity);
+    instancesComponent.m_localTransforms.reserve(instanceCount);
+
+    for (size_t i = 0; i < instanceCount; i++)
+    {
+        glm::vec3 const translation = bufferTranslations ? glm::make_vec3(reinterpret_cast<float const*>(bufferTranslations + i * translationStride)) : glm::vec3(0.0f);
+        glm::quat const rotation = bufferRotations ? glm::make_quat(reinterpret_cast<float const*>(bufferRotations + i * rotationStride)) : glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec3 const scale = bufferScales ? glm::make_vec3(reinterpret_cast<float const*>(bufferScales + i * scaleStride)) : glm::vec3(1.0f);
+
+        instancesComponent.m_localTransforms.push_back(glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale));
+    }
 }
 
 void Loader::LoadTextureSamplers(tinygltf::Model const& gltfModel, std::vector<struct TextureSampler>& textureSamplers)
@@ -274,35 +392,107 @@ void Loader::LoadTextureSamplers(tinygltf::Model const& gltfModel, std::vector<s
     }
 }
 
-void Loader::LoadTextures(tinygltf::Model const& gltfModel, std::vector<SharedPtr<TextureResource>>& textures, std::vector<struct TextureSampler> const& textureSamplers)
+void Loader::LoadTextures(tinygltf::Model const& gltfModel, std::vector<GltfImageData> const& images, std::vector<SharedPtr<TextureResource>>& textures, std::vector<struct TextureSampler> const& textureSamplers, std::string const& filePath)
 {
+    std::string const folder = std::filesystem::path(filePath).parent_path().string();
+
     for (tinygltf::Texture const& gltfTexture : gltfModel.textures)
     {
-        tinygltf::Image const& gltfImage = gltfModel.images[gltfTexture.source];
-        
         TextureSampler textureSampler = {};
         if (gltfTexture.sampler >= 0 && IsValidTextureSampler(textureSamplers[gltfTexture.sampler]))
         {
             textureSampler = textureSamplers[gltfTexture.sampler];
         }
 
-        TextureCreationInfo textureInfo;
-        textureInfo.m_imageCreateInfo.m_width = static_cast<float>(gltfImage.width);
-        textureInfo.m_imageCreateInfo.m_height = static_cast<float>(gltfImage.height);
-        textureInfo.m_imageCreateInfo.m_sizeType = SizeType::Absolute;
-        textureInfo.m_imageCreateInfo.m_layers = 1;
-        textureInfo.m_imageCreateInfo.m_mipLevels = UINT8_MAX;
-        textureInfo.m_channels = gltfImage.component;
-        textureInfo.m_bytesPerChannel = gltfImage.bits / 8;
-        textureInfo.m_imageCreateInfo.m_format = GetImageFormat(textureInfo.m_channels, textureInfo.m_bytesPerChannel);
-        textureInfo.m_samplerInfo = textureSampler;
-        textureInfo.m_data = gltfImage.image.data();
+        // The regular source is the fallback of the KTX2 one, for devices without its format
+        SharedPtr<TextureResource> texture = nullptr;
+        int32_t const ktx2Source = GetGltfKtx2Source(gltfTexture);
+        if (ktx2Source >= 0 && ktx2Source < static_cast<int32_t>(gltfModel.images.size()))
+        {
+            texture = LoadGltfImage(gltfModel.images[ktx2Source], images[ktx2Source], textureSampler, folder);
+        }
+
+        if (!texture && gltfTexture.source >= 0)
+        {
+            texture = LoadGltfImage(gltfModel.images[gltfTexture.source], images[gltfTexture.source], textureSampler, folder);
+        }
+
+        if (!texture)
+        {
+            Warn("Texture has no usable image: %s", gltfTexture.name.c_str());
+        }
 
-        SharedPtr<TextureResource> texture = std::make_shared<TextureResource>(textureInfo);
         textures.emplace_back(texture);
     }
 }
 
+SharedPtr<TextureResource> Loader::LoadGltfImage(tinygltf::Image const& gltfImage, GltfImageData const& imageData, TextureSampler const& textureSampler, std::string const& folder)
+{
+    ResourceManager& resourceManager = ResourceManager::GetInstance();
+
+    if (gltfImage.image.empty() && !imageData.m_stagingData.IsValid())
+    {
+        return nullptr;
+    }
+
+    // KTX2 images are kept as stored by LoadGltfImageData, everything else was decoded by DecodeGltfImages
+    bool const isKtx2 = IsKtx2(gltfImage.image.data(), gltfImage.image.size());
+    Ktx2Header ktx2Header;
+    if (isKtx2 && !ParseKtx2(gltfImage.image.data(), gltfImage.image.size(), ktx2Header))
+    {
+        return nullptr;
+    }
+
+    TextureCreationInfo textureInfo;
+    textureInfo.m_imageCreateInfo.m_width = static_cast<float>(gltfImage.width);
+    textureInfo.m_imageCreateInfo.m_height = static_cast<float>(gltfImage.height);
+    textureInfo.m_imageCreateInfo.m_sizeType = SizeType::Absolute;
+    textureInfo.m_imageCreateInfo.m_layers = 1;
+    textureInfo.m_imageCreateInfo.m_mipLevels = UINT8_MAX;
+    textureInfo.m_channels = gltfImage.component;
+    textureInfo.m_bytesPerChannel = gltfImage.bits / 8;
+    textureInfo.m_imageCreateInfo.m_format = isKtx2 ? GetUnormFormat(ktx2Header.m_format) : GetImageFormat(textureInfo.m_channels, textureInfo.m_bytesPerChannel);
+    textureInfo.m_samplerInfo = textureSampler;
+    textureInfo.m_data = gltfImage.image.data();
+    textureInfo.m_stagingData = imageData.m_stagingData;
+
+    // Images in a file of their own are keyed by its path, embedded ones by their content
+    bool const isExternal = !gltfImage.uri.empty() && !gltfImage.uri.starts_with("data:");
+    std::string const source = isExternal ?
+        std::filesystem::weakly_canonical(std::filesystem::path(folder) / gltfImage.uri).string() :
+        StringFormat("%016llx", static_cast<unsigned long long>(imageData.m_contentHash));
+    std::string const textureName = ResourceManager::GetTextureName(source, textureInfo.m_imageCreateInfo.m_format, textureInfo.m_samplerInfo);
+
+    SharedPtr<TextureResource> texture = resourceManager.GetTexture(textureName);
+    if (texture)
+    {
+        return texture;
+    }
+
+    // Material textures keep their large mips resident only while they are visible, three channel images can't be streamed
+    // as their texels are not aligned to the staged mips. Streamed images were decoded to the CPU, the others to staging memory.
+    bool const isStreamed = Renderer::GetInstance().GetRenderSettings().m_useTextureStreaming;
+    if (isKtx2)
+    {
+        texture = CreateTextureKtx2(gltfImage.image.data(), gltfImage.image.size(), ktx2Header, textureSampler, isStreamed);
+    }
+    else if (isStreamed && !imageData.m_stagingData.IsValid() && textureInfo.m_bytesPerChannel == 1 && textureInfo.m_channels != 3)
+    {
+        texture = TextureStreamer::GetInstance().CreateTexture(textureInfo, GenerateStreamedMips(gltfImage.image.data(), gltfImage.width, gltfImage.height, textureInfo.m_channels));
+    }
+    else
+    {
+        texture = std::make_shared<TextureResource>(textureInfo);
+    }
+
+    if (texture)
+    {
+        resourceManager.AddTexture(textureName, texture);
+    }
+
+    return texture;
+}
+
 void Loader::LoadMaterials(tinygltf::Model& gltfModel, std::vector<SharedPtr<Material>>& materials, std::vector<SharedPtr<TextureResource>> const& textures)
 {
     for (tinygltf::Material& gltfMaterial : gltfModel.materials)
@@ -375,9 +565,20 @@ void Loader::LoadMaterials(tinygltf::Model& gltfModel, std::vector<SharedPtr<Mat
 
 SharedPtr<TextureResource> Loader::LoadTexture2D(std::string const& filePath)
 {
-    Log("Load texture 2D: %s", filePath.c_str());
+    ResourceManager& resourceManager = ResourceManager::GetInstance();
 
     TextureCreationInfo textureInfo;
+    textureInfo.m_channels = STBI_rgb_alpha;
+    textureInfo.m_bytesPerChannel = sizeof(stbi_uc);
+    textureInfo.m_imageCreateInfo.m_format = GetImageFormat(textureInfo.m_channels, textureInfo.m_bytesPerChannel);
+
+    std::string const textureName = ResourceManager::GetTextureName(std::filesystem::weakly_canonical(filePath).string(), textureInfo.m_imageCreateInfo.m_format, textureInfo.m_samplerInfo);
+    if (SharedPtr<TextureResource> const texture = resourceManager.GetTexture(textureName))
+    {
+        return texture;
+    }
+
+    Log("Load texture 2D: %s", filePath.c_str());
 
     int32_t width = 0;
     int32_t height = 0;
@@ -393,12 +594,10 @@ SharedPtr<TextureResource> Loader::LoadTexture2D(std::string const& filePath)
     textureInfo.m_imageCreateInfo.m_sizeType = SizeType::Absolute;
     textureInfo.m_imageCreateInfo.m_layers = 1;
     textureInfo.m_imageCreateInfo.m_mipLevels = UINT8_MAX;
-    textureInfo.m_imageCreateInfo.m_format = GetImageFormat(textureInfo.m_channels, textureInfo.m_bytesPerChannel);
-    textureInfo.m_channels = STBI_rgb_alpha;
-    textureInfo.m_bytesPerChannel = sizeof(*imageData);
     textureInfo.m_data = imageData;
 
     SharedPtr<TextureResource> texture = std::make_shared<TextureResource>(textureInfo);
+    resourceManager.AddTexture(textureName, texture);
 
     stbi_image_free(imageData);
 
@@ -407,54 +606,115 @@ SharedPtr<TextureResource> Loader::LoadTexture2D(std::string const& filePath)
 
 SharedPtr<TextureResource> Loader::LoadTextureCubeHdr(std::string const& folderName)
 {
+    ResourceManager& resourceManager = ResourceManager::GetInstance();
+
+    TextureCreationInfo textureInfo;
+    textureInfo.m_channels = STBI_rgb_alpha;
+    textureInfo.m_bytesPerChannel = sizeof(float);
+    textureInfo.m_imageCreateInfo.m_format = GetImageFormat(textureInfo.m_channels, textureInfo.m_bytesPerChannel, true);
+
+    std::string const textureName = ResourceManager::GetTextureName(std::filesystem::weakly_canonical(folderName).string(), textureInfo.m_imageCreateInfo.m_format, textureInfo.m_samplerInfo);
+    if (SharedPtr<TextureResource> const texture = resourceManager.GetTexture(textureName))
+    {
+        return texture;
+    }
+
     Log("Load texture cube hdr: %s", folderName.c_str());
 
     static std::string const fileNames[] = { "negx.hdr", "posx.hdr", "negy.hdr", "posy.hdr", "negz.hdr", "posz.hdr" };
-    
-    TextureCreationInfo textureInfo;
 
+    // The size comes from the header of the first face, each face is then copied once to its place in staging memory
     int32_t width = 0;
     int32_t height = 0;
-
-    float* cubeData[6];
-    for(uint8_t i = 0; i < 6; i++)
+    std::string const firstFilePath = folderName + '/' + fileNames[0];
+    if (!stbi_info(firstFilePath.c_str(), &width, &height, nullptr))
     {
-        std::string const filePath = folderName + '/' + fileNames[i];
-        cubeData[i] = stbi_loadf(filePath.c_str(), &width, &height, nullptr, STBI_rgb_alpha);
-
-        if(!cubeData[i])
-        {
-            ThrowError("Failed to load texture: %s.", filePath.c_str());
-        }
+        ThrowError("Failed to load texture: %s.", firstFilePath.c_str());
     }
 
     textureInfo.m_imageCreateInfo.m_width = static_cast<float>(width);
     textureInfo.m_imageCreateInfo.m_height = static_cast<float>(height);
     textureInfo.m_imageCreateInfo.m_sizeType = SizeType::Absolute;
-    textureInfo.m_channels = STBI_rgb_alpha;
-    textureInfo.m_bytesPerChannel = sizeof(**cubeData);
     textureInfo.m_imageCreateInfo.m_layers = 6;
     textureInfo.m_imageCreateInfo.m_mipLevels = UINT8_MAX;
-    textureInfo.m_imageCreateInfo.m_format = GetImageFormat(textureInfo.m_channels, textureInfo.m_bytesPerChannel, true);
 
     VkExtent2D const extent = ImageResource::GetExtent(textureInfo.m_imageCreateInfo);
-    uint64_t const sizePerFace = extent.width * extent.height * textureInfo.m_channels;
-    textureInfo.m_data = new float[sizePerFace * 6];
+    uint64_t const faceSize = static_cast<uint64_t>(extent.width) * extent.height * textureInfo.m_channels * textureInfo.m_bytesPerChannel;
+
+    StagingAllocator& stagingAllocator = Renderer::GetInstance().GetStagingAllocator();
+    textureInfo.m_stagingData = stagingAllocator.Allocate(faceSize * 6);
 
-    uint64_t memoryOffset = 0;
-    for(uint8_t i = 0; i < 6; i++)
+    // Keys the IBL products filtered from this cube in the disk cache, hashed from the decoded faces rather than staging memory
+    uint64_t sourceHash = GetIBLSourceHashSeed(extent);
+    SharedPtr<TextureResource> texture;
+
+    // Only one decoded face is alive at a time, and a failed face must not pin the staging block
+    try
     {
-        float* destination = static_cast<float*>(const_cast<void*>(textureInfo.m_data)) + memoryOffset; 
-        memcpy(destination, cubeData[i], sizePerFace * textureInfo.m_bytesPerChannel);
-        memoryOffset += sizePerFace;
+        for (uint8_t i = 0; i < 6; i++)
+        {
+            std::string const filePath = folderName + '/' + fileNames[i];
+            int32_t faceWidth = 0;
+            int32_t faceHeight = 0;
+            float* const face = stbi_loadf(filePath.c_str(), &faceWidth, &faceHeight, nullptr, STBI_rgb_alpha);
+
+            bool const isValid = face && faceWidth == width && faceHeight == height;
+            if (isValid)
+            {
+                memcpy(static_cast<uint8_t*>(textureInfo.m_stagingData.m_data) + i * faceSize, face, faceSize);
+                sourceHash = HashIBLSourceFace(extent, face, sourceHash);
+            }
+
+            stbi_image_free(face);
+            if (!isValid)
+            {
+                ThrowError("Failed to load texture: %s.", filePath.c_str());
+            }
+        }
 
-        stbi_image_free(cubeData[i]);
+        texture = std::make_shared<TextureResource>(textureInfo);
+    }
+    catch (...)
+    {
+        stagingAllocator.Free(textureInfo.m_stagingData);
+        throw;
     }
 
-    SharedPtr<TextureResource> texture = std::make_shared<TextureResource>(textureInfo);
+    stagingAllocator.Free(textureInfo.m_stagingData);
+
+    texture->SetContentHash(sourceHash);
+    resourceManager.AddTexture(textureName, texture);
+
+    return texture;
+}
+
+SharedPtr<TextureResource> Loader::LoadTextureKtx2(std::string const& filePath)
+{
+    ResourceManager& resourceManager = ResourceManager::GetInstance();
+
+    std::string const fileData = ReadFile(filePath);
+    Ktx2Header header;
+    if (!ParseKtx2(fileData.data(), fileData.size(), header))
+    {
+        ThrowError("Failed to load texture: %s.", filePath.c_str());
+    }
 
-    delete textureInfo.m_data;
+    TextureSampler const textureSampler = {};
+    std::string const textureName = ResourceManager::GetTextureName(std::filesystem::weakly_canonical(filePath).string(), GetUnormFormat(header.m_format), textureSampler);
+    if (SharedPtr<TextureResource> const texture = resourceManager.GetTexture(textureName))
+    {
+        return texture;
+    }
+
+    Log("Load texture KTX2: %s", filePath.c_str());
+
+    SharedPtr<TextureResource> texture = CreateTextureKtx2(fileData.data(), fileData.size(), header, textureSampler);
+    if (!texture)
+    {
+        ThrowError("Failed to load texture: %s.", filePath.c_str());
+    }
 
+    resourceManager.AddTexture(textureName, texture);
     return texture;
 }
 
@@ -532,3 +792,496 @@ static VkFormat GetImageFormat(uint8_t channels, uint8_t bytesPerChannel, bool i
 
     return VK_FORMAT_UNDEFINED;
 }
+
+// The shaders decode sRGB themselves, so sampling has to return the stored values
+static VkFormat GetUnormFormat(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_R8G8B8A8_SRGB: return VK_FORMAT_R8G8B8A8_UNORM;
+    case VK_FORMAT_B8G8R8A8_SRGB: return VK_FORMAT_B8G8R8A8_UNORM;
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK: return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    case VK_FORMAT_BC2_SRGB_BLOCK: return VK_FORMAT_BC2_UNORM_BLOCK;
+    case VK_FORMAT_BC3_SRGB_BLOCK: return VK_FORMAT_BC3_UNORM_BLOCK;
+    case VK_FORMAT_BC7_SRGB_BLOCK: return VK_FORMAT_BC7_UNORM_BLOCK;
+    default: break;
+    }
+
+    // Every ASTC block size has its sRGB variant right after the UNORM one
+    if (format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK
+        && (format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) % 2 == 1)
+    {
+        return static_cast<VkFormat>(format - 1);
+    }
+
+    return format;
+}
+
+static SharedPtr<TextureResource> CreateTextureKtx2(void const* data, size_t size, Ktx2Header const& header, TextureSampler const& textureSampler, bool isStreamed)
+{
+    VkFormat const format = GetUnormFormat(header.m_format);
+    if (!Renderer::GetInstance().IsFormatSupported(format, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
+    {
+        Warn("KTX2 format %d is not supported by the device.", format);
+        return nullptr;
+    }
+
+    std::vector<uint64_t> mipOffsets;
+    mipOffsets.reserve(header.m_levels.size());
+    for (Ktx2Level const& level : header.m_levels)
+    {
+        mipOffsets.push_back(level.m_offset);
+    }
+
+    // The whole file is staged, the headers in front of the levels are small
+    TextureCreationInfo textureInfo;
+    textureInfo.m_imageCreateInfo.m_width = static_cast<float>(header.m_width);
+    textureInfo.m_imageCreateInfo.m_height = static_cast<float>(header.m_height);
+    textureInfo.m_imageCreateInfo.m_sizeType = SizeType::Absolute;
+    textureInfo.m_imageCreateInfo.m_layers = header.m_layers;
+    textureInfo.m_imageCreateInfo.m_mipLevels = header.m_levels.size();
+    textureInfo.m_imageCreateInfo.m_format = format;
+    textureInfo.m_samplerInfo = textureSampler;
+    textureInfo.m_data = data;
+    textureInfo.m_dataSize = size;
+    textureInfo.m_mipOffsets = mipOffsets.data();
+
+    if (!isStreamed || header.m_layers != 1 || header.m_levels.size() <= 1)
+    {
+        return std::make_shared<TextureResource>(textureInfo);
+    }
+
+    // The levels are copied out of the file, which is not kept
+    StreamedTextureData streamedData;
+    for (Ktx2Level const& level : header.m_levels)
+    {
+        uint8_t const* levelData = static_cast<uint8_t const*>(data) + level.m_offset;
+        streamedData.m_mipOffsets.push_back(streamedData.m_data.size());
+        streamedData.m_mipSizes.push_back(level.m_size);
+        streamedData.m_data.insert(streamedData.m_data.end(), levelData, levelData + level.m_size);
+        streamedData.m_data.resize((streamedData.m_data.size() + 15) & ~size_t(15));
+    }
+
+    textureInfo.m_data = nullptr;
+    textureInfo.m_dataSize = 0;
+    textureInfo.m_mipOffsets = nullptr;
+    return TextureStreamer::GetInstance().CreateTexture(textureInfo, std::move(streamedData));
+}
+
+static StreamedTextureData GenerateStreamedMips(uint8_t const* texels, uint32_t width, uint32_t height, uint32_t channels)
+{
+    // 2x2 box filter on the stored values, each mip is aligned for the staging copies
+    StreamedTextureData streamedData;
+    uint32_t const mipLevels = static_cast<uint32_t>(floor(log2(std::max(width, height)))) + 1;
+
+    streamedData.m_data.assign(texels, texels + uint64_t(width) * height * channels);
+    streamedData.m_mipOffsets.push_back(0);
+    streamedData.m_mipSizes.push_back(streamedData.m_data.size());
+
+    for (uint32_t mip = 1; mip < mipLevels; mip++)
+    {
+        uint32_t const sourceWidth = std::max(width >> (mip - 1), 1u);
+        uint32_t const sourceHeight = std::max(height >> (mip - 1), 1u);
+        uint32_t const mipWidth = std::max(width >> mip, 1u);
+        uint32_t const mipHeight = std::max(height >> mip, 1u);
+
+        uint64_t const sourceOffset = streamedData.m_mipOffsets.back();
+        uint64_t const mipOffset = (streamedData.m_data.size() + 15) & ~uint64_t(15);
+        uint64_t const mipSize = uint64_t(mipWidth) * mipHeight * channels;
+        streamedData.m_data.resize(mipOffset + mipSize);
+        streamedData.m_mipOffsets.push_back(mipOffset);
+        streamedData.m_mipSizes.push_back(mipSize);
+
+        uint8_t const* source = streamedData.m_data.data() + sourceOffset;
+        uint8_t* destination = streamedData.m_data.data() + mipOffset;
+        for (uint32_t y = 0; y < mipHeight; y++)
+        {
+            uint32_t const y0 = std::min(2 * y, sourceHeight - 1);
+            uint32_t const y1 = std::min(2 * y + 1, sourceHeight - 1);
+            for (uint32_t x = 0; x < mipWidth; x++)
+            {
+                uint32_t const x0 = std::min(2 * x, sourceWidth - 1);
+                uint32_t const x1 = std::min(2 * x + 1, sourceWidth - 1);
+                for (uint32_t c = 0; c < channels; c++)
+                {
+                    uint32_t const sum = source[(y0 * sourceWidth + x0) * channels + c] + source[(y0 * sourceWidth + x1) * channels + c]
+                        + source[(y1 * sourceWidth + x0) * channels + c] + source[(y1 * sourceWidth + x1) * channels + c];
+                    destination[(y * mipWidth + x) * channels + c] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+
+    return streamedData;
+}
+
+static int32_t GetGltfKtx2Source(tinygltf::Texture const& gltfTexture)
+{
+    auto const foundIt = gltfTexture.extensions.find("KHR_texture_basisu");
+    if (foundIt == gltfTexture.extensions.end() || !foundIt->second.Has("source"))
+    {
+        return -1;
+    }
+
+    return foundIt->second.Get("source").GetNumberAsInt();
+}
+
+static bool LoadGltfImageData(tinygltf::Image* image, int, std::string*, std::string*, int, int, unsigned char const* bytes, int size, void*)
+{
+    // Images are kept as stored, KTX2 is parsed when the texture is created and the others are decoded by DecodeGltfImages
+    image->image.assign(bytes, bytes + size);
+    image->width = 0;
+    image->height = 0;
+    image->component = 0;
+    image->bits = 0;
+    return true;
+}
+
+static void DecodeGltfImages(tinygltf::Model& gltfModel, std::vector<GltfImageData>& images)
+{
+    Renderer& renderer = Renderer::GetInstance();
+    StagingAllocator& stagingAllocator = renderer.GetStagingAllocator();
+    bool const useTextureStreaming = renderer.GetRenderSettings().m_useTextureStreaming;
+
+    // stb is reentrant, the images are decoded concurrently. One that fails is left empty and reported once they are all done,
+    // the failure reason of stb is global so it is not used here.
+    images.resize(gltfModel.images.size());
+    std::vector<std::string> errors(gltfModel.images.size());
+    auto const decodeImage = [&](uint32_t imageIndex)
+    {
+        tinygltf::Image& image = gltfModel.images[imageIndex];
+        GltfImageData& imageData = images[imageIndex];
+        imageData.m_contentHash = HashBytes(image.image.data(), image.image.size());
+        if (image.image.empty() || IsKtx2(image.image.data(), image.image.size()))
+        {
+            return;
+        }
+
+        std::vector<unsigned char> const encodedImage = std::move(image.image);
+        image.image.clear();
+
+        unsigned char const* bytes = encodedImage.data();
+        int32_t const size = static_cast<int32_t>(encodedImage.size());
+        bool const is16Bit = stbi_is_16_bit_from_memory(bytes, size);
+
+        // The mips of streamed textures are built on the CPU, their texels stay in the tinygltf image
+        if (useTextureStreaming && !is16Bit)
+        {
+            std::string warning;
+            if (!tinygltf::LoadImageData(&image, imageIndex, &errors[imageIndex], &warning, 0, 0, bytes, size, nullptr))
+            {
+                image.image.clear();
+                if (errors[imageIndex].empty())
+                {
+                    errors[imageIndex] = "Unknown image format.";
+                }
+            }
+            return;
+        }
+
+        // The others are copied once from the decoder to staging memory sized from the header, with the four channels tinygltf would give
+        int32_t width = 0;
+        int32_t height = 0;
+        int32_t components = 0;
+        if (!stbi_info_from_memory(bytes, size, &width, &height, &components))
+        {
+            errors[imageIndex] = "Unknown or corrupt image header.";
+            return;
+        }
+
+        uint64_t const imageSize = static_cast<uint64_t>(width) * height * STBI_rgb_alpha * (is16Bit ? sizeof(stbi_us) : sizeof(stbi_uc));
+        imageData.m_stagingData = stagingAllocator.Allocate(imageSize);
+
+        void* texels = is16Bit ?
+            static_cast<void*>(stbi_load_16_from_memory(bytes, size, &width, &height, &components, STBI_rgb_alpha)) :
+            static_cast<void*>(stbi_load_from_memory(bytes, size, &width, &height, &components, STBI_rgb_alpha));
+        if (!texels)
+        {
+            errors[imageIndex] = "Corrupt image data.";
+            stagingAllocator.Free(imageData.m_stagingData);
+            return;
+        }
+
+        memcpy(imageData.m_stagingData.m_data, texels, imageSize);
+        stbi_image_free(texels);
+
+        image.width = width;
+        image.height = height;
+        image.component = STBI_rgb_alpha;
+        image.bits = is16Bit ? 16 : 8;
+        image.pixel_type = is16Bit ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT : TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+    };
+
+    // A staging allocation that throws is rethrown here by ParallelFor, after the other images have stopped
+    try
+    {
+        ParallelFor(std::thread::hardware_concurrency(), gltfModel.images.size(), decodeImage);
+    }
+    catch (...)
+    {
+        for (GltfImageData& imageData : images)
+        {
+            stagingAllocator.Free(imageData.m_stagingData);
+        }
+        throw;
+    }
+
+    for (uint32_t imageIndex = 0; imageIndex < errors.size(); imageIndex++)
+    {
+        if (!errors[imageIndex].empty())
+        {
+            Warn("Failed to decode image %u: %s", imageIndex, errors[imageIndex].c_str());
+        }
+    }
+}
+
+static void OptimizePrimitive(std::vector<SourceVertex>& vertices, std::vector<uint32_t>& indices, Primitive& primitive, uint64_t vertexStart, VertexCacheStatistics& sourceStatistics)
+{
+    // Weld the identical vertices of non indexed primitives to generate their indices
+    if (!primitive.m_hasIndices)
+    {
+        std::map<std::array<float, sizeof(SourceVertex) / sizeof(float)>, uint32_t> uniqueVertices;
+        uint64_t const vertexEnd = vertices.size();
+
+        primitive.m_firstIndex = indices.size();
+        primitive.m_indexCount = vertexEnd - vertexStart;
+
+        for (uint64_t v = vertexStart; v < vertexEnd; v++)
+        {
+            std::array<float, sizeof(SourceVertex) / sizeof(float)> key;
+            memcpy(key.data(), &vertices[v], sizeof(SourceVertex));
+
+            auto const& [vertexIt, isNewVertex] = uniqueVertices.try_emplace(key, uniqueVertices.size());
+            if (isNewVertex)
+            {
+                vertices[vertexStart + vertexIt->second] = vertices[v];
+            }
+
+            indices.push_back(vertexStart + vertexIt->second);
+        }
+
+        vertices.resize(vertexStart + uniqueVertices.size());
+        primitive.m_vertexCount = uniqueVertices.size();
+        primitive.m_hasIndices = true;
+    }
+
+    if (primitive.m_indexCount < 3)
+    {
+        return;
+    }
+
+    // Optimize in the local vertex range of the primitive
+    uint32_t const vertexCount = primitive.m_vertexCount;
+    auto const indexBegin = indices.begin() + primitive.m_firstIndex;
+    auto const indexEnd = indexBegin + primitive.m_indexCount;
+
+    std::vector<uint32_t> localIndices;
+    localIndices.reserve(primitive.m_indexCount);
+    for (auto it = indexBegin; it != indexEnd; it++)
+    {
+        localIndices.push_back(*it - vertexStart);
+    }
+
+    std::vector<glm::vec3> positions(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++)
+    {
+        positions[v] = vertices[vertexStart + v].m_position;
+    }
+
+    VertexCacheStatistics const statistics = AnalyzeVertexCache(localIndices, vertexCount);
+    sourceStatistics.m_transformedVertices += statistics.m_transformedVertices;
+    sourceStatistics.m_triangles += statistics.m_triangles;
+    sourceStatistics.m_vertices += statistics.m_vertices;
+
+    // The meshlets are what is drawn, the cache order is optimized within each of them and the overdraw order across them
+    std::vector<Meshlet> const meshlets = BuildMeshlets(localIndices, positions);
+
+    std::vector<uint32_t> clusters;
+    clusters.reserve(meshlets.size());
+    for (Meshlet const& meshlet : meshlets)
+    {
+        OptimizeVertexCacheRange(localIndices, meshlet.m_firstIndex, meshlet.m_indexCount);
+        clusters.push_back(meshlet.m_firstIndex / 3);
+    }
+
+    std::vector<uint32_t> const meshletOrder = OptimizeOverdraw(localIndices, positions, clusters);
+    std::vector<uint32_t> const remap = OptimizeVertexFetch(localIndices, vertexCount);
+
+    primitive.m_meshlets.clear();
+    primitive.m_meshlets.reserve(meshlets.size());
+    uint32_t firstIndex = primitive.m_firstIndex;
+    for (uint32_t const m : meshletOrder)
+    {
+        Meshlet& meshlet = primitive.m_meshlets.emplace_back(meshlets[m]);
+        meshlet.m_firstIndex = firstIndex;
+        firstIndex += meshlet.m_indexCount;
+    }
+
+    // Vertices are moved to the order they are first fetched in
+    std::vector<SourceVertex> const sourceVertices(vertices.begin() + vertexStart, vertices.begin() + vertexStart + vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++)
+    {
+        vertices[vertexStart + remap[v]] = sourceVertices[v];
+    }
+
+    std::transform(localIndices.begin(), localIndices.end(), indexBegin, [vertexStart](uint32_t index) { return static_cast<uint32_t>(index + vertexStart); });
+}
+
+static void ComputeUvDensity(std::vector<SourceVertex> const& vertices, std::vector<uint32_t> const& indices, Primitive& primitive)
+{
+    // Ratio of the object space area to the uv area of the triangles, as a length
+    double objectArea = 0.0;
+    std::array<double, 2> uvAreas = { 0.0, 0.0 };
+    for (uint32_t i = primitive.m_firstIndex; i + 2 < primitive.m_firstIndex + primitive.m_indexCount; i += 3)
+    {
+        SourceVertex const& v0 = vertices[indices[i]];
+        SourceVertex const& v1 = vertices[indices[i + 1]];
+        SourceVertex const& v2 = vertices[indices[i + 2]];
+
+        objectArea += 0.5 * glm::length(glm::cross(v1.m_position - v0.m_position, v2.m_position - v0.m_position));
+
+        glm::vec2 const uv0[] = { v1.m_uvSet0 - v0.m_uvSet0, v2.m_uvSet0 - v0.m_uvSet0 };
+        glm::vec2 const uv1[] = { v1.m_uvSet1 - v0.m_uvSet1, v2.m_uvSet1 - v0.m_uvSet1 };
+        uvAreas[0] += 0.5 * std::abs(uv0[0].x * uv0[1].y - uv0[0].y * uv0[1].x);
+        uvAreas[1] += 0.5 * std::abs(uv1[0].x * uv1[1].y - uv1[0].y * uv1[1].x);
+    }
+
+    for (size_t set = 0; set < uvAreas.size(); set++)
+    {
+        primitive.m_uvDensity[set] = uvAreas[set] > 0.0 ? static_cast<float>(std::sqrt(objectArea / uvAreas[set])) : 0.0f;
+    }
+}
+
+static VertexCacheStatistics AnalyzeMeshVertexCache(std::vector<uint32_t> const& indices, std::vector<Primitive> const& primitives)
+{
+    VertexCacheStatistics meshStatistics;
+    for (Primitive const& primitive : primitives)
+    {
+        if (!primitive.m_hasIndices || primitive.m_indexCount == 0)
+        {
+            continue;
+        }
+
+        auto const indexBegin = indices.begin() + primitive.m_firstIndex;
+        auto const indexEnd = indexBegin + primitive.m_indexCount;
+        uint32_t const firstVertex = *std::min_element(indexBegin, indexEnd);
+
+        std::vector<uint32_t> localIndices;
+        localIndices.reserve(primitive.m_indexCount);
+        for (auto it = indexBegin; it != indexEnd; it++)
+        {
+            localIndices.push_back(*it - firstVertex);
+        }
+
+        VertexCacheStatistics const statistics = AnalyzeVertexCache(localIndices, *std::max_element(localIndices.begin(), localIndices.end()) + 1);
+        meshStatistics.m_transformedVertices += statistics.m_transformedVertices;
+        meshStatistics.m_triangles += statistics.m_triangles;
+        meshStatistics.m_vertices += statistics.m_vertices;
+    }
+
+    return meshStatistics;
+}
+
+static std::vector<float> GenerateMeshLods(std::vector<SourceVertex> const& vertices, std::vector<uint32_t>& indices, std::vector<Primitive>& primitives)
+{
+    constexpr uint32_t maxLods = 5;
+    constexpr float maxRelativeError = 0.05f; // Relative to the mesh radius
+    constexpr float minReduction = 0.8f; // Stop when a level keeps more than this fraction of the previous one
+    constexpr uint32_t minTriangles = 16;
+
+    if (vertices.empty())
+    {
+        return { 0.0f };
+    }
+
+    glm::vec3 minimum = vertices.front().m_position;
+    glm::vec3 maximum = vertices.front().m_position;
+    for (SourceVertex const& vertex : vertices)
+    {
+        minimum = glm::min(minimum, vertex.m_position);
+        maximum = glm::max(maximum, vertex.m_position);
+    }
+
+    float const maxError = maxRelativeError * 0.5f * glm::distance(minimum, maximum);
+
+    // Error of each level of each primitive, primitives without a level fall back to their coarsest one
+    std::vector<std::vector<float>> primitiveErrors(primitives.size(), std::vector<float>(1, 0.0f));
+    uint32_t lodCount = 1;
+
+    for (size_t p = 0; p < primitives.size(); p++)
+    {
+        Primitive& primitive = primitives[p];
+        if (!primitive.m_hasIndices || primitive.m_indexCount / 3 < minTriangles)
+        {
+            continue;
+        }
+
+        // Simplify in the local vertex range of the primitive
+        auto const indexBegin = indices.begin() + primitive.m_firstIndex;
+        auto const indexEnd = indexBegin + primitive.m_indexCount;
+        uint32_t const firstVertex = *std::min_element(indexBegin, indexEnd);
+        uint32_t const lastVertex = *std::max_element(indexBegin, indexEnd);
+
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        positions.reserve(lastVertex - firstVertex + 1);
+        normals.reserve(lastVertex - firstVertex + 1);
+        for (uint32_t v = firstVertex; v <= lastVertex; v++)
+        {
+            positions.push_back(vertices[v].m_position);
+            normals.push_back(vertices[v].m_normal);
+        }
+
+        std::vector<uint32_t> baseIndices;
+        baseIndices.reserve(primitive.m_indexCount);
+        for (auto it = indexBegin; it != indexEnd; it++)
+        {
+            baseIndices.push_back(*it - firstVertex);
+        }
+
+        std::vector<uint32_t> lodIndices;
+        size_t previousIndexCount = baseIndices.size();
+
+        for (uint32_t lod = 1; lod < maxLods && previousIndexCount / 3 >= minTriangles; lod++)
+        {
+            size_t const targetIndexCount = previousIndexCount / 6 * 3;
+            float const error = SimplifyMesh(lodIndices, baseIndices, positions, normals, targetIndexCount, maxError);
+
+            if (lodIndices.empty() || lodIndices.size() > minReduction * previousIndexCount)
+            {
+                break;
+            }
+
+            // The simplified triangles are in no particular order
+            OptimizeVertexCache(lodIndices, positions.size());
+
+            PrimitiveLod primitiveLod = {};
+            primitiveLod.m_firstIndex = indices.size();
+            primitiveLod.m_indexCount = lodIndices.size();
+            primitive.m_lods.push_back(primitiveLod);
+
+            for (uint32_t const index : lodIndices)
+            {
+                indices.push_back(index + firstVertex);
+            }
+
+            primitiveErrors[p].push_back(std::max(error, primitiveErrors[p].back()));
+            previousIndexCount = lodIndices.size();
+        }
+
+        lodCount = std::max<uint32_t>(lodCount, primitiveErrors[p].size());
+    }
+
+    // The mesh switches level as a whole, its error is the worst of its primitives
+    std::vector<float> lodErrors(lodCount, 0.0f);
+    for (std::vector<float> const& errors : primitiveErrors)
+    {
+        for (uint32_t lod = 0; lod < lodCount; lod++)
+        {
+            lodErrors[lod] = std::max(lodErrors[lod], errors[std::min<size_t>(lod, errors.size() - 1)]);
+        }
+    }
+
+    return lodErrors;
+}
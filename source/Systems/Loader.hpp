@@ -6,6 +6,7 @@
 
 class SceneComponent;
 class TextureResource;
+struct GltfImageData;
 struct Material;
 struct TextureSampler;
 
@@ -19,14 +20,18 @@ public:
     void LoadModel(entt::entity entity, std::string const& filePath, std::function<void(entt::entity)> const& nodeLoadedCallback = nullptr);
     SharedPtr<TextureResource> LoadTexture2D(std::string const& filePath);
     SharedPtr<TextureResource> LoadTextureCubeHdr(std::string const& folderName);
+    // Block compressed 2D, array or cube texture with its mips prebuilt, uploaded without conversion
+    SharedPtr<TextureResource> LoadTextureKtx2(std::string const& filePath);
 
 private:
     void OnFileDescriptorComponentCreated(entt::registry& registry, entt::entity entity);
 
-    void LoadModelNode(SceneComponent& parentSceneComponent, tinygltf::Node const& gltfNode, tinygltf::Model const& gltfModel, std::vector<SharedPtr<Material>> const& materials, std::function<void(entt::entity)> const& nodeLoadedCallback = nullptr);
-    void LoadMesh(entt::entity nodeEntity, tinygltf::Node const& gltfNode, tinygltf::Model const& gltfModel, std::vector<SharedPtr<Material>> const& materials);
+    void LoadModelNode(SceneComponent& parentSceneComponent, tinygltf::Node const& gltfNode, tinygltf::Model const& gltfModel, std::vector<SharedPtr<Material>> const& materials, std::string const& filePath, std::function<void(entt::entity)> const& nodeLoadedCallback = nullptr);
+    void LoadMesh(entt::entity nodeEntity, tinygltf::Node const& gltfNode, tinygltf::Model const& gltfModel, std::vector<SharedPtr<Material>> const& materials, std::string const& filePath);
+    void LoadMeshInstances(entt::entity nodeEntity, tinygltf::Value const& gltfInstancing, tinygltf::Model const& gltfModel);
     void LoadTextureSamplers(tinygltf::Model const& gltfModel, std::vector<TextureSampler>& textureSamplers);
-    void LoadTextures(tinygltf::Model const& gltfModel, std::vector<SharedPtr<TextureResource>>& textures, std::vector<TextureSampler> const& textureSamplers);
+    void LoadTextures(tinygltf::Model const& gltfModel, std::vector<GltfImageData> const& images, std::vector<SharedPtr<TextureResource>>& textures, std::vector<TextureSampler> const& textureSamplers, std::string const& filePath);
+    SharedPtr<TextureResource> LoadGltfImage(tinygltf::Image const& gltfImage, GltfImageData const& imageData, TextureSampler const& textureSampler, std::string const& folder);
     void LoadMaterials(tinygltf::Model& gltfModel, std::vector<SharedPtr<Material>>& materials, std::vector<SharedPtr<TextureResource>> const& textures);
 
     friend class Singleton<Loader>;
@@ -7,6 +7,7 @@ void RenderGraph::Init()
 {
     CreateCommandPool();
     CreateCommandBuffers();
+    m_gpuProfiler.Init();
     Renderer::GetInstance().AddSwapchainObserver(this);
 }
 
@@ -16,6 +17,7 @@ void RenderGraph::Terminate()
     TerminateRenderPasses();
     DestroyAttachments();
     DestroyTextures();
+    m_gpuProfiler.Terminate();
     DestroyCommandPool();
 }
 
@@ -41,6 +43,7 @@ void RenderGraph::EndCommandBuffer(VkCommandBuffer commandBuffer)
 void RenderGraph::Execute(VkCommandBuffer commandBuffer)
 {
     BeginCommandBuffer(commandBuffer);
+    m_gpuProfiler.BeginFrame(commandBuffer);
 
     UpdateAttachments();
     UpdateTextures();
@@ -58,7 +61,9 @@ void RenderGraph::ExecuteInternal(VkCommandBuffer commandBuffer)
 
     for (UniquePtr<RenderPass>& pass : m_renderPasses)
     {
+        m_gpuProfiler.BeginScope(commandBuffer, pass->GetName());
         pass->Execute(commandBuffer, context);
+        m_gpuProfiler.EndScope(commandBuffer);
     }
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <Systems/GpuProfiler.hpp>
 #include <Systems/RenderPasses/RenderPass.hpp>
 #include <Resources/AttachmentResource.hpp>
 #include <Resources/TextureResource.hpp>
@@ -44,6 +45,8 @@ public:
     VkCommandBuffer& GetCommandBuffer(uint32_t const frameIndex) { return m_commandBuffers[frameIndex]; }
     AttachmentResource& GetAttachmentResource(std::string const& name) { return *m_attachments[name]; }
     TextureResource& GetTextureFromAttachmentResource(std::string const& name) { return *m_texturesFromAttachments[name]; }
+    GpuProfiler const& GetGpuProfiler() const { return m_gpuProfiler; }
+    bool IsInitialized() const { return m_commandPool != VK_NULL_HANDLE; }
 
 protected:
     virtual void ExecuteInternal(VkCommandBuffer commandBuffer);
@@ -77,6 +80,8 @@ private:
     std::vector<VkCommandBuffer> m_commandBuffers;
 
     std::vector<RenderPassPendingRemoval> m_renderPassesToRemove;
+
+    GpuProfiler m_gpuProfiler;
 };
 
 template<typename PASS, typename... ARGS>
@@ -13,11 +13,15 @@
 void BrdflutPass::DeclareAttachmentsUsage()
 {
     AttachmentCreationInfo brdflutAttachmentInfo;
-    brdflutAttachmentInfo.m_imageCreateInfo.m_format = VK_FORMAT_R16G16_SFLOAT;
-    brdflutAttachmentInfo.m_imageCreateInfo.m_width = m_resolution;
-    brdflutAttachmentInfo.m_imageCreateInfo.m_height = m_resolution;
+    brdflutAttachmentInfo.m_imageCreateInfo.m_format = m_settings.m_format;
+    brdflutAttachmentInfo.m_imageCreateInfo.m_width = m_settings.m_resolution;
+    brdflutAttachmentInfo.m_imageCreateInfo.m_height = m_settings.m_resolution;
     brdflutAttachmentInfo.m_imageCreateInfo.m_sizeType = SizeType::Absolute;
     AddColorOutputAttachment("brdflut", brdflutAttachmentInfo);
+
+    // Read back to and uploaded from the IBL cache
+    AddImageCopySource("brdflut");
+    m_renderGraph->GetAttachmentResource("brdflut").GetImage().AddImageUsageFlags(VK_IMAGE_USAGE_TRANSFER_DST_BIT);
 }
 
 void BrdflutPass::Init()
@@ -43,6 +47,18 @@ void BrdflutPass::Init()
     fragmentShaderStageInfo.module = fragmentShaderModule;
     fragmentShaderStageInfo.pName = "main";
 
+    VkSpecializationMapEntry specializationEntry = {};
+    specializationEntry.constantID = 0;
+    specializationEntry.offset = 0;
+    specializationEntry.size = sizeof(uint32_t);
+
+    VkSpecializationInfo specializationInfo = {};
+    specializationInfo.mapEntryCount = 1;
+    specializationInfo.pMapEntries = &specializationEntry;
+    specializationInfo.dataSize = sizeof(uint32_t);
+    specializationInfo.pData = &m_settings.m_sampleCount;
+    fragmentShaderStageInfo.pSpecializationInfo = &specializationInfo;
+
     std::array<VkPipelineShaderStageCreateInfo, 2> const shaderStages = { vertexShaderStageInfo, fragmentShaderStageInfo };
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
@@ -151,6 +167,18 @@ void BrdflutPass::Init()
 
 void BrdflutPass::ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionContext const& context)
 {
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    IBLComponent& ibl = entitySystem.GetOrAddComponent<IBLComponent>(entitySystem.GetGlobalEntity());
+    ibl.SetBrdflut(m_renderGraph->GetTextureFromAttachmentResource("brdflut"));
+
+    ImageResource& brdflutImage = m_renderGraph->GetAttachmentResource("brdflut").GetImage();
+    uint64_t const cacheKey = m_settings.GetCacheKey();
+    if (m_cache.RecordLoad(cacheKey, brdflutImage, commandBuffer))
+    {
+        m_renderGraph->RemovePass(GetName());
+        return;
+    }
+
     vkCmdBeginRendering(commandBuffer, &context.m_renderingInfo);
 
     VkViewport viewport = {};
@@ -168,11 +196,9 @@ void BrdflutPass::ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionCo
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
     vkCmdDraw(commandBuffer, 3, 1, 0, 0);
 
-    EntitySystem& entitySystem = EntitySystem::GetInstance();
-    IBLComponent& ibl = entitySystem.GetOrAddComponent<IBLComponent>(entitySystem.GetGlobalEntity());
-    ibl.SetBrdflut(m_renderGraph->GetTextureFromAttachmentResource("brdflut"));
-
     vkCmdEndRendering(commandBuffer);
+
+    m_cache.RecordStore(cacheKey, brdflutImage, commandBuffer);
     
     m_renderGraph->RemovePass(GetName());
 }
@@ -181,6 +207,9 @@ void BrdflutPass::Terminate()
 {
     Renderer& renderer = Renderer::GetInstance();
 
+    // A removed pass is terminated once the frame that executed it has completed
+    m_cache.OnTransferCompleted();
+
     if (m_pipelineLayout != VK_NULL_HANDLE)
     {
         vkDestroyPipelineLayout(renderer.GetDevice(), m_pipelineLayout, nullptr);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <Resources/IBLCache.hpp>
 #include <Systems/RenderPasses/RenderPass.hpp>
 
 class RenderGraph;
@@ -20,5 +21,7 @@ private:
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
     VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
 
-    uint16_t m_resolution = 512;
+    BrdflutSettings m_settings;
+
+    IBLCache m_cache{ "brdflut" };
 };
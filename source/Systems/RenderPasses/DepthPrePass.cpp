@@ -0,0 +1,258 @@
+#include <Systems/RenderPasses/DepthPrePass.hpp>
+
+#include <Components/CameraComponent.hpp>
+#include <Components/SceneComponent.hpp>
+#include <Components/StaticMeshComponent.hpp>
+#include <Resources/AttachmentResource.hpp>
+#include <Resources/ResourceInFlight.hpp>
+#include <Systems/EntitySystem.hpp>
+#include <Systems/Renderer.hpp>
+#include <Systems/ResourceManager.hpp>
+#include <Utilities/Helpers.hpp>
+
+void DepthPrePass::DeclareAttachmentsUsage()
+{
+    Renderer& renderer = Renderer::GetInstance();
+
+    AttachmentCreationInfo depthAttachmentInfo;
+    depthAttachmentInfo.m_imageCreateInfo.m_format = renderer.ChooseDepthFormat(false);
+    depthAttachmentInfo.m_imageCreateInfo.m_sampleCount = renderer.GetRasterizationSampleCount();
+    SetDepthStencilOutputAttachment("depth", depthAttachmentInfo);
+}
+
+void DepthPrePass::Init()
+{
+    RenderPass::Init();
+
+    Renderer& renderer = Renderer::GetInstance();
+    ResourceManager& resourceManager = ResourceManager::GetInstance();
+
+    // Create pipeline, depth only so there is no fragment stage
+    VkShaderModule vertexShaderModule = resourceManager.GetShaderModule("Depth.vert");
+
+    VkPipelineShaderStageCreateInfo vertexShaderStageInfo = {};
+    vertexShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertexShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    vertexShaderStageInfo.module = vertexShaderModule;
+    vertexShaderStageInfo.pName = "main";
+
+    // Only the position stream is fetched
+    std::array<VkVertexInputBindingDescription, 2> const bindingDescriptions = { Vertex::GetBindingDescriptions()[0], MeshInstance::GetBindingDescription() };
+    std::array<VkVertexInputAttributeDescription, 2> const attributeDescriptions = { Vertex::GetAttributeDescriptions()[0], MeshInstance::GetAttributeDescription() };
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = bindingDescriptions.size();
+    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = attributeDescriptions.size();
+    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    VkPipelineViewportStateCreateInfo viewportState = {};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.pViewports = nullptr;
+    viewportState.scissorCount = 1;
+    viewportState.pScissors = nullptr;
+
+    std::vector<VkDynamicState> dynamicEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = dynamicEnables.size();
+    dynamicState.pDynamicStates = dynamicEnables.data();
+
+    VkPipelineRasterizationStateCreateInfo rasterizer = {};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling = {};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.rasterizationSamples = renderer.GetRasterizationSampleCount();
+    multisampling.sampleShadingEnable = VK_FALSE;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending = {};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.attachmentCount = 0;
+    colorBlending.pAttachments = nullptr;
+
+    // Pipeline Layout
+    std::vector<VkDescriptorSetLayout> const setLayouts = {
+        resourceManager.GetDescriptorLayout(CameraComponentResource::ms_bindings),
+        resourceManager.GetDescriptorLayout(SceneComponentGlobalResource::ms_bindings)
+    };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = setLayouts.size();
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.size = sizeof(MeshPushConstantBlock);
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(renderer.GetDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+    {
+        ThrowError("Failed to create pipeline layout.");
+    }
+
+    // Pipeline
+    VkGraphicsPipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 1;
+    pipelineInfo.pStages = &vertexShaderStageInfo;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.layout = m_pipelineLayout;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    VkFormat const depthFormat = GetDepthStencilAttachment()->GetImageCreationInfo().m_format;
+    VkFormat const stencilFormat = renderer.FormatHasStencil(depthFormat) ? depthFormat : VK_FORMAT_UNDEFINED;
+
+    VkPipelineRenderingCreateInfo pipelineRenderingInfo = {};
+    pipelineRenderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    pipelineRenderingInfo.colorAttachmentCount = 0;
+    pipelineRenderingInfo.pColorAttachmentFormats = nullptr;
+    pipelineRenderingInfo.depthAttachmentFormat = depthFormat;
+    pipelineRenderingInfo.stencilAttachmentFormat = stencilFormat;
+    PNextChainPushBack(&pipelineInfo, &pipelineRenderingInfo);
+
+    if (vkCreateGraphicsPipelines(renderer.GetDevice(), renderer.GetPipelineCache(), 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS)
+    {
+        ThrowError("Failed to create graphics pipeline.");
+    }
+}
+
+void DepthPrePass::ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionContext const& context)
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    
+    auto const& cameraView = entitySystem.GetView<CameraComponentResource const>();
+    Entity cameraEntity = cameraView.front();
+    if (!EntitySystem::IsEntityValid(cameraEntity))
+    {
+        return;
+    }
+
+    vkCmdBeginRendering(commandBuffer, &context.m_renderingInfo);
+    
+    VkViewport viewport = {};
+    viewport.x = static_cast<float>(context.m_renderingInfo.renderArea.offset.x);
+    viewport.y = static_cast<float>(context.m_renderingInfo.renderArea.offset.y);
+    viewport.width = static_cast<float>(context.m_renderingInfo.renderArea.extent.width);
+    viewport.height = static_cast<float>(context.m_renderingInfo.renderArea.extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor = context.m_renderingInfo.renderArea;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
+
+    CameraComponentResource const& cameraResource = cameraView.Get<CameraComponentResource const>(cameraEntity);
+    SceneComponentGlobalResource const& sceneGlobalResource = entitySystem.GetComponent<SceneComponentGlobalResource const>(entitySystem.GetGlobalEntity());
+    StaticMeshComponentGlobalResource const& meshGlobalResource = entitySystem.GetComponent<StaticMeshComponentGlobalResource const>(entitySystem.GetGlobalEntity());
+
+    std::vector<VkDescriptorSet> const descriptorSets = {
+        cameraResource.GetDescriptorSetInFlight().GetDescriptorSet(),
+        sceneGlobalResource.GetDescriptorSetInFlight().GetDescriptorSet()
+    };
+    uint32_t const cameraOffset = cameraResource.GetUniformOffset();
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, descriptorSets.size(), descriptorSets.data(), 1, &cameraOffset);
+
+    VkBuffer const instanceBuffer = meshGlobalResource.m_instanceBuffer.GetResource().GetBuffer();
+    VkDeviceSize const instanceBufferOffset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, 1, 1, &instanceBuffer, &instanceBufferOffset);
+
+    for (StaticMeshComponentGlobalResource::InstanceBatch const& batch : meshGlobalResource.m_batches)
+    {
+        StaticMeshComponent const* staticMesh = entitySystem.TryGetComponent<StaticMeshComponent const>(batch.m_entity);
+        if (!staticMesh || batch.m_instanceCount == 0)
+        {
+            continue;
+        }
+
+        VkBuffer const vertexBuffers[] = { staticMesh->GetPositionBuffer() };
+        VkDeviceSize const offsets[] = { 0 };
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+
+        VkBuffer const indexBuffer = staticMesh->GetIndexBuffer();
+        if (indexBuffer != VK_NULL_HANDLE)
+        {
+            vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, staticMesh->GetIndexType());
+        }
+
+        MeshPushConstantBlock const pushBlock = staticMesh->GetMeshAsset()->GetMeshPushConstantBlock();
+        vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstantBlock), &pushBlock);
+
+        std::vector<Primitive> const& primitives = staticMesh->GetPrimitives();
+        for (uint32_t d = batch.m_firstDraw; d < batch.m_firstDraw + batch.m_drawCount; d++)
+        {
+            StaticMeshComponentGlobalResource::PrimitiveDraw const& draw = meshGlobalResource.m_draws[d];
+            Primitive const& primitive = primitives[draw.m_primitive];
+
+            // Alpha tested primitives need the fragment shader, the shading pass depth tests them itself
+            if (primitive.m_material->m_alphaMode == Material::AlphaMode::Mask)
+            {
+                continue;
+            }
+
+            if (primitive.m_hasIndices)
+            {
+                vkCmdDrawIndexed(commandBuffer, draw.m_indexCount, batch.m_instanceCount, draw.m_firstIndex, 0, batch.m_firstInstance);
+            }
+            else
+            {
+                vkCmdDraw(commandBuffer, primitive.m_vertexCount, batch.m_instanceCount, 0, batch.m_firstInstance);
+            }
+        }
+    }
+
+    vkCmdEndRendering(commandBuffer);
+}
+
+void DepthPrePass::Terminate()
+{
+    Renderer& renderer = Renderer::GetInstance();
+
+    if (m_pipelineLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(renderer.GetDevice(), m_pipelineLayout, nullptr);
+        m_pipelineLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_graphicsPipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(renderer.GetDevice(), m_graphicsPipeline, nullptr);
+        m_graphicsPipeline = VK_NULL_HANDLE;
+    }
+
+    RenderPass::Terminate();
+}
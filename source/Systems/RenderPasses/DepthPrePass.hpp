@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Systems/RenderPasses/RenderPass.hpp>
+
+class RenderGraph;
+
+// Lays down the depth of opaque geometry so the shading pass only runs Pbr.frag once per pixel
+class DepthPrePass : public RenderPass
+{
+public:
+    DepthPrePass(std::string const& name, RenderGraph* renderGraph) : RenderPass(name, renderGraph) {}
+
+    virtual void DeclareAttachmentsUsage() override;
+    virtual void Init() override;
+    virtual void Terminate() override;
+
+protected:
+    virtual void ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionContext const& context) override;
+
+private:
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
+};
@@ -2,27 +2,29 @@
 
 #include <Components/IBLComponent.hpp>
 #include <Components/SkyboxComponent.hpp>
-#include <Components/StaticMeshComponent.hpp>
-#include <Resources/AttachmentResource.hpp>
-#include <Resources/Descriptor.hpp>
 #include <Resources/ImageResource.hpp>
-#include <Resources/ResourceInFlight.hpp>
 #include <Resources/TextureResource.hpp>
 #include <Systems/EntitySystem.hpp>
 #include <Systems/Renderer.hpp>
 #include <Systems/RenderGraph.hpp>
 #include <Systems/ResourceManager.hpp>
 
+const std::vector<VkDescriptorSetLayoutBinding> IrradiancePass::ms_bindings = {
+    { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr }, // Environment
+    { 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr } // Irradiance mip
+};
+
 IrradiancePass::IrradiancePass(std::string const& name, RenderGraph* renderGraph)
     : RenderPass(name, renderGraph)
 {
     TextureCreationInfo irradianceCubeInfo;
-    irradianceCubeInfo.m_imageCreateInfo.m_format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    irradianceCubeInfo.m_imageCreateInfo.m_width = m_resolution;
-    irradianceCubeInfo.m_imageCreateInfo.m_height = m_resolution;
+    irradianceCubeInfo.m_imageCreateInfo.m_format = m_settings.m_format;
+    irradianceCubeInfo.m_imageCreateInfo.m_width = m_settings.m_resolution;
+    irradianceCubeInfo.m_imageCreateInfo.m_height = m_settings.m_resolution;
     irradianceCubeInfo.m_imageCreateInfo.m_sizeType = SizeType::Absolute;
-    irradianceCubeInfo.m_imageCreateInfo.m_mipLevels = floor(log2(m_resolution)) + 1;
+    irradianceCubeInfo.m_imageCreateInfo.m_mipLevels = floor(log2(m_settings.m_resolution)) + 1;
     irradianceCubeInfo.m_imageCreateInfo.m_layers = 6;
+    irradianceCubeInfo.m_usage = VK_IMAGE_USAGE_STORAGE_BIT;
     irradianceCubeInfo.m_samplerInfo.m_addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
     irradianceCubeInfo.m_samplerInfo.m_addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
     irradianceCubeInfo.m_samplerInfo.m_addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
@@ -36,13 +38,7 @@ IrradiancePass::IrradiancePass(std::string const& name, RenderGraph* renderGraph
 
 void IrradiancePass::DeclareAttachmentsUsage()
 {
-    AttachmentCreationInfo irradianceAttachmentInfo;
-    irradianceAttachmentInfo.m_imageCreateInfo.m_format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    irradianceAttachmentInfo.m_imageCreateInfo.m_width = m_resolution;
-    irradianceAttachmentInfo.m_imageCreateInfo.m_height = m_resolution;
-    irradianceAttachmentInfo.m_imageCreateInfo.m_sizeType = SizeType::Absolute;
-    AddColorOutputAttachment("tempIrradiance", irradianceAttachmentInfo);
-    AddImageCopySource("tempIrradiance");
+    // The cube is written through storage images
 }
 
 void IrradiancePass::Init()
@@ -53,87 +49,17 @@ void IrradiancePass::Init()
     ResourceManager& resourceManager = ResourceManager::GetInstance();
 
     // Create pipeline
-    VkShaderModule vertexShaderModule = resourceManager.GetShaderModule("FilterCube.vert");
-    VkShaderModule fragmentShaderModule = resourceManager.GetShaderModule("IrradianceCube.frag");
-
-    VkPipelineShaderStageCreateInfo vertexShaderStageInfo = {};
-    vertexShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertexShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertexShaderStageInfo.module = vertexShaderModule;
-    vertexShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo fragmentShaderStageInfo = {};
-    fragmentShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragmentShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragmentShaderStageInfo.module = fragmentShaderModule;
-    fragmentShaderStageInfo.pName = "main";
-
-    std::array<VkPipelineShaderStageCreateInfo, 2> const shaderStages = { vertexShaderStageInfo, fragmentShaderStageInfo };
-
-    VkVertexInputBindingDescription const& bindingDescription = Vertex::GetBindingDescription();
-
-    VkVertexInputAttributeDescription attributeDescription = {};
-    attributeDescription.binding = 0;
-    attributeDescription.location = 0;
-    attributeDescription.format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescription.offset = 0;
-
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.vertexAttributeDescriptionCount = 1;
-    vertexInputInfo.pVertexAttributeDescriptions = &attributeDescription;
-
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
-    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-    VkPipelineViewportStateCreateInfo viewportState = {};
-    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportState.viewportCount = 1;
-    viewportState.scissorCount = 1;
-
-    std::vector<VkDynamicState> const dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-    VkPipelineDynamicStateCreateInfo dynamicState = {};
-    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamicState.pDynamicStates = dynamicStateEnables.data();
-    dynamicState.dynamicStateCount = dynamicStateEnables.size();
-
-    VkPipelineRasterizationStateCreateInfo rasterizer = {};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.cullMode = VK_CULL_MODE_NONE;
-    rasterizer.lineWidth = 1.0f;
-
-    VkPipelineMultisampleStateCreateInfo multisampling = {};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-    VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-    depthStencil.depthTestEnable = VK_FALSE;
-    depthStencil.depthWriteEnable = VK_FALSE;
-    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-    depthStencil.depthBoundsTestEnable = VK_FALSE;
-    depthStencil.stencilTestEnable = VK_FALSE;
-
-    VkPipelineColorBlendAttachmentState colorBlendState = {};
-    colorBlendState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendState.blendEnable = VK_FALSE;
-
-    VkPipelineColorBlendStateCreateInfo colorBlending = {};
-    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlending.logicOpEnable = VK_FALSE;
-    colorBlending.logicOp = VK_LOGIC_OP_COPY;
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendState;
+    VkShaderModule computeShaderModule = resourceManager.GetShaderModule("IrradianceCube.comp");
+
+    VkPipelineShaderStageCreateInfo computeShaderStageInfo = {};
+    computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computeShaderStageInfo.module = computeShaderModule;
+    computeShaderStageInfo.pName = "main";
 
     // Pipeline Layout
     std::vector<VkDescriptorSetLayout> const setLayouts = {
-        resourceManager.GetDescriptorLayout(SkyboxComponentResource::ms_bindings)
+        resourceManager.GetDescriptorLayout(IrradiancePass::ms_bindings)
     };
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
@@ -143,7 +69,7 @@ void IrradiancePass::Init()
 
     VkPushConstantRange pushConstantRange = {};
     pushConstantRange.size = sizeof(IrradiancePushConstantBlock);
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
@@ -153,217 +79,148 @@ void IrradiancePass::Init()
     }
 
     // Pipeline
-    VkGraphicsPipelineCreateInfo pipelineInfo = {};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = shaderStages.size();
-    pipelineInfo.pStages = shaderStages.data();
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssembly;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizer;
-    pipelineInfo.pMultisampleState = &multisampling;
-    pipelineInfo.pDepthStencilState = &depthStencil;
-    pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.pDynamicState = &dynamicState;
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = computeShaderStageInfo;
     pipelineInfo.layout = m_pipelineLayout;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    std::vector<VkFormat> colorAttachmentFormats;
-    colorAttachmentFormats.reserve(GetColorOutputAttachments().size());
-    for (AttachmentResource const* attachment : GetColorOutputAttachments())
+    if (vkCreateComputePipelines(renderer.GetDevice(), renderer.GetPipelineCache(), 1, &pipelineInfo, nullptr, &m_computePipeline) != VK_SUCCESS)
     {
-        colorAttachmentFormats.push_back(attachment->GetImageCreationInfo().m_format);
+        ThrowError("Failed to create compute pipeline.");
     }
 
-    VkFormat const depthFormat = GetDepthStencilAttachment() ? GetDepthStencilAttachment()->GetImageCreationInfo().m_format : VK_FORMAT_UNDEFINED;
-    VkFormat const stencilFormat = GetDepthStencilAttachment() && renderer.FormatHasStencil(depthFormat) ? depthFormat : VK_FORMAT_UNDEFINED;
-
-    VkPipelineRenderingCreateInfo pipelineRenderingInfo = {};
-    pipelineRenderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
-    pipelineRenderingInfo.colorAttachmentCount = colorAttachmentFormats.size();
-    pipelineRenderingInfo.pColorAttachmentFormats = colorAttachmentFormats.data();
-    pipelineRenderingInfo.depthAttachmentFormat = depthFormat;
-    pipelineRenderingInfo.stencilAttachmentFormat = stencilFormat;
-    PNextChainPushBack(&pipelineInfo, &pipelineRenderingInfo);
+    // A storage view and descriptor set per mip, the environment is bound once the skybox is known
+    ImageResource const& irradianceImage = m_irradianceCube->GetImage();
+    uint8_t const mipLevels = m_irradianceCube->GetImageCreationInfo().m_mipLevels;
+    m_mipImageViews.reserve(mipLevels);
+    m_mipDescriptorSets.reserve(mipLevels);
 
-    if (vkCreateGraphicsPipelines(renderer.GetDevice(), renderer.GetPipelineCache(), 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS)
+    for (uint8_t mipLevel = 0; mipLevel < mipLevels; ++mipLevel)
     {
-        ThrowError("Failed to create graphics pipeline.");
+        m_mipImageViews.push_back(irradianceImage.CreateMipImageView(mipLevel));
+        DescriptorSet& descriptorSet = m_mipDescriptorSets.emplace_back(IrradiancePass::ms_bindings);
+
+        VkDescriptorImageInfo descriptorInfo = {};
+        descriptorInfo.imageView = m_mipImageViews.back();
+        descriptorInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet writeDescriptorSet = {};
+        writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writeDescriptorSet.descriptorCount = 1;
+        writeDescriptorSet.dstSet = descriptorSet.GetDescriptorSet();
+        writeDescriptorSet.dstBinding = 1;
+        writeDescriptorSet.pImageInfo = &descriptorInfo;
+
+        vkUpdateDescriptorSets(renderer.GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
     }
 }
 
-void IrradiancePass::ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionContext const& context)
+void IrradiancePass::ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionContext const&)
 {
     EntitySystem& entitySystem = EntitySystem::GetInstance();
-    auto const& skyboxView = entitySystem.GetView<SkyboxComponentResource const, StaticMeshComponent const>();
+    auto const& skyboxView = entitySystem.GetView<SkyboxComponentResource const>();
     Entity skyboxEntity = skyboxView.front();
     if (!EntitySystem::IsEntityValid(skyboxEntity))
     {
         return;
     }
 
-    StaticMeshComponent const& staticMesh = skyboxView.Get<StaticMeshComponent const>(skyboxEntity);
     SkyboxComponentResource const& skyboxResource = skyboxView.Get<SkyboxComponentResource const>(skyboxEntity);
+    SharedPtr<TextureResource> const skyboxTexture = skyboxResource.GetTextureCube();
+    if (!skyboxTexture)
+    {
+        return;
+    }
 
-    VkBuffer const vertexBuffers[] = { staticMesh.GetVertexBuffer() };
-    VkDeviceSize const offsets[] = { 0 };
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-
-    VkBuffer const indexBuffer = staticMesh.GetIndexBuffer();
-    if (indexBuffer != VK_NULL_HANDLE)
+    // Environments without a known content hash are always filtered
+    uint64_t const cacheKey = skyboxTexture->GetContentHash() != 0 ? m_settings.GetCacheKey(skyboxTexture->GetContentHash()) : 0;
+    if (cacheKey != 0 && m_cache.RecordLoad(cacheKey, m_irradianceCube->GetImage(), commandBuffer))
     {
-        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+        m_renderGraph->RemovePass(GetName());
+        return;
     }
 
-    IrradiancePushConstantBlock pushBlock = {};
-    pushBlock.m_deltaPhi = (2.0f * float(M_PI)) / m_irradiancePhiSteps;
-    pushBlock.m_deltaTheta = (0.5f * float(M_PI)) / m_irradianceThetaSteps;
-
-    VkViewport viewport = {};
-    viewport.x = static_cast<float>(context.m_renderingInfo.renderArea.offset.x);
-    viewport.y = static_cast<float>(context.m_renderingInfo.renderArea.offset.y);
-    viewport.width = static_cast<float>(context.m_renderingInfo.renderArea.extent.width);
-    viewport.height = static_cast<float>(context.m_renderingInfo.renderArea.extent.height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-
-    VkRect2D scissor = context.m_renderingInfo.renderArea;
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
-    std::vector<glm::mat4> const matrices = {
-        glm::rotate(glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)), glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f)),
-        glm::rotate(glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f)), glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f)),
-        glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f)),
-        glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)),
-        glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f)),
-        glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
-    };
+    Renderer const& renderer = Renderer::GetInstance();
 
-    std::vector<VkDescriptorSet> const descriptorsets = {
-        skyboxResource.GetDescriptorSet().GetDescriptorSet(),
-    };
+    VkDescriptorImageInfo const environmentInfo = skyboxTexture->GetDescriptorInfo();
+    for (DescriptorSet& descriptorSet : m_mipDescriptorSets)
+    {
+        VkWriteDescriptorSet writeDescriptorSet = {};
+        writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writeDescriptorSet.descriptorCount = 1;
+        writeDescriptorSet.dstSet = descriptorSet.GetDescriptorSet();
+        writeDescriptorSet.dstBinding = 0;
+        writeDescriptorSet.pImageInfo = &environmentInfo;
+
+        vkUpdateDescriptorSets(renderer.GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
+    }
 
     m_irradianceCube->GetImage().TransitionLayout(
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VK_IMAGE_LAYOUT_GENERAL,
         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
         commandBuffer
     );
-    
-    uint8_t const mipLevels = m_irradianceCube->GetImageCreationInfo().m_mipLevels;
-    for (uint8_t mipLevel = 0; mipLevel < mipLevels; ++mipLevel)
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
+
+    IrradiancePushConstantBlock pushBlock = {};
+    pushBlock.m_deltaPhi = (2.0f * float(M_PI)) / m_settings.m_phiSteps;
+    pushBlock.m_deltaTheta = (0.5f * float(M_PI)) / m_settings.m_thetaSteps;
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(IrradiancePushConstantBlock), &pushBlock);
+
+    // Mips are independent, so the dispatches need no barrier between them
+    for (uint8_t mipLevel = 0; mipLevel < m_mipDescriptorSets.size(); ++mipLevel)
     {
-        for (uint8_t face = 0; face < 6; ++face)
-        {
-            // Render scene from cube face's point of view
-            vkCmdBeginRendering(commandBuffer, &context.m_renderingInfo);
-
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
-
-            viewport.width = static_cast<float>(m_resolution * std::pow(0.5f, mipLevel));
-            viewport.height = static_cast<float>(m_resolution * std::pow(0.5f, mipLevel));
-            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, descriptorsets.size(), descriptorsets.data(), 0, nullptr);
-
-            pushBlock.m_mvp = glm::perspective((float)(M_PI / 2.0f), 1.0f, 0.1f, 512.0f) * matrices[face];
-            vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(IrradiancePushConstantBlock), &pushBlock);
-
-            for (Primitive const& primitive : staticMesh.GetPrimitives())
-            {
-                if (primitive.m_hasIndices)
-                {
-                    vkCmdDrawIndexed(commandBuffer, primitive.m_indexCount, 1, primitive.m_firstIndex, 0, 0);
-                }
-                else
-                {
-                    vkCmdDraw(commandBuffer, primitive.m_vertexCount, 1, 0, 0);
-                }
-            }
-
-            vkCmdEndRendering(commandBuffer);
-
-            AttachmentResource& attachment = m_renderGraph->GetAttachmentResource("tempIrradiance");
-            ImageResource& attachmentImage = attachment.GetImage();
-
-            VkImageLayout const initialLayout = attachmentImage.GetCurrentLayout();
-            if (initialLayout != VK_IMAGE_LAYOUT_GENERAL)
-            {
-                attachmentImage.TransitionLayout(
-                    VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                    commandBuffer
-                );
-            }
-
-            // Copy region for transfer from framebuffer to cube face
-            VkImageCopy copyRegion = {};
-
-            copyRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            copyRegion.srcSubresource.baseArrayLayer = 0;
-            copyRegion.srcSubresource.mipLevel = 0;
-            copyRegion.srcSubresource.layerCount = 1;
-            copyRegion.srcOffset = { 0, 0, 0 };
-
-            copyRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            copyRegion.dstSubresource.baseArrayLayer = face;
-            copyRegion.dstSubresource.mipLevel = mipLevel;
-            copyRegion.dstSubresource.layerCount = 1;
-            copyRegion.dstOffset = { 0, 0, 0 };
-
-            copyRegion.extent.width = viewport.width;
-            copyRegion.extent.height = viewport.height;
-            copyRegion.extent.depth = 1;
-
-            vkCmdCopyImage(
-                commandBuffer,
-                attachmentImage.GetImage(),
-                attachmentImage.GetCurrentLayout(),
-                m_irradianceCube->GetImage().GetImage(),
-                m_irradianceCube->GetImage().GetCurrentLayout(),
-                1,
-                &copyRegion
-            );
-
-            if (initialLayout != VK_IMAGE_LAYOUT_GENERAL)
-            {
-                attachmentImage.TransitionLayout(
-                    initialLayout,
-                    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                    commandBuffer
-                );
-            }
-        }
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &m_mipDescriptorSets[mipLevel].GetDescriptorSet(), 0, nullptr);
+
+        uint32_t const mipResolution = std::max(m_settings.m_resolution >> mipLevel, 1);
+        uint32_t const groupCount = (mipResolution + ms_groupSize - 1) / ms_groupSize;
+        vkCmdDispatch(commandBuffer, groupCount, groupCount, 6);
     }
 
     m_irradianceCube->GetImage().TransitionLayout(
         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
         commandBuffer
     );
 
+    if (cacheKey != 0)
+    {
+        m_cache.RecordStore(cacheKey, m_irradianceCube->GetImage(), commandBuffer);
+    }
+
     m_renderGraph->RemovePass(GetName());
 }
 
 void IrradiancePass::Terminate()
 {
     Renderer& renderer = Renderer::GetInstance();
-    
+
+    // A removed pass is terminated once the frame that executed it has completed
+    m_cache.OnTransferCompleted();
+
+    m_mipDescriptorSets.clear();
+    for (VkImageView imageView : m_mipImageViews)
+    {
+        vkDestroyImageView(renderer.GetDevice(), imageView, nullptr);
+    }
+    m_mipImageViews.clear();
+
     if (m_pipelineLayout != VK_NULL_HANDLE)
     {
         vkDestroyPipelineLayout(renderer.GetDevice(), m_pipelineLayout, nullptr);
         m_pipelineLayout = VK_NULL_HANDLE;
     }
 
-    if (m_graphicsPipeline != VK_NULL_HANDLE)
+    if (m_computePipeline != VK_NULL_HANDLE)
     {
-        vkDestroyPipeline(renderer.GetDevice(), m_graphicsPipeline, nullptr);
-        m_graphicsPipeline = VK_NULL_HANDLE;
+        vkDestroyPipeline(renderer.GetDevice(), m_computePipeline, nullptr);
+        m_computePipeline = VK_NULL_HANDLE;
     }
 
     RenderPass::Terminate();
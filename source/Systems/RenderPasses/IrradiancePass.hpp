@@ -1,10 +1,13 @@
 #pragma once
 
+#include <Resources/Descriptor.hpp>
+#include <Resources/IBLCache.hpp>
 #include <Systems/RenderPasses/RenderPass.hpp>
 
 class RenderGraph;
 class TextureResource;
 
+// Convolves the skybox into the irradiance cube with a compute dispatch per mip, covering every face at once
 class IrradiancePass : public RenderPass
 {
 public:
@@ -19,18 +22,22 @@ protected:
 
 private:
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
-    VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
+    VkPipeline m_computePipeline = VK_NULL_HANDLE;
 
-    uint16_t m_resolution = 64;
-    float m_irradiancePhiSteps = 180.0f;
-    float m_irradianceThetaSteps = 64.0f;
+    IrradianceSettings m_settings;
 
     SharedPtr<TextureResource> m_irradianceCube = nullptr;
+    std::vector<VkImageView> m_mipImageViews; // Storage views with a layer per face
+    std::vector<DescriptorSet> m_mipDescriptorSets;
+    IBLCache m_cache{ "irradiance" };
+
+public:
+    static const std::vector<VkDescriptorSetLayoutBinding> ms_bindings;
+    static constexpr uint32_t ms_groupSize = 8; // Local size of the shader
 };
 
 struct IrradiancePushConstantBlock
 {
-    glm::mat4 m_mvp;
     float m_deltaPhi = 0.0f;
     float m_deltaTheta = 0.0f;
 };
@@ -0,0 +1,186 @@
+#include <Systems/RenderPasses/IrradianceSHPass.hpp>
+
+#include <Components/IBLComponent.hpp>
+#include <Components/SkyboxComponent.hpp>
+#include <Resources/Buffer.hpp>
+#include <Resources/TextureResource.hpp>
+#include <Systems/EntitySystem.hpp>
+#include <Systems/Renderer.hpp>
+#include <Systems/RenderGraph.hpp>
+#include <Systems/ResourceManager.hpp>
+
+const std::vector<VkDescriptorSetLayoutBinding> IrradianceSHPass::ms_bindings = {
+    { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr }, // Environment
+    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr } // Irradiance SH
+};
+
+IrradianceSHPass::IrradianceSHPass(std::string const& name, RenderGraph* renderGraph)
+    : RenderPass(name, renderGraph)
+{
+}
+
+void IrradianceSHPass::DeclareAttachmentsUsage()
+{
+    // The coefficients are written to a storage buffer
+}
+
+void IrradianceSHPass::Init()
+{
+    RenderPass::Init();
+
+    Renderer& renderer = Renderer::GetInstance();
+    ResourceManager& resourceManager = ResourceManager::GetInstance();
+
+    // Create pipeline
+    VkShaderModule computeShaderModule = resourceManager.GetShaderModule("IrradianceSH.comp");
+
+    VkPipelineShaderStageCreateInfo computeShaderStageInfo = {};
+    computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computeShaderStageInfo.module = computeShaderModule;
+    computeShaderStageInfo.pName = "main";
+
+    // Pipeline Layout
+    std::vector<VkDescriptorSetLayout> const setLayouts = {
+        resourceManager.GetDescriptorLayout(IrradianceSHPass::ms_bindings)
+    };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = setLayouts.size();
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.size = sizeof(IrradianceSHPushConstantBlock);
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(renderer.GetDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+    {
+        ThrowError("Failed to create pipeline layout.");
+    }
+
+    // Pipeline
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = computeShaderStageInfo;
+    pipelineInfo.layout = m_pipelineLayout;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    if (vkCreateComputePipelines(renderer.GetDevice(), renderer.GetPipelineCache(), 1, &pipelineInfo, nullptr, &m_computePipeline) != VK_SUCCESS)
+    {
+        ThrowError("Failed to create compute pipeline.");
+    }
+
+    // The output buffer is owned by the IBL component, the environment is bound once the skybox is known
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    IBLComponent& ibl = entitySystem.GetOrAddComponent<IBLComponent>(entitySystem.GetGlobalEntity());
+
+    m_descriptorSet = DescriptorSet(IrradianceSHPass::ms_bindings);
+
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = ibl.m_irradianceSH->GetBuffer();
+    bufferInfo.offset = 0;
+    bufferInfo.range = sizeof(IrradianceSH);
+
+    VkWriteDescriptorSet writeDescriptorSet = {};
+    writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.dstSet = m_descriptorSet.GetDescriptorSet();
+    writeDescriptorSet.dstBinding = 1;
+    writeDescriptorSet.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(renderer.GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
+}
+
+void IrradianceSHPass::ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionContext const&)
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    auto const& skyboxView = entitySystem.GetView<SkyboxComponentResource const>();
+    Entity skyboxEntity = skyboxView.front();
+    if (!EntitySystem::IsEntityValid(skyboxEntity))
+    {
+        return;
+    }
+
+    SkyboxComponentResource const& skyboxResource = skyboxView.Get<SkyboxComponentResource const>(skyboxEntity);
+    SharedPtr<TextureResource> const skyboxTexture = skyboxResource.GetTextureCube();
+    if (!skyboxTexture)
+    {
+        return;
+    }
+
+    IBLComponent const* ibl = entitySystem.TryGetComponent<IBLComponent const>(entitySystem.GetGlobalEntity());
+    if (!ibl)
+    {
+        return;
+    }
+
+    Renderer const& renderer = Renderer::GetInstance();
+
+    VkDescriptorImageInfo const environmentInfo = skyboxTexture->GetDescriptorInfo();
+
+    VkWriteDescriptorSet writeDescriptorSet = {};
+    writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.dstSet = m_descriptorSet.GetDescriptorSet();
+    writeDescriptorSet.dstBinding = 0;
+    writeDescriptorSet.pImageInfo = &environmentInfo;
+
+    vkUpdateDescriptorSets(renderer.GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &m_descriptorSet.GetDescriptorSet(), 0, nullptr);
+
+    IrradianceSHPushConstantBlock pushBlock = {};
+    pushBlock.m_faceSize = m_faceSize;
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(IrradianceSHPushConstantBlock), &pushBlock);
+
+    // The whole projection and its reduction fit in one workgroup
+    vkCmdDispatch(commandBuffer, 1, 1, 1);
+
+    VkBufferMemoryBarrier bufferBarrier = {};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_UNIFORM_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = ibl->m_irradianceSH->GetBuffer();
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0,
+        0, nullptr,
+        1, &bufferBarrier,
+        0, nullptr);
+
+    m_renderGraph->RemovePass(GetName());
+}
+
+void IrradianceSHPass::Terminate()
+{
+    Renderer& renderer = Renderer::GetInstance();
+
+    m_descriptorSet = DescriptorSet();
+
+    if (m_pipelineLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(renderer.GetDevice(), m_pipelineLayout, nullptr);
+        m_pipelineLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_computePipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(renderer.GetDevice(), m_computePipeline, nullptr);
+        m_computePipeline = VK_NULL_HANDLE;
+    }
+
+    RenderPass::Terminate();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Resources/Descriptor.hpp>
+#include <Systems/RenderPasses/RenderPass.hpp>
+
+class RenderGraph;
+
+// Projects the skybox onto nine SH coefficients with a single compute workgroup, replacing the irradiance cube
+class IrradianceSHPass : public RenderPass
+{
+public:
+    IrradianceSHPass(std::string const& name, RenderGraph* renderGraph);
+
+    virtual void DeclareAttachmentsUsage() override;
+    virtual void Init() override;
+    virtual void Terminate() override;
+
+protected:
+    virtual void ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionContext const& context) override;
+
+private:
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_computePipeline = VK_NULL_HANDLE;
+    DescriptorSet m_descriptorSet;
+
+    uint32_t m_faceSize = 64; // Texels projected along each face edge, sampled from the matching skybox mip
+
+public:
+    static const std::vector<VkDescriptorSetLayoutBinding> ms_bindings;
+};
+
+struct IrradianceSHPushConstantBlock
+{
+    uint32_t m_faceSize = 64;
+};
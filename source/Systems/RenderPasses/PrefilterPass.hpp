@@ -1,11 +1,13 @@
 #pragma once
 
+#include <Resources/Descriptor.hpp>
+#include <Resources/IBLCache.hpp>
 #include <Systems/RenderPasses/RenderPass.hpp>
-#include <Utilities/Helpers.hpp>
 
 class RenderGraph;
 class TextureResource;
 
+// Filters the skybox into the prefiltered cube, a roughness per mip, with a compute dispatch per mip covering every face at once
 class PrefilterPass : public RenderPass
 {
 public:
@@ -20,16 +22,22 @@ protected:
 
 private:
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
-    VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
+    VkPipeline m_computePipeline = VK_NULL_HANDLE;
 
-    uint16_t m_resolution = 512;
+    PrefilterSettings m_settings;
 
     SharedPtr<TextureResource> m_prefilteredCube = nullptr;
+    std::vector<VkImageView> m_mipImageViews; // Storage views with a layer per face
+    std::vector<DescriptorSet> m_mipDescriptorSets;
+    IBLCache m_cache{ "prefiltered" };
+
+public:
+    static const std::vector<VkDescriptorSetLayoutBinding> ms_bindings;
+    static constexpr uint32_t ms_groupSize = 8; // Local size of the shader
 };
 
 struct PrefilterPushConstantBlock
 {
-    glm::mat4 m_mvp;
     float m_roughness = 1.0f;
     uint32_t m_samples = 32;
 };
@@ -4,6 +4,7 @@
 #include <Components/IBLComponent.hpp>
 #include <Components/LightComponent.hpp>
 #include <Components/SceneComponent.hpp>
+#include <Components/ShadowComponent.hpp>
 #include <Components/SkyboxComponent.hpp>
 #include <Components/StaticMeshComponent.hpp>
 #include <Resources/AttachmentResource.hpp>
@@ -37,6 +38,15 @@ void ShadingPass::DeclareAttachmentsUsage()
     brdflutInfo.m_samplerInfo.m_addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
     brdflutInfo.m_samplerInfo.m_anisotropy = 1.0f;
     AddTextureRead("brdflut", brdflutInfo, true);
+
+    // Hardware depth comparison, linear filtering gives 2x2 percentage closer filtering
+    TextureCreationInfo shadowAtlasInfo;
+    shadowAtlasInfo.m_samplerInfo.m_addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    shadowAtlasInfo.m_samplerInfo.m_addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    shadowAtlasInfo.m_samplerInfo.m_addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    shadowAtlasInfo.m_samplerInfo.m_anisotropy = 1.0f;
+    shadowAtlasInfo.m_samplerInfo.m_compareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+    AddTextureRead("shadowatlas", shadowAtlasInfo, true);
 }
 
 void ShadingPass::Init()
@@ -46,6 +56,55 @@ void ShadingPass::Init()
     Renderer& renderer = Renderer::GetInstance();
     ResourceManager& resourceManager = ResourceManager::GetInstance();
 
+    // Pipeline Layout
+    std::vector<VkDescriptorSetLayout> const setLayouts = {
+        resourceManager.GetDescriptorLayout(CameraComponentResource::ms_bindings),
+        resourceManager.GetDescriptorLayout(SceneComponentGlobalResource::ms_bindings),
+        resourceManager.GetBindlessTextureLayout(),
+        resourceManager.GetDescriptorLayout(IBLComponent::ms_bindings),
+        resourceManager.GetDescriptorLayout(LightComponentGlobalResource::ms_bindings),
+        resourceManager.GetDescriptorLayout(StaticMeshComponentGlobalResource::ms_bindings),
+        resourceManager.GetDescriptorLayout(ShadowComponentGlobalResource::ms_bindings)
+    };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = setLayouts.size();
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+
+    // Mesh dequantization for the vertex stage followed by the material index for the fragment stage
+    std::array<VkPushConstantRange, 2> pushConstantRanges = {};
+    pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRanges[0].offset = 0;
+    pushConstantRanges[0].size = sizeof(MeshPushConstantBlock);
+    pushConstantRanges[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRanges[1].offset = sizeof(MeshPushConstantBlock);
+    pushConstantRanges[1].size = sizeof(MaterialPushConstantBlock);
+    pipelineLayoutInfo.pushConstantRangeCount = pushConstantRanges.size();
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+    if (vkCreatePipelineLayout(renderer.GetDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+    {
+        ThrowError("Failed to create pipeline layout.");
+    }
+
+    if (renderer.GetRenderSettings().m_useDepthPrePass)
+    {
+        // Opaque depth is already laid down, only the visible fragment of each pixel is shaded
+        m_graphicsPipeline = CreateGraphicsPipeline(VK_COMPARE_OP_EQUAL, false);
+        m_alphaMaskedGraphicsPipeline = CreateGraphicsPipeline(VK_COMPARE_OP_LESS, true);
+    }
+    else
+    {
+        m_graphicsPipeline = CreateGraphicsPipeline(VK_COMPARE_OP_LESS, true);
+    }
+}
+
+VkPipeline ShadingPass::CreateGraphicsPipeline(VkCompareOp depthCompareOp, bool depthWrite) const
+{
+    Renderer& renderer = Renderer::GetInstance();
+    ResourceManager& resourceManager = ResourceManager::GetInstance();
+
     // Create pipeline
     VkShaderModule vertexShaderModule = resourceManager.GetShaderModule("Pbr.vert");
     VkShaderModule fragmentShaderModule = resourceManager.GetShaderModule("Pbr.frag");
@@ -62,15 +121,36 @@ void ShadingPass::Init()
     fragmentShaderStageInfo.module = fragmentShaderModule;
     fragmentShaderStageInfo.pName = "main";
 
+    // Selects where the diffuse IBL term comes from
+    VkBool32 const useIrradianceSH = renderer.GetRenderSettings().m_useIrradianceSH;
+
+    VkSpecializationMapEntry specializationEntry = {};
+    specializationEntry.constantID = 2;
+    specializationEntry.offset = 0;
+    specializationEntry.size = sizeof(VkBool32);
+
+    VkSpecializationInfo specializationInfo = {};
+    specializationInfo.mapEntryCount = 1;
+    specializationInfo.pMapEntries = &specializationEntry;
+    specializationInfo.dataSize = sizeof(VkBool32);
+    specializationInfo.pData = &useIrradianceSH;
+    fragmentShaderStageInfo.pSpecializationInfo = &specializationInfo;
+
     std::array<VkPipelineShaderStageCreateInfo, 2> const shaderStages = { vertexShaderStageInfo, fragmentShaderStageInfo };
 
-    VkVertexInputBindingDescription const& bindingDescription = Vertex::GetBindingDescription();
-    std::array<VkVertexInputAttributeDescription, 4> const& attributeDescriptions = Vertex::GetAttributeDescriptions();
+    std::array<VkVertexInputBindingDescription, 3> const& vertexBindingDescriptions = Vertex::GetBindingDescriptions();
+    std::array<VkVertexInputAttributeDescription, 4> const& vertexAttributeDescriptions = Vertex::GetAttributeDescriptions();
+
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions(vertexBindingDescriptions.begin(), vertexBindingDescriptions.end());
+    bindingDescriptions.push_back(MeshInstance::GetBindingDescription());
+
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(vertexAttributeDescriptions.begin(), vertexAttributeDescriptions.end());
+    attributeDescriptions.push_back(MeshInstance::GetAttributeDescription());
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexBindingDescriptionCount = bindingDescriptions.size();
+    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
     vertexInputInfo.vertexAttributeDescriptionCount = attributeDescriptions.size();
     vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
@@ -86,7 +166,8 @@ void ShadingPass::Init()
     viewportState.scissorCount = 1;
     viewportState.pScissors = nullptr;
 
-    std::vector<VkDynamicState> dynamicEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    // The stride is dynamic so meshes without a second uv set can alias their first one
+    std::vector<VkDynamicState> dynamicEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE };
     VkPipelineDynamicStateCreateInfo dynamicState = {};
     dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
     dynamicState.dynamicStateCount = dynamicEnables.size();
@@ -111,8 +192,8 @@ void ShadingPass::Init()
     VkPipelineDepthStencilStateCreateInfo depthStencil = {};
     depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
     depthStencil.depthTestEnable = VK_TRUE;
-    depthStencil.depthWriteEnable = VK_TRUE;
-    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthWriteEnable = depthWrite;
+    depthStencil.depthCompareOp = depthCompareOp;
     depthStencil.depthBoundsTestEnable = VK_FALSE;
     depthStencil.stencilTestEnable = VK_FALSE;
 
@@ -127,31 +208,6 @@ void ShadingPass::Init()
     colorBlending.attachmentCount = 1;
     colorBlending.pAttachments = &colorBlendState;
 
-    // Pipeline Layout
-    std::vector<VkDescriptorSetLayout> const setLayouts = {
-        resourceManager.GetDescriptorLayout(CameraComponentResource::ms_bindings),
-        resourceManager.GetDescriptorLayout(SceneComponentResource::ms_bindings),
-        resourceManager.GetDescriptorLayout(Material::ms_bindings),
-        resourceManager.GetDescriptorLayout(IBLComponent::ms_bindings),
-        resourceManager.GetDescriptorLayout(LightComponentGlobalResource::ms_bindings)
-    };
-
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = setLayouts.size();
-    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
-
-    VkPushConstantRange pushConstantRange = {};
-    pushConstantRange.size = sizeof(MaterialPushConstantBlock);
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    pipelineLayoutInfo.pushConstantRangeCount = 1;
-    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-
-    if (vkCreatePipelineLayout(renderer.GetDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
-    {
-        ThrowError("Failed to create pipeline layout.");
-    }
-
     // Pipeline
     VkGraphicsPipelineCreateInfo pipelineInfo = {};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -186,10 +242,13 @@ void ShadingPass::Init()
     pipelineRenderingInfo.stencilAttachmentFormat = stencilFormat;
     PNextChainPushBack(&pipelineInfo, &pipelineRenderingInfo);
 
-    if (vkCreateGraphicsPipelines(renderer.GetDevice(), renderer.GetPipelineCache(), 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS)
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(renderer.GetDevice(), renderer.GetPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
     {
         ThrowError("Failed to create graphics pipeline.");
     }
+
+    return pipeline;
 }
 
 void ShadingPass::ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionContext const& context)
@@ -215,6 +274,12 @@ void ShadingPass::ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionCo
         return;
     }
 
+    ShadowComponentGlobalResource const* shadowGlobalResource = entitySystem.TryGetComponent<ShadowComponentGlobalResource const>(entitySystem.GetGlobalEntity());
+    if (!shadowGlobalResource || !shadowGlobalResource->HasShadowAtlas())
+    {
+        return;
+    }
+
     vkCmdBeginRendering(commandBuffer, &context.m_renderingInfo);
     
     VkViewport viewport = {};
@@ -233,65 +298,102 @@ void ShadingPass::ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionCo
 
     CameraComponentResource const& cameraResource = cameraView.Get<CameraComponentResource const>(cameraEntity);
 
-    auto const& entitiesToDraw = entitySystem.GetView<SceneComponentResource const, StaticMeshComponent const>(entt::exclude_t<SkyboxComponent>());
-    for (Entity entity : entitiesToDraw)
+    SceneComponentGlobalResource const& sceneGlobalResource = entitySystem.GetComponent<SceneComponentGlobalResource const>(entitySystem.GetGlobalEntity());
+    StaticMeshComponentGlobalResource const& meshGlobalResource = entitySystem.GetComponent<StaticMeshComponentGlobalResource const>(entitySystem.GetGlobalEntity());
+
+    // Every set is bound once, transforms are indexed through the instance buffer and materials through a push constant
+    std::vector<VkDescriptorSet> const descriptorSets = {
+        cameraResource.GetDescriptorSetInFlight().GetDescriptorSet(),
+        sceneGlobalResource.GetDescriptorSetInFlight().GetDescriptorSet(),
+        ResourceManager::GetInstance().GetBindlessTextureSet(),
+        iblComponent->GetDescriptorSet().GetDescriptorSet(),
+        lightGlobalComponent->GetDescriptorSetInFlight().GetDescriptorSet(),
+        meshGlobalResource.GetDescriptorSetInFlight().GetDescriptorSet(),
+        shadowGlobalResource->GetDescriptorSetInFlight().GetDescriptorSet()
+    };
+    uint32_t const cameraOffset = cameraResource.GetUniformOffset();
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, descriptorSets.size(), descriptorSets.data(), 1, &cameraOffset);
+
+    VkBuffer const instanceBuffer = meshGlobalResource.m_instanceBuffer.GetResource().GetBuffer();
+    VkDeviceSize const instanceBufferOffset = 0;
+    VkDeviceSize const instanceBufferStride = sizeof(MeshInstance);
+    vkCmdBindVertexBuffers2(commandBuffer, 1, 1, &instanceBuffer, &instanceBufferOffset, nullptr, &instanceBufferStride);
+
+    DrawBatches(commandBuffer, false);
+
+    if (m_alphaMaskedGraphicsPipeline != VK_NULL_HANDLE)
     {
-        SceneComponentResource const& sceneResource = entitiesToDraw.Get<SceneComponentResource const>(entity);
-        StaticMeshComponent const& staticMesh = entitiesToDraw.Get<StaticMeshComponent const>(entity);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_alphaMaskedGraphicsPipeline);
+        DrawBatches(commandBuffer, true);
+    }
 
-        VkBuffer const vertexBuffers[] = { staticMesh.GetVertexBuffer() };
-        VkDeviceSize const offsets[] = { 0 };
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+    vkCmdEndRendering(commandBuffer);
+}
 
-        VkBuffer const indexBuffer = staticMesh.GetIndexBuffer();
-        if (indexBuffer != VK_NULL_HANDLE)
+void ShadingPass::DrawBatches(VkCommandBuffer commandBuffer, bool alphaMasked) const
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    StaticMeshComponentGlobalResource const& meshGlobalResource = entitySystem.GetComponent<StaticMeshComponentGlobalResource const>(entitySystem.GetGlobalEntity());
+
+    // Each batch draws every instance of a mesh with a single instanced draw per visible primitive range
+    for (StaticMeshComponentGlobalResource::InstanceBatch const& batch : meshGlobalResource.m_batches)
+    {
+        StaticMeshComponent const* staticMesh = entitySystem.TryGetComponent<StaticMeshComponent const>(batch.m_entity);
+        if (!staticMesh || batch.m_instanceCount == 0)
         {
-            vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+            continue;
         }
 
-        for (Primitive const& primitive : staticMesh.GetPrimitives())
+        MeshAsset const& meshAsset = *staticMesh->GetMeshAsset();
+
+        VkBuffer const positionBuffer = meshAsset.GetPositionBuffer();
+        VkDeviceSize const positionOffset = 0;
+        VkDeviceSize const positionStride = sizeof(VertexPosition);
+        vkCmdBindVertexBuffers2(commandBuffer, Vertex::ms_positionBinding, 1, &positionBuffer, &positionOffset, nullptr, &positionStride);
+
+        // Without a second uv set the first one is read in its place
+        bool const hasUvSet1 = meshAsset.GetUvSet1Buffer() != VK_NULL_HANDLE;
+        VkBuffer const attributeBuffers[] = { meshAsset.GetAttributeBuffer(), hasUvSet1 ? meshAsset.GetUvSet1Buffer() : meshAsset.GetAttributeBuffer() };
+        VkDeviceSize const attributeOffsets[] = { 0, hasUvSet1 ? 0 : offsetof(VertexAttributes, m_uvSet0) };
+        VkDeviceSize const attributeStrides[] = { sizeof(VertexAttributes), hasUvSet1 ? sizeof(glm::u16vec2) : sizeof(VertexAttributes) };
+        vkCmdBindVertexBuffers2(commandBuffer, Vertex::ms_attributeBinding, 2, attributeBuffers, attributeOffsets, nullptr, attributeStrides);
+
+        VkBuffer const indexBuffer = meshAsset.GetIndexBuffer();
+        if (indexBuffer != VK_NULL_HANDLE)
         {
-            std::vector<VkDescriptorSet> const descriptorsets = {
-                cameraResource.GetDescriptorSetInFlight().GetDescriptorSet(),
-                sceneResource.GetDescriptorSetInFlight().GetDescriptorSet(),
-                primitive.m_material->m_descriptorSet.GetDescriptorSet(),
-                iblComponent->GetDescriptorSet().GetDescriptorSet(),
-                lightGlobalComponent->GetDescriptorSetInFlight().GetDescriptorSet()
-            };
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, descriptorsets.size(), descriptorsets.data(), 0, nullptr);
-
-            // Pass material parameters as push constants
-            MaterialPushConstantBlock pushConstBlockMaterial = {};
-            // To save push constant space, availabilty and texture coordinate set are combined
-            // -1 == texture not used for this material; >= 0 texture used and index of texture coordinate set
-            pushConstBlockMaterial.m_colorTextureSet = primitive.m_material->m_baseColorTexture ? primitive.m_material->m_baseColorTextCoordSet : -1;
-            pushConstBlockMaterial.m_physicalTextureSet = primitive.m_material->m_metallicRoughnessTexture ? primitive.m_material->m_metallicRoughnessTextCoordSet : -1;
-            pushConstBlockMaterial.m_normalTextureSet = primitive.m_material->m_normalTexture ? primitive.m_material->m_normalTextCoordSet : -1;
-            pushConstBlockMaterial.m_occlusionTextureSet = primitive.m_material->m_occlusionTexture ? primitive.m_material->m_occlusionTextCoordSet : -1;
-            pushConstBlockMaterial.m_emissiveTextureSet = primitive.m_material->m_emissiveTexture ? primitive.m_material->m_emissiveTextCoordSet : -1;
+            vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, meshAsset.GetIndexType());
+        }
 
-            pushConstBlockMaterial.m_baseColorFactor = primitive.m_material->m_baseColorFactor;
-            pushConstBlockMaterial.m_metallicFactor = primitive.m_material->m_metallicFactor;
-            pushConstBlockMaterial.m_roughnessFactor = primitive.m_material->m_roughnessFactor;
-            pushConstBlockMaterial.m_emissiveFactor = primitive.m_material->m_emissiveFactor;
+        MeshPushConstantBlock const pushBlockMesh = meshAsset.GetMeshPushConstantBlock();
+        vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstantBlock), &pushBlockMesh);
 
-            pushConstBlockMaterial.m_alphaMask = static_cast<float>(primitive.m_material->m_alphaMode == Material::AlphaMode::Mask);
-            pushConstBlockMaterial.m_alphaMaskCutoff = primitive.m_material->m_alphaCutoff;
+        std::vector<Primitive> const& primitives = staticMesh->GetPrimitives();
+        for (uint32_t d = batch.m_firstDraw; d < batch.m_firstDraw + batch.m_drawCount; d++)
+        {
+            StaticMeshComponentGlobalResource::PrimitiveDraw const& draw = meshGlobalResource.m_draws[d];
+            Primitive const& primitive = primitives[draw.m_primitive];
 
-            vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(MaterialPushConstantBlock), &pushConstBlockMaterial);
+            // Without a masked pipeline every primitive is drawn in the first call
+            bool const isAlphaMasked = m_alphaMaskedGraphicsPipeline != VK_NULL_HANDLE && primitive.m_material->m_alphaMode == Material::AlphaMode::Mask;
+            if (isAlphaMasked != alphaMasked)
+            {
+                continue;
+            }
+
+            MaterialPushConstantBlock pushConstBlockMaterial = {};
+            pushConstBlockMaterial.m_materialIndex = meshGlobalResource.m_primitiveMaterials[batch.m_firstPrimitive + draw.m_primitive];
+            vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(MeshPushConstantBlock), sizeof(MaterialPushConstantBlock), &pushConstBlockMaterial);
 
             if (primitive.m_hasIndices)
             {
-                vkCmdDrawIndexed(commandBuffer, primitive.m_indexCount, 1, primitive.m_firstIndex, 0, 0);
+                vkCmdDrawIndexed(commandBuffer, draw.m_indexCount, batch.m_instanceCount, draw.m_firstIndex, 0, batch.m_firstInstance);
             }
             else
             {
-                vkCmdDraw(commandBuffer, primitive.m_vertexCount, 1, 0, 0);
+                vkCmdDraw(commandBuffer, primitive.m_vertexCount, batch.m_instanceCount, 0, batch.m_firstInstance);
             }
         }
     }
-
-    vkCmdEndRendering(commandBuffer);
 }
 
 void ShadingPass::Terminate()
@@ -310,5 +412,11 @@ void ShadingPass::Terminate()
         m_graphicsPipeline = VK_NULL_HANDLE;
     }
 
+    if (m_alphaMaskedGraphicsPipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(renderer.GetDevice(), m_alphaMaskedGraphicsPipeline, nullptr);
+        m_alphaMaskedGraphicsPipeline = VK_NULL_HANDLE;
+    }
+
     RenderPass::Terminate();
 }
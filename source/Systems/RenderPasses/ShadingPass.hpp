@@ -16,22 +16,17 @@ public:
 protected:
     virtual void ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionContext const& context) override;
 
+private:
+    VkPipeline CreateGraphicsPipeline(VkCompareOp depthCompareOp, bool depthWrite) const;
+    void DrawBatches(VkCommandBuffer commandBuffer, bool alphaMasked) const;
+
 private:
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
     VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
+    VkPipeline m_alphaMaskedGraphicsPipeline = VK_NULL_HANDLE; // Alpha tested primitives are not in the depth pre-pass
 };
 
 struct MaterialPushConstantBlock
 {
-    glm::vec4 m_baseColorFactor;
-    glm::vec3 m_emissiveFactor;
-    int32_t m_colorTextureSet;
-    int32_t m_physicalTextureSet;
-    int32_t m_normalTextureSet;
-    int32_t m_occlusionTextureSet;
-    int32_t m_emissiveTextureSet;
-    float m_metallicFactor;
-    float m_roughnessFactor;
-    float m_alphaMask;
-    float m_alphaMaskCutoff;
+    uint32_t m_materialIndex;
 };
@@ -0,0 +1,385 @@
+#include <Systems/RenderPasses/ShadowPass.hpp>
+
+#include <Components/SceneComponent.hpp>
+#include <Components/ShadowComponent.hpp>
+#include <Components/StaticMeshComponent.hpp>
+#include <Resources/AttachmentResource.hpp>
+#include <Resources/ImageResource.hpp>
+#include <Resources/ResourceInFlight.hpp>
+#include <Resources/TextureResource.hpp>
+#include <Systems/EntitySystem.hpp>
+#include <Systems/RenderPasses/ShadingPass.hpp>
+#include <Systems/Renderer.hpp>
+#include <Systems/ResourceManager.hpp>
+#include <Utilities/Helpers.hpp>
+
+void ShadowPass::DeclareAttachmentsUsage()
+{
+    AttachmentCreationInfo atlasAttachmentInfo;
+    atlasAttachmentInfo.m_imageCreateInfo.m_width = ShadowComponentGlobalResource::ms_atlasSize;
+    atlasAttachmentInfo.m_imageCreateInfo.m_height = ShadowComponentGlobalResource::ms_atlasSize;
+    atlasAttachmentInfo.m_imageCreateInfo.m_sizeType = SizeType::Absolute;
+    atlasAttachmentInfo.m_imageCreateInfo.m_format = ms_shadowFormat;
+    SetDepthStencilOutputAttachment("shadowatlas", atlasAttachmentInfo);
+
+    // Cached tiles have to survive between frames
+    m_renderGraph->GetAttachmentResource("shadowatlas").SetIsPersistent(true);
+}
+
+void ShadowPass::Init()
+{
+    RenderPass::Init();
+
+    Renderer& renderer = Renderer::GetInstance();
+    ResourceManager& resourceManager = ResourceManager::GetInstance();
+
+    // Pipeline Layout, the textures and materials are only read by the alpha masked pipeline
+    std::vector<VkDescriptorSetLayout> const setLayouts = {
+        resourceManager.GetDescriptorLayout(SceneComponentGlobalResource::ms_bindings),
+        resourceManager.GetBindlessTextureLayout(),
+        resourceManager.GetDescriptorLayout(StaticMeshComponentGlobalResource::ms_bindings)
+    };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = setLayouts.size();
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+
+    // Shadow block for the vertex stage followed by the material index for the fragment stage
+    std::array<VkPushConstantRange, 2> pushConstantRanges = {};
+    pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRanges[0].offset = 0;
+    pushConstantRanges[0].size = sizeof(ShadowPushConstantBlock);
+    pushConstantRanges[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRanges[1].offset = sizeof(ShadowPushConstantBlock);
+    pushConstantRanges[1].size = sizeof(MaterialPushConstantBlock);
+    pipelineLayoutInfo.pushConstantRangeCount = pushConstantRanges.size();
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+    if (vkCreatePipelineLayout(renderer.GetDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+    {
+        ThrowError("Failed to create pipeline layout.");
+    }
+
+    m_graphicsPipeline = CreateGraphicsPipeline(false);
+    m_alphaMaskedGraphicsPipeline = CreateGraphicsPipeline(true);
+}
+
+VkPipeline ShadowPass::CreateGraphicsPipeline(bool alphaMasked) const
+{
+    Renderer& renderer = Renderer::GetInstance();
+    ResourceManager& resourceManager = ResourceManager::GetInstance();
+
+    // Create pipeline, opaque casters are depth only so there is no fragment stage
+    VkShaderModule vertexShaderModule = resourceManager.GetShaderModule(alphaMasked ? "ShadowMasked.vert" : "Shadow.vert");
+
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStages(1);
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = vertexShaderModule;
+    shaderStages[0].pName = "main";
+
+    if (alphaMasked)
+    {
+        VkPipelineShaderStageCreateInfo& fragmentShaderStageInfo = shaderStages.emplace_back();
+        fragmentShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        fragmentShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        fragmentShaderStageInfo.module = resourceManager.GetShaderModule("ShadowMasked.frag");
+        fragmentShaderStageInfo.pName = "main";
+    }
+
+    // Only the position stream is fetched, and the uv sets when alpha testing
+    std::array<VkVertexInputBindingDescription, 3> const& vertexBindingDescriptions = Vertex::GetBindingDescriptions();
+    std::array<VkVertexInputAttributeDescription, 4> const& vertexAttributeDescriptions = Vertex::GetAttributeDescriptions();
+
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions = { vertexBindingDescriptions[0], MeshInstance::GetBindingDescription() };
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions = { vertexAttributeDescriptions[0], MeshInstance::GetAttributeDescription() };
+    if (alphaMasked)
+    {
+        bindingDescriptions.insert(bindingDescriptions.end(), { vertexBindingDescriptions[1], vertexBindingDescriptions[2] });
+        attributeDescriptions.insert(attributeDescriptions.end(), { vertexAttributeDescriptions[2], vertexAttributeDescriptions[3] });
+    }
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = bindingDescriptions.size();
+    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = attributeDescriptions.size();
+    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    VkPipelineViewportStateCreateInfo viewportState = {};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.pViewports = nullptr;
+    viewportState.scissorCount = 1;
+    viewportState.pScissors = nullptr;
+
+    // The stride is dynamic so meshes without a second uv set can alias their first one
+    std::vector<VkDynamicState> dynamicEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE };
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = dynamicEnables.size();
+    dynamicState.pDynamicStates = dynamicEnables.data();
+
+    // Both faces cast shadows so open meshes do not leak light, the bias hides the resulting acne
+    VkPipelineRasterizationStateCreateInfo rasterizer = {};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_TRUE;
+    rasterizer.depthBiasConstantFactor = 1.25f;
+    rasterizer.depthBiasSlopeFactor = 1.75f;
+
+    VkPipelineMultisampleStateCreateInfo multisampling = {};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.sampleShadingEnable = VK_FALSE;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending = {};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.attachmentCount = 0;
+    colorBlending.pAttachments = nullptr;
+
+    // Pipeline
+    VkGraphicsPipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = shaderStages.size();
+    pipelineInfo.pStages = shaderStages.data();
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.layout = m_pipelineLayout;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    VkPipelineRenderingCreateInfo pipelineRenderingInfo = {};
+    pipelineRenderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    pipelineRenderingInfo.colorAttachmentCount = 0;
+    pipelineRenderingInfo.pColorAttachmentFormats = nullptr;
+    pipelineRenderingInfo.depthAttachmentFormat = ms_shadowFormat;
+    pipelineRenderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+    PNextChainPushBack(&pipelineInfo, &pipelineRenderingInfo);
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(renderer.GetDevice(), renderer.GetPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+    {
+        ThrowError("Failed to create graphics pipeline.");
+    }
+
+    return pipeline;
+}
+
+void ShadowPass::PreExecute(VkCommandBuffer commandBuffer, ExecutionContext const& context, PassExecutionContext& passContext)
+{
+    // The atlas was sampled by the last frame's shading pass, wait for those reads before writing depth again
+    m_renderGraph->GetAttachmentResource("shadowatlas").GetImage().TransitionLayout(
+        VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        commandBuffer
+    );
+
+    RenderPass::PreExecute(commandBuffer, context, passContext);
+
+    // Only the dirty tiles are cleared, the rest of the atlas is cached
+    passContext.m_depthAttachment->loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+}
+
+void ShadowPass::ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionContext const& context)
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+
+    ShadowComponentGlobalResource* shadowGlobalResource = entitySystem.TryGetComponent<ShadowComponentGlobalResource>(entitySystem.GetGlobalEntity());
+    if (!shadowGlobalResource)
+    {
+        return;
+    }
+
+    shadowGlobalResource->SetShadowAtlas(m_renderGraph->GetTextureFromAttachmentResource("shadowatlas"));
+
+    if (shadowGlobalResource->m_tileRenders.empty())
+    {
+        return;
+    }
+
+    vkCmdBeginRendering(commandBuffer, &context.m_renderingInfo);
+
+    SceneComponentGlobalResource const& sceneGlobalResource = entitySystem.GetComponent<SceneComponentGlobalResource const>(entitySystem.GetGlobalEntity());
+    StaticMeshComponentGlobalResource const& meshGlobalResource = entitySystem.GetComponent<StaticMeshComponentGlobalResource const>(entitySystem.GetGlobalEntity());
+
+    std::vector<VkDescriptorSet> const descriptorSets = {
+        sceneGlobalResource.GetDescriptorSetInFlight().GetDescriptorSet(),
+        ResourceManager::GetInstance().GetBindlessTextureSet(),
+        meshGlobalResource.GetDescriptorSetInFlight().GetDescriptorSet()
+    };
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, descriptorSets.size(), descriptorSets.data(), 0, nullptr);
+
+    VkBuffer const instanceBuffer = meshGlobalResource.m_instanceBuffer.GetResource().GetBuffer();
+    VkDeviceSize const instanceBufferOffset = 0;
+    VkDeviceSize const instanceBufferStride = sizeof(MeshInstance);
+    vkCmdBindVertexBuffers2(commandBuffer, 1, 1, &instanceBuffer, &instanceBufferOffset, nullptr, &instanceBufferStride);
+
+    for (ShadowComponentGlobalResource::TileRender const& tileRender : shadowGlobalResource->m_tileRenders)
+    {
+        ShadowAtlasTile const& tile = tileRender.m_atlasTile;
+
+        VkViewport viewport = {};
+        viewport.x = static_cast<float>(tile.m_x);
+        viewport.y = static_cast<float>(tile.m_y);
+        viewport.width = static_cast<float>(tile.m_size);
+        viewport.height = static_cast<float>(tile.m_size);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+        VkRect2D scissor = { { static_cast<int32_t>(tile.m_x), static_cast<int32_t>(tile.m_y) }, { tile.m_size, tile.m_size } };
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+        VkClearAttachment clearAttachment = {};
+        clearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        clearAttachment.clearValue.depthStencil = { 1.0f, 0 };
+
+        VkClearRect clearRect = {};
+        clearRect.rect = scissor;
+        clearRect.baseArrayLayer = 0;
+        clearRect.layerCount = 1;
+        vkCmdClearAttachments(commandBuffer, 1, &clearAttachment, 1, &clearRect);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
+        DrawCasters(commandBuffer, tileRender.m_viewProjection, false);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_alphaMaskedGraphicsPipeline);
+        DrawCasters(commandBuffer, tileRender.m_viewProjection, true);
+    }
+
+    vkCmdEndRendering(commandBuffer);
+}
+
+void ShadowPass::DrawCasters(VkCommandBuffer commandBuffer, glm::mat4 const& viewProjection, bool alphaMasked) const
+{
+    EntitySystem& entitySystem = EntitySystem::GetInstance();
+    StaticMeshComponentGlobalResource const& meshGlobalResource = entitySystem.GetComponent<StaticMeshComponentGlobalResource const>(entitySystem.GetGlobalEntity());
+
+    // Every batch is drawn whole, cluster culling was done against the camera and not this view
+    for (StaticMeshComponentGlobalResource::InstanceBatch const& batch : meshGlobalResource.m_batches)
+    {
+        StaticMeshComponent const* staticMesh = entitySystem.TryGetComponent<StaticMeshComponent const>(batch.m_entity);
+        if (!staticMesh || batch.m_instanceCount == 0)
+        {
+            continue;
+        }
+
+        std::vector<Primitive> const& primitives = staticMesh->GetPrimitives();
+        bool const hasPrimitives = std::any_of(primitives.begin(), primitives.end(), [alphaMasked](Primitive const& primitive)
+        {
+            return (primitive.m_material->m_alphaMode == Material::AlphaMode::Mask) == alphaMasked;
+        });
+
+        if (!hasPrimitives)
+        {
+            continue;
+        }
+
+        MeshAsset const& meshAsset = *staticMesh->GetMeshAsset();
+
+        VkBuffer const positionBuffer = meshAsset.GetPositionBuffer();
+        VkDeviceSize const positionOffset = 0;
+        VkDeviceSize const positionStride = sizeof(VertexPosition);
+        vkCmdBindVertexBuffers2(commandBuffer, Vertex::ms_positionBinding, 1, &positionBuffer, &positionOffset, nullptr, &positionStride);
+
+        // Without a second uv set the first one is read in its place
+        if (alphaMasked)
+        {
+            bool const hasUvSet1 = meshAsset.GetUvSet1Buffer() != VK_NULL_HANDLE;
+            VkBuffer const attributeBuffers[] = { meshAsset.GetAttributeBuffer(), hasUvSet1 ? meshAsset.GetUvSet1Buffer() : meshAsset.GetAttributeBuffer() };
+            VkDeviceSize const attributeOffsets[] = { 0, hasUvSet1 ? 0 : offsetof(VertexAttributes, m_uvSet0) };
+            VkDeviceSize const attributeStrides[] = { sizeof(VertexAttributes), hasUvSet1 ? sizeof(glm::u16vec2) : sizeof(VertexAttributes) };
+            vkCmdBindVertexBuffers2(commandBuffer, Vertex::ms_attributeBinding, 2, attributeBuffers, attributeOffsets, nullptr, attributeStrides);
+        }
+
+        VkBuffer const indexBuffer = meshAsset.GetIndexBuffer();
+        if (indexBuffer != VK_NULL_HANDLE)
+        {
+            vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, meshAsset.GetIndexType());
+        }
+
+        ShadowPushConstantBlock pushBlock;
+        pushBlock.m_mesh = meshAsset.GetMeshPushConstantBlock();
+        pushBlock.m_viewProjection = viewProjection;
+        vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ShadowPushConstantBlock), &pushBlock);
+
+        for (uint32_t p = 0; p < primitives.size(); p++)
+        {
+            Primitive const& primitive = primitives[p];
+            if ((primitive.m_material->m_alphaMode == Material::AlphaMode::Mask) != alphaMasked)
+            {
+                continue;
+            }
+
+            if (alphaMasked)
+            {
+                MaterialPushConstantBlock pushBlockMaterial = {};
+                pushBlockMaterial.m_materialIndex = meshGlobalResource.m_primitiveMaterials[batch.m_firstPrimitive + p];
+                vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(ShadowPushConstantBlock), sizeof(MaterialPushConstantBlock), &pushBlockMaterial);
+            }
+
+            // The full level of detail whatever the camera picked, so cached tiles stay valid as it moves
+            if (primitive.m_hasIndices)
+            {
+                PrimitiveLod const lod = primitive.GetLod(0);
+                vkCmdDrawIndexed(commandBuffer, lod.m_indexCount, batch.m_instanceCount, lod.m_firstIndex, 0, batch.m_firstInstance);
+            }
+            else
+            {
+                vkCmdDraw(commandBuffer, primitive.m_vertexCount, batch.m_instanceCount, 0, batch.m_firstInstance);
+            }
+        }
+    }
+}
+
+void ShadowPass::Terminate()
+{
+    Renderer& renderer = Renderer::GetInstance();
+
+    if (m_pipelineLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineLayout(renderer.GetDevice(), m_pipelineLayout, nullptr);
+        m_pipelineLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_graphicsPipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(renderer.GetDevice(), m_graphicsPipeline, nullptr);
+        m_graphicsPipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_alphaMaskedGraphicsPipeline != VK_NULL_HANDLE)
+    {
+        vkDestroyPipeline(renderer.GetDevice(), m_alphaMaskedGraphicsPipeline, nullptr);
+        m_alphaMaskedGraphicsPipeline = VK_NULL_HANDLE;
+    }
+
+    RenderPass::Terminate();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Resources/MeshAsset.hpp>
+#include <Systems/RenderPasses/RenderPass.hpp>
+
+class RenderGraph;
+
+// Mesh dequantization followed by the view of the shadow tile being rendered
+struct ShadowPushConstantBlock
+{
+    MeshPushConstantBlock m_mesh;
+    glm::mat4 m_viewProjection;
+};
+
+// Renders the depth of the dirty tiles of the persistent shadow atlas, the other tiles keep their cached depth.
+// Casters are always drawn at their full level of detail, the one picked for the camera changes without dirtying the tiles.
+class ShadowPass : public RenderPass
+{
+public:
+    ShadowPass(std::string const& name, RenderGraph* renderGraph) : RenderPass(name, renderGraph) {}
+
+    virtual void DeclareAttachmentsUsage() override;
+    virtual void Init() override;
+    virtual void Terminate() override;
+
+protected:
+    virtual void PreExecute(VkCommandBuffer commandBuffer, ExecutionContext const& context, PassExecutionContext& passContext) override;
+    virtual void ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionContext const& context) override;
+
+private:
+    VkPipeline CreateGraphicsPipeline(bool alphaMasked) const;
+    void DrawCasters(VkCommandBuffer commandBuffer, glm::mat4 const& viewProjection, bool alphaMasked) const;
+
+private:
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
+    VkPipeline m_alphaMaskedGraphicsPipeline = VK_NULL_HANDLE; // Alpha tests the base color like the shading pass
+
+    static constexpr VkFormat ms_shadowFormat = VK_FORMAT_D16_UNORM;
+};
@@ -54,15 +54,16 @@ void SkyboxPass::Init()
 
     std::array<VkPipelineShaderStageCreateInfo, 2> const shaderStages = { vertexShaderStageInfo, fragmentShaderStageInfo };
 
-    VkVertexInputBindingDescription const& bindingDescription = Vertex::GetBindingDescription();
-    std::array<VkVertexInputAttributeDescription, 4> const& attributeDescriptions = Vertex::GetAttributeDescriptions();
+    // Only the position is fetched from the vertex buffer
+    VkVertexInputBindingDescription const bindingDescription = Vertex::GetBindingDescriptions()[0];
+    VkVertexInputAttributeDescription const attributeDescription = Vertex::GetAttributeDescriptions()[0];
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertexInputInfo.vertexBindingDescriptionCount = 1;
     vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.vertexAttributeDescriptionCount = attributeDescriptions.size();
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = 1;
+    vertexInputInfo.pVertexAttributeDescriptions = &attributeDescription;
 
     VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -128,8 +129,11 @@ void SkyboxPass::Init()
     pipelineLayoutInfo.setLayoutCount = setLayouts.size();
     pipelineLayoutInfo.pSetLayouts = setLayouts.data();
 
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-    pipelineLayoutInfo.pPushConstantRanges = nullptr;
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.size = sizeof(MeshPushConstantBlock);
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
     if (vkCreatePipelineLayout(renderer.GetDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
     {
@@ -214,23 +218,27 @@ void SkyboxPass::ExecuteInternal(VkCommandBuffer commandBuffer, PassExecutionCon
 
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
 
-    VkBuffer const vertexBuffers[] = { staticMesh.GetVertexBuffer() };
+    VkBuffer const vertexBuffers[] = { staticMesh.GetPositionBuffer() };
     VkDeviceSize const offsets[] = { 0 };
     vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 
     VkBuffer const indexBuffer = staticMesh.GetIndexBuffer();
     if (indexBuffer != VK_NULL_HANDLE)
     {
-        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, staticMesh.GetIndexType());
     }
 
+    MeshPushConstantBlock const pushBlock = staticMesh.GetMeshAsset()->GetMeshPushConstantBlock();
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstantBlock), &pushBlock);
+
     for (Primitive const& primitive : staticMesh.GetPrimitives())
     {
         std::vector<VkDescriptorSet> const descriptorsets = {
             cameraResource.GetDescriptorSetInFlight().GetDescriptorSet(),
             iblComponent.GetDescriptorSet().GetDescriptorSet(),
         };
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, descriptorsets.size(), descriptorsets.data(), 0, nullptr);
+        uint32_t const cameraOffset = cameraResource.GetUniformOffset();
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, descriptorsets.size(), descriptorsets.data(), 1, &cameraOffset);
 
         if (primitive.m_hasIndices)
         {
@@ -3,8 +3,11 @@
 #include <Resources/ImageResource.hpp>
 #include <Systems/RenderGraph.hpp>
 #include <Systems/RenderPasses/BrdflutPass.hpp>
+#include <Systems/RenderPasses/DepthPrePass.hpp>
 #include <Systems/RenderPasses/IrradiancePass.hpp>
+#include <Systems/RenderPasses/IrradianceSHPass.hpp>
 #include <Systems/RenderPasses/PrefilterPass.hpp>
+#include <Systems/RenderPasses/ShadowPass.hpp>
 #include <Systems/RenderPasses/ShadingPass.hpp>
 #include <Systems/RenderPasses/SkyboxPass.hpp>
 #include <Utilities/Observer.hpp>
@@ -45,14 +48,27 @@ void Renderer::Init()
     CreateSyncObjects();
     CreatePipelineCache();
     CreateSingleUseCommandPool();
+    CreateUniformAllocator();
 }
 
 void Renderer::PostInit()
 {
     m_renderGraph.AddPass<BrdflutPass>("brdflut");
-    m_renderGraph.AddPass<IrradiancePass>("irradiance");
+    if (m_renderSettings.m_useIrradianceSH)
+    {
+        m_renderGraph.AddPass<IrradianceSHPass>("irradiance");
+    }
+    else
+    {
+        m_renderGraph.AddPass<IrradiancePass>("irradiance");
+    }
     m_renderGraph.AddPass<PrefilterPass>("prefilter");
     m_renderGraph.AddPass<SkyboxPass>("skybox");
+    if (m_renderSettings.m_useDepthPrePass)
+    {
+        m_renderGraph.AddPass<DepthPrePass>("depthprepass");
+    }
+    m_renderGraph.AddPass<ShadowPass>("shadow");
     m_renderGraph.AddPass<ShadingPass>("shading");
     m_renderGraph.Init();
 }
@@ -66,6 +82,8 @@ void Renderer::PreTerminate()
 
 void Renderer::Terminate()
 {
+    DestroyUniformAllocator();
+    m_stagingAllocator.Destroy();
     DestroySingleUseCommandPool();
     DestroyPipelineCache();
     DestroySyncObjects();
@@ -305,12 +323,24 @@ void Renderer::CreateLogicalDevice()
     deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     deviceFeatures.features.samplerAnisotropy = m_renderSettings.m_useAnisotropy;
     deviceFeatures.features.sampleRateShading = m_renderSettings.m_useSampleShading;
+    // Block compressed textures, used when the device has them
+    deviceFeatures.features.textureCompressionBC = m_physicalDeviceInfo.m_features.features.textureCompressionBC;
+    deviceFeatures.features.textureCompressionASTC_LDR = m_physicalDeviceInfo.m_features.features.textureCompressionASTC_LDR;
 
     VkPhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeature = {};
     dynamicRenderingFeature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
     dynamicRenderingFeature.dynamicRendering = VK_TRUE;
     PNextChainPushBack(&deviceFeatures, &dynamicRenderingFeature);
 
+    // Bindless material textures
+    VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeature = {};
+    descriptorIndexingFeature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    descriptorIndexingFeature.runtimeDescriptorArray = VK_TRUE;
+    descriptorIndexingFeature.descriptorBindingPartiallyBound = VK_TRUE;
+    descriptorIndexingFeature.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    descriptorIndexingFeature.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    PNextChainPushBack(&deviceFeatures, &descriptorIndexingFeature);
+
     VkDeviceCreateInfo deviceCreateInfo = {};
     deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 
@@ -365,6 +395,16 @@ void Renderer::DestroyMemoryAllocator()
     vmaDestroyAllocator(m_allocator);
 }
 
+void Renderer::CreateUniformAllocator()
+{
+    m_uniformAllocator.Create(m_renderSettings.m_uniformAllocatorSize, m_renderSettings.m_maxFramesInFlight);
+}
+
+void Renderer::DestroyUniformAllocator()
+{
+    m_uniformAllocator.Destroy();
+}
+
 void Renderer::CreateSwapchain()
 {
     VkPresentModeKHR const presentMode = ChooseSwapchainPresentMode();
@@ -519,6 +559,7 @@ void Renderer::DestroySingleUseCommandPool()
 void Renderer::RenderFrame()
 {
     vkWaitForFences(m_device, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+    m_uniformAllocator.OnFrameRetired(m_currentFrame);
 
     VkResult const acquireImageResult = vkAcquireNextImageKHR(m_device, m_swapchain, UINT64_MAX, m_imageAvailableSemaphores[m_currentFrame], VK_NULL_HANDLE, &m_currentImageIndex);
 
@@ -558,6 +599,7 @@ void Renderer::RenderFrame()
     vkResetFences(m_device, 1, &m_inFlightFences[m_currentFrame]);
 
     m_renderGraph.Execute(currentCommandBuffer);
+    m_uniformAllocator.EndFrame(m_currentFrame);
 
     if (vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, m_inFlightFences[m_currentFrame]) != VK_SUCCESS)
     {
@@ -724,9 +766,13 @@ bool Renderer::CheckPhysicalDeviceProperties(VkPhysicalDevice device, PhysicalDe
     deviceInfo.m_dynamicRenderingFeature = {};
     deviceInfo.m_dynamicRenderingFeature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
 
+    deviceInfo.m_descriptorIndexingFeature = {};
+    deviceInfo.m_descriptorIndexingFeature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
     deviceInfo.m_features = {};
     deviceInfo.m_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     PNextChainPushBack(&deviceInfo.m_features, &deviceInfo.m_dynamicRenderingFeature);
+    PNextChainPushBack(&deviceInfo.m_features, &deviceInfo.m_descriptorIndexingFeature);
     
     vkGetPhysicalDeviceFeatures2(device, &deviceInfo.m_features);
     vkGetPhysicalDeviceProperties(device, &deviceInfo.m_properties);
@@ -734,7 +780,14 @@ bool Renderer::CheckPhysicalDeviceProperties(VkPhysicalDevice device, PhysicalDe
 
     bool const anisotropyCheck = !m_renderSettings.m_useAnisotropy || deviceInfo.m_features.features.samplerAnisotropy;
 
+    VkPhysicalDeviceDescriptorIndexingFeatures const& descriptorIndexing = deviceInfo.m_descriptorIndexingFeature;
+    bool const bindlessCheck = descriptorIndexing.runtimeDescriptorArray
+        && descriptorIndexing.descriptorBindingPartiallyBound
+        && descriptorIndexing.descriptorBindingSampledImageUpdateAfterBind
+        && descriptorIndexing.shaderSampledImageArrayNonUniformIndexing;
+
     return anisotropyCheck
+        && bindlessCheck
         && deviceInfo.m_dynamicRenderingFeature.dynamicRendering;
 } 
 
@@ -868,6 +921,13 @@ VkFormat Renderer::ChooseBackbufferFormat() const
     );
 }
 
+bool Renderer::IsFormatSupported(VkFormat format, VkFormatFeatureFlags features) const
+{
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &formatProperties);
+    return (formatProperties.optimalTilingFeatures & features) == features;
+}
+
 /*static*/ bool Renderer::FormatHasStencil(VkFormat format)
 {
     return Contains(s_sortedDepthStencilFormats, format);
@@ -937,6 +997,33 @@ void Renderer::EndSingleUseCommandBuffer(VkCommandBuffer commandBuffer)
     vkFreeCommandBuffers(m_device, m_singleUseCommandPool, 1, &commandBuffer);
 }
 
+void Renderer::WaitForCurrentFrameInFlight() const
+{
+    vkWaitForFences(m_device, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+}
+
+void Renderer::UpdateIBL()
+{
+    if (!m_renderGraph.IsInitialized())
+    {
+        // The passes added in PostInit filter the first skybox
+        return;
+    }
+
+    // The IBL textures and their descriptor set are shared by every frame in flight
+    vkDeviceWaitIdle(m_device);
+
+    if (m_renderSettings.m_useIrradianceSH)
+    {
+        m_renderGraph.AddPass<IrradianceSHPass>("irradiance");
+    }
+    else
+    {
+        m_renderGraph.AddPass<IrradiancePass>("irradiance");
+    }
+    m_renderGraph.AddPass<PrefilterPass>("prefilter");
+}
+
 void Renderer::PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& debugMessengerInfo) const
 {
     debugMessengerInfo = {};
@@ -984,6 +1071,7 @@ void Renderer::PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoE
         break;
 
     case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+    case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
         // Image is a depth/stencil attachment
         // Make sure any writes to the depth/stencil buffer have been finished
         srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
@@ -1007,6 +1095,12 @@ void Renderer::PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoE
         srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
         break;
 
+    case VK_IMAGE_LAYOUT_GENERAL:
+        // Image is a storage image
+        // Make sure any shader writes to the image have been finished
+        srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        break;
+
     case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
         // Synchronization regarding presentation
         // is handled in the by our fences and semaphores
@@ -1041,6 +1135,7 @@ void Renderer::PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoE
         break;
 
     case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+    case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
         // Image layout will be used as a depth/stencil attachment
         // Make sure any writes to depth/stencil buffer have been finished
         dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
@@ -1056,6 +1151,12 @@ void Renderer::PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoE
         dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
         break;
 
+    case VK_IMAGE_LAYOUT_GENERAL:
+        // Image will be used as a storage image
+        // Make sure any shader reads and writes wait for the transition
+        dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        break;
+
     case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
         // There is no need to delay subsequent processing, or perform any visibility operations
         // (as vkQueuePresentKHR performs automatic visibility operations).
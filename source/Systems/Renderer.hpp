@@ -1,6 +1,8 @@
 #pragma once
 
 #include <Resources/ImageResource.hpp>
+#include <Resources/LinearUniformAllocator.hpp>
+#include <Resources/StagingAllocator.hpp>
 #include <Systems/RenderGraph.hpp>
 #include <Systems/System.hpp>
 #include <Utilities/Helpers.hpp>
@@ -20,7 +22,12 @@ public:
         bool m_useValidationLayers = true;
         bool m_useMultisampling = true;
         bool m_useSampleShading = true;
+        bool m_useDepthPrePass = true;
+        bool m_useGpuProfiler = true;
+        bool m_useIrradianceSH = false; // Diffuse IBL from nine SH coefficients instead of an irradiance cube
+        bool m_useTextureStreaming = true; // Material textures only keep the mips visible on screen resident
         VkSampleCountFlagBits m_rasterizationSampleCount = VK_SAMPLE_COUNT_FLAG_BITS_MAX_ENUM;
+        VkDeviceSize m_uniformAllocatorSize = 4 * 1024 * 1024; // Per frame in flight
         std::vector<char const*> m_validationLayers{ "VK_LAYER_KHRONOS_validation" };
         std::vector<char const*> m_deviceExtensions{ VK_KHR_SWAPCHAIN_EXTENSION_NAME };
         static constexpr uint16_t m_maxFramesInFlight = 2;
@@ -33,6 +40,7 @@ public:
         VkSurfaceCapabilitiesKHR m_capabilities;
         VkPhysicalDeviceFeatures2 m_features;
         VkPhysicalDeviceDynamicRenderingFeatures m_dynamicRenderingFeature;
+        VkPhysicalDeviceDescriptorIndexingFeatures m_descriptorIndexingFeature;
         VkPhysicalDeviceProperties m_properties;
         VkPhysicalDeviceMemoryProperties m_memoryProperties;
         std::vector<VkSurfaceFormatKHR> m_surfaceFormats;
@@ -50,6 +58,7 @@ public:
     // Getters
     VkDevice GetDevice() const { return m_device; }
     VmaAllocator GetAllocator() const { return m_allocator; }
+    VkQueue GetGraphicsQueue() const { return m_graphicsQueue; }
     RenderGraph const* GetRenderGraph() const { return &m_renderGraph; }
     RenderGraph* GetRenderGraph() { return &m_renderGraph; }
     ImageResource& GetCurrentSwapchainImage() { return m_swapchainImages[m_currentImageIndex]; }
@@ -58,6 +67,9 @@ public:
     VkFormat GetSwapchainFormat() const { return m_swapchainImageFormat.format; }
     VkExtent2D GetSwapchainExtent() const { return m_swapchainExtent; }
     VkPipelineCache GetPipelineCache() const { return m_pipelineCache; }
+    LinearUniformAllocator& GetUniformAllocator() { return m_uniformAllocator; }
+    LinearUniformAllocator const& GetUniformAllocator() const { return m_uniformAllocator; }
+    StagingAllocator& GetStagingAllocator() { return m_stagingAllocator; }
     void GetMouseCursorPosition(double& xPosition, double& yPosition) const { glfwGetCursorPos(m_window, &xPosition, &yPosition); }
     int32_t GetMouseButton(int32_t button) const { return glfwGetMouseButton(m_window, button); }
     int32_t GetKey(int32_t key) const { return glfwGetKey(m_window, key); }
@@ -67,6 +79,7 @@ public:
     VkSampleCountFlagBits GetRasterizationSampleCount() const;
     VkFormat ChooseDepthFormat(bool requireStencil = false) const;
     VkFormat ChooseBackbufferFormat() const;
+    bool IsFormatSupported(VkFormat format, VkFormatFeatureFlags features) const;
     static VkImageAspectFlags GetAspectFlagsFromFormat(VkFormat format);
     static bool FormatHasStencil(VkFormat format);
     static void GetAccessMasksForLayoutTransition(VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags& srcAccessMask, VkAccessFlags& dstAccessMask);
@@ -78,6 +91,9 @@ public:
     // Helpers
     VkCommandBuffer BeginSingleUseCommandBuffer();
     void EndSingleUseCommandBuffer(VkCommandBuffer commandBuffer);
+    void WaitForCurrentFrameInFlight() const;
+    // Filters the image based lighting of a new skybox, from the disk cache when it has been seen before
+    void UpdateIBL();
 
 private:
     // Core
@@ -95,6 +111,7 @@ private:
     void CreateSyncObjects();
     void CreatePipelineCache();
     void CreateSingleUseCommandPool();
+    void CreateUniformAllocator();
     void RecreateSwapchain();
 
     // Destroy
@@ -108,6 +125,7 @@ private:
     void DestroySyncObjects();
     void DestroyPipelineCache();
     void DestroySingleUseCommandPool();
+    void DestroyUniformAllocator();
 
     // Helpers
     std::vector<char const*> GetRequiredExtensions() const;
@@ -160,6 +178,8 @@ private:
     uint32_t m_currentImageIndex = 0;
 
     VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+    LinearUniformAllocator m_uniformAllocator;
+    StagingAllocator m_stagingAllocator;
     
     VkDebugUtilsMessengerEXT m_debugMessenger = VK_NULL_HANDLE;
 
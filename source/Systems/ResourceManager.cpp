@@ -1,10 +1,12 @@
 #include <Systems/ResourceManager.hpp>
 
 #include <Resources/ImageResource.hpp>
+#include <Resources/MeshAsset.hpp>
 #include <Systems/Renderer.hpp>
 
 void ResourceManager::Init()
 {
+    CreateBindlessTextureSet();
     CreateEmptyTexture();
 }
 
@@ -34,7 +36,22 @@ void ResourceManager::Terminate()
     }
     m_shaderModuleMap.clear();
 
+    m_meshAssetMap.clear();
+
+    Log("Texture cache: %u hits, %u misses", m_textureCacheStatistics.m_hits, m_textureCacheStatistics.m_misses);
+    m_textureMap.clear();
+
     m_emptyTexture->Destroy();
+
+    DestroyBindlessTextureSet();
+}
+
+void ResourceManager::Update()
+{
+    // The renderer already waited for this frame, slots released two frames ago are no longer sampled
+    std::vector<uint32_t>& pendingFreeSlots = m_bindlessPendingFreeSlots.GetResource();
+    m_bindlessFreeSlots.insert(m_bindlessFreeSlots.end(), pendingFreeSlots.begin(), pendingFreeSlots.end());
+    pendingFreeSlots.clear();
 }
 
 VkDescriptorSetLayout ResourceManager::GetDescriptorLayout(DescriptorLayoutBindings const& descriptorLayoutBindings)
@@ -198,26 +215,200 @@ VkShaderModule ResourceManager::CreateShaderModule(std::string const& fileName)
     return shaderModule;
 }
 
+SharedPtr<MeshAsset> ResourceManager::GetMeshAsset(std::string const& name)
+{
+    auto foundIt = m_meshAssetMap.find(name);
+    if (foundIt == m_meshAssetMap.end())
+    {
+        return nullptr;
+    }
+
+    SharedPtr<MeshAsset> meshAsset = foundIt->second.lock();
+    if (!meshAsset)
+    {
+        // Every user of the asset is gone
+        m_meshAssetMap.erase(foundIt);
+    }
+
+    return meshAsset;
+}
+
+void ResourceManager::AddMeshAsset(std::string const& name, SharedPtr<MeshAsset> const& meshAsset)
+{
+    m_meshAssetMap[name] = meshAsset;
+}
+
+/*static*/ std::string ResourceManager::GetTextureName(std::string const& source, VkFormat format, TextureSampler const& sampler)
+{
+    return StringFormat("%s#%d#%d,%d,%d,%d,%d,%g,%d", source.c_str(), format,
+        sampler.m_magFilter, sampler.m_minFilter, sampler.m_addressModeU, sampler.m_addressModeV, sampler.m_addressModeW,
+        sampler.m_anisotropy, sampler.m_compareOp);
+}
+
+SharedPtr<TextureResource> ResourceManager::GetTexture(std::string const& name)
+{
+    auto foundIt = m_textureMap.find(name);
+    if (foundIt == m_textureMap.end())
+    {
+        m_textureCacheStatistics.m_misses++;
+        return nullptr;
+    }
+
+    SharedPtr<TextureResource> texture = foundIt->second.lock();
+    if (!texture)
+    {
+        // Every user of the texture is gone
+        m_textureMap.erase(foundIt);
+        m_textureCacheStatistics.m_misses++;
+        return nullptr;
+    }
+
+    m_textureCacheStatistics.m_hits++;
+    return texture;
+}
+
+void ResourceManager::AddTexture(std::string const& name, SharedPtr<TextureResource> const& texture)
+{
+    m_textureMap[name] = texture;
+}
+
 void ResourceManager::CreateEmptyTexture()
 {
     static constexpr uint8_t s_emptyData[] = { 0, 0, 0, 0 };
     static constexpr TextureCreationInfo s_emptyTextureInfo
     {
-        /* m_imageCreateInfo */
+        .m_imageCreateInfo =
         {
-            /*m_width*/                 1.0f,
-            /*m_height*/                1.0f,
-            /*m_sizeType*/              SizeType::Absolute,
-            /*m_layers*/                1,
-            /*m_mipLevels*/             1,
-            /*m_format*/                VK_FORMAT_R8G8B8A8_UNORM,
-            /*m_sampleCount*/           VK_SAMPLE_COUNT_1_BIT
+            .m_width = 1.0f,
+            .m_height = 1.0f,
+            .m_sizeType = SizeType::Absolute,
+            .m_layers = 1,
+            .m_mipLevels = 1,
+            .m_format = VK_FORMAT_R8G8B8A8_UNORM,
+            .m_sampleCount = VK_SAMPLE_COUNT_1_BIT
         },
-        /*m_channels*/              4,
-        /*m_bytesPerChannel*/       1,
-        /*m_samplerInfo*/           TextureSampler(),
-        /*m_data*/                  s_emptyData
+        .m_channels = 4,
+        .m_bytesPerChannel = 1,
+        .m_samplerInfo = TextureSampler(),
+        .m_data = s_emptyData
     };
     
     m_emptyTexture = std::make_unique<TextureResource>(s_emptyTextureInfo);
+    m_emptyTexture->MakeBindless();
+}
+
+void ResourceManager::CreateBindlessTextureSet()
+{
+    Renderer& renderer = Renderer::GetInstance();
+
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = ms_maxBindlessTextures;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // Slots are written while the set is bound and most of them are never written at all
+    VkDescriptorBindingFlags const bindingFlags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = 1;
+    bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+    PNextChainPushBack(&layoutInfo, &bindingFlagsInfo);
+
+    if (vkCreateDescriptorSetLayout(renderer.GetDevice(), &layoutInfo, nullptr, &m_bindlessTextureLayout) != VK_SUCCESS)
+    {
+        ThrowError("Failed to create bindless texture descriptor set layout.");
+    }
+
+    VkDescriptorPoolSize const poolSize = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, ms_maxBindlessTextures };
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+
+    if (vkCreateDescriptorPool(renderer.GetDevice(), &poolInfo, nullptr, &m_bindlessTexturePool) != VK_SUCCESS)
+    {
+        ThrowError("Failed to create bindless texture descriptor pool.");
+    }
+
+    VkDescriptorSetAllocateInfo descriptorSetAllocInfo = {};
+    descriptorSetAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    descriptorSetAllocInfo.descriptorPool = m_bindlessTexturePool;
+    descriptorSetAllocInfo.pSetLayouts = &m_bindlessTextureLayout;
+    descriptorSetAllocInfo.descriptorSetCount = 1;
+
+    if (vkAllocateDescriptorSets(renderer.GetDevice(), &descriptorSetAllocInfo, &m_bindlessTextureSet) != VK_SUCCESS)
+    {
+        ThrowError("Failed to allocate bindless texture descriptor set.");
+    }
+}
+
+void ResourceManager::DestroyBindlessTextureSet()
+{
+    Renderer& renderer = Renderer::GetInstance();
+
+    // Destroying the pool frees the set
+    vkDestroyDescriptorPool(renderer.GetDevice(), m_bindlessTexturePool, nullptr);
+    vkDestroyDescriptorSetLayout(renderer.GetDevice(), m_bindlessTextureLayout, nullptr);
+
+    m_bindlessTexturePool = VK_NULL_HANDLE;
+    m_bindlessTextureLayout = VK_NULL_HANDLE;
+    m_bindlessTextureSet = VK_NULL_HANDLE;
+    m_bindlessTextureCount = 0;
+    m_bindlessFreeSlots.clear();
+    for (std::vector<uint32_t>& pendingFreeSlots : m_bindlessPendingFreeSlots)
+    {
+        pendingFreeSlots.clear();
+    }
+}
+
+uint32_t ResourceManager::AllocateBindlessTexture(VkDescriptorImageInfo const& imageInfo)
+{
+    uint32_t index = 0;
+    if (!m_bindlessFreeSlots.empty())
+    {
+        index = m_bindlessFreeSlots.back();
+        m_bindlessFreeSlots.pop_back();
+    }
+    else if (m_bindlessTextureCount < ms_maxBindlessTextures)
+    {
+        index = m_bindlessTextureCount++;
+    }
+    else
+    {
+        ThrowError("Out of bindless texture slots.");
+    }
+
+    VkWriteDescriptorSet writeDescriptorSet = {};
+    writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.dstSet = m_bindlessTextureSet;
+    writeDescriptorSet.dstBinding = 0;
+    writeDescriptorSet.dstArrayElement = index;
+    writeDescriptorSet.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(Renderer::GetInstance().GetDevice(), 1, &writeDescriptorSet, 0, nullptr);
+
+    return index;
+}
+
+void ResourceManager::FreeBindlessTexture(uint32_t index)
+{
+    if (m_bindlessTextureSet == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    m_bindlessPendingFreeSlots.GetResource().push_back(index);
 }
@@ -1,11 +1,20 @@
 #pragma once
 
 #include <Resources/Descriptor.hpp>
+#include <Resources/ResourceInFlight.hpp>
 #include <Resources/TextureResource.hpp>
 #include <Systems/System.hpp>
 #include <Utilities/Helpers.hpp>
 #include <Utilities/Singleton.hpp>
 
+class MeshAsset;
+
+struct TextureCacheStatistics
+{
+    uint32_t m_hits = 0;
+    uint32_t m_misses = 0; // Includes the entries whose texture was already released
+};
+
 class ResourceManager : public System, public Singleton<ResourceManager>
 {
 using DescriptorLayoutBindings = std::vector<VkDescriptorSetLayoutBinding>;
@@ -13,6 +22,7 @@ using DescriptorLayoutBindings = std::vector<VkDescriptorSetLayoutBinding>;
 public:
     virtual void Init() override;
     virtual void Terminate() override;
+    virtual void Update() override;
 
     VkDescriptorSetLayout GetDescriptorLayout(DescriptorLayoutBindings const& descriptorLayoutBindings);
     void AllocateDescriptorSet(DescriptorSetLayout const& layout, DescriptorSet& set);
@@ -20,8 +30,22 @@ public:
 
     VkShaderModule GetShaderModule(std::string const& fileName);
 
+    SharedPtr<MeshAsset> GetMeshAsset(std::string const& name);
+    void AddMeshAsset(std::string const& name, SharedPtr<MeshAsset> const& meshAsset);
+
+    // The source is a canonical path, or a content hash for data without a file of its own
+    static std::string GetTextureName(std::string const& source, VkFormat format, TextureSampler const& sampler);
+    SharedPtr<TextureResource> GetTexture(std::string const& name);
+    void AddTexture(std::string const& name, SharedPtr<TextureResource> const& texture);
+    TextureCacheStatistics const& GetTextureCacheStatistics() const { return m_textureCacheStatistics; }
+
     TextureResource const& GetEmptyTexture() const { return *m_emptyTexture; }
 
+    uint32_t AllocateBindlessTexture(VkDescriptorImageInfo const& imageInfo);
+    void FreeBindlessTexture(uint32_t index);
+    VkDescriptorSetLayout GetBindlessTextureLayout() const { return m_bindlessTextureLayout; }
+    VkDescriptorSet GetBindlessTextureSet() const { return m_bindlessTextureSet; }
+
 private:
     VkDescriptorSetLayout CreateDescriptorSetLayout(DescriptorLayoutBindings const& descriptorLayoutBindings);
     DescriptorPoolInstance& CreateDescriptorPool(DescriptorSetLayout const& layout);
@@ -31,13 +55,36 @@ private:
 
     void CreateEmptyTexture();
 
+    void CreateBindlessTextureSet();
+    void DestroyBindlessTextureSet();
+
 private:
     std::map<DescriptorLayoutBindings, VkDescriptorSetLayout> m_descriptorLayoutMap;
     std::multimap<VkDescriptorSetLayout, DescriptorPoolInstance> m_descriptorLayoutPoolMap;
 
     std::map<std::string, VkShaderModule> m_shaderModuleMap;
 
+    // Mesh assets are owned by the components using them, the cache only tracks the live ones
+    std::map<std::string, WeakPtr<MeshAsset>> m_meshAssetMap;
+
+    // Same for the textures loaded from files, so models sharing an image share its upload
+    std::map<std::string, WeakPtr<TextureResource>> m_textureMap;
+    TextureCacheStatistics m_textureCacheStatistics;
+
     UniquePtr<TextureResource> m_emptyTexture = nullptr;
 
+    // Every material texture lives in a single update after bind array indexed by the shaders
+    VkDescriptorSetLayout m_bindlessTextureLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_bindlessTexturePool = VK_NULL_HANDLE;
+    VkDescriptorSet m_bindlessTextureSet = VK_NULL_HANDLE;
+    uint32_t m_bindlessTextureCount = 0;
+    std::vector<uint32_t> m_bindlessFreeSlots;
+    ResourceInFlight<std::vector<uint32_t>> m_bindlessPendingFreeSlots;
+
+public:
+    static constexpr uint32_t ms_maxBindlessTextures = 16384;
+
+private:
+
     friend class Singleton<ResourceManager>;
 };
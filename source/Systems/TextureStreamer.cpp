@@ -0,0 +1,384 @@
+#include <Systems/TextureStreamer.hpp>
+
+#include <Components/StaticMeshComponent.hpp>
+#include <Resources/MeshAsset.hpp>
+#include <Systems/Renderer.hpp>
+
+static bool IsDeviceMemoryUnderPressure();
+static uint64_t AlignStagingSize(uint64_t size);
+
+void TextureStreamer::Init()
+{
+    Renderer& renderer = Renderer::GetInstance();
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = renderer.GetPhysicalDeviceInfo().m_graphicsQueueFamily.value();
+
+    if (vkCreateCommandPool(renderer.GetDevice(), &poolInfo, nullptr, &m_commandPool) != VK_SUCCESS)
+    {
+        ThrowError("Failed to create command pool.");
+    }
+
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = m_commandPool;
+    allocInfo.commandBufferCount = 1;
+
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    for (MipUpload& upload : m_uploads)
+    {
+        if (vkAllocateCommandBuffers(renderer.GetDevice(), &allocInfo, &upload.m_commandBuffer) != VK_SUCCESS ||
+            vkCreateFence(renderer.GetDevice(), &fenceInfo, nullptr, &upload.m_fence) != VK_SUCCESS)
+        {
+            ThrowError("Failed to create texture streaming command buffers.");
+        }
+    }
+}
+
+void TextureStreamer::Terminate()
+{
+    Log("Texture streaming: %.1f MB streamed in, %.1f MB evicted",
+        m_statistics.m_streamedInSize / (1024.0 * 1024.0), m_statistics.m_evictedSize / (1024.0 * 1024.0));
+
+    VkDevice const device = Renderer::GetInstance().GetDevice();
+    for (MipUpload& upload : m_uploads)
+    {
+        WaitForUpload(upload);
+        vkDestroyFence(device, upload.m_fence, nullptr);
+        upload.m_stagingBuffer.Destroy();
+        upload.m_stagingSize = 0;
+    }
+
+    vkDestroyCommandPool(device, m_commandPool, nullptr);
+    m_commandPool = VK_NULL_HANDLE;
+    m_textures.clear();
+}
+
+void TextureStreamer::Update()
+{
+    m_frame++;
+
+    // Submitted frames in flight ago, usually complete already
+    WaitForUpload(m_uploads.GetResource());
+
+    std::vector<MipChange> streamIns;
+    std::vector<MipChange> evictions;
+    uint64_t residentSize = 0;
+
+    for (auto it = m_textures.begin(); it != m_textures.end();)
+    {
+        SharedPtr<TextureResource> texture = it->second.m_texture.lock();
+        if (!texture)
+        {
+            it = m_textures.erase(it);
+            continue;
+        }
+
+        StreamedTexture& streamedTexture = it->second;
+        ++it;
+
+        uint8_t const firstMip = texture->GetFirstMip();
+        residentSize += streamedTexture.GetResidentSize(firstMip);
+
+        // The request of a texture unused for a while is stale, only its initial mips are needed
+        uint64_t const unusedFrames = m_frame - streamedTexture.m_lastRequestFrame;
+        uint8_t const neededMip = unusedFrames > ms_unusedFrames ? streamedTexture.m_initialMip : std::min(streamedTexture.m_requestedMip, streamedTexture.m_initialMip);
+
+        if (neededMip < firstMip)
+        {
+            streamIns.push_back({ texture, &streamedTexture, firstMip, static_cast<uint8_t>(firstMip - neededMip), unusedFrames });
+        }
+        else if (neededMip > firstMip)
+        {
+            uint64_t const evictedSize = streamedTexture.GetResidentSize(firstMip) - streamedTexture.GetResidentSize(neededMip);
+            evictions.push_back({ texture, &streamedTexture, neededMip, static_cast<uint8_t>(neededMip - firstMip), unusedFrames, evictedSize });
+        }
+    }
+
+    bool const isHeapUnderPressure = IsDeviceMemoryUnderPressure();
+
+    // Every reallocation copies the whole image, so a texture gets as many of its missing mips as the upload budget
+    // allows at once. The textures missing the most mips go first.
+    std::sort(streamIns.begin(), streamIns.end(), [](MipChange const& a, MipChange const& b) { return a.m_missingMips > b.m_missingMips; });
+
+    std::vector<MipChange> changes;
+    uint64_t uploadSize = 0;
+    uint64_t streamedInSize = 0;
+    for (MipChange& streamIn : streamIns)
+    {
+        if (isHeapUnderPressure || changes.size() >= ms_maxMipChangesPerFrame)
+        {
+            break;
+        }
+
+        // The smallest missing mips first, the first change of the frame always gets one
+        std::vector<uint64_t> const& mipSizes = streamIn.m_streamedTexture->m_data.m_mipSizes;
+        uint8_t const neededMip = streamIn.m_firstMip - streamIn.m_missingMips;
+        while (streamIn.m_firstMip > neededMip)
+        {
+            uint64_t const stagedSize = AlignStagingSize(mipSizes[streamIn.m_firstMip - 1]);
+            if (uploadSize + streamIn.m_stagedSize > 0 && uploadSize + streamIn.m_stagedSize + stagedSize > ms_uploadBudget)
+            {
+                break;
+            }
+
+            streamIn.m_firstMip--;
+            streamIn.m_size += mipSizes[streamIn.m_firstMip];
+            streamIn.m_stagedSize += stagedSize;
+        }
+
+        if (streamIn.m_stagedSize == 0)
+        {
+            continue;
+        }
+
+        changes.push_back(streamIn);
+        uploadSize += streamIn.m_stagedSize;
+        streamedInSize += streamIn.m_size;
+    }
+
+    // Surplus mips are released when the budget is exceeded or the device runs low on memory,
+    // those of the textures unused the longest first
+    std::sort(evictions.begin(), evictions.end(), [](MipChange const& a, MipChange const& b)
+    {
+        return std::tie(a.m_unusedFrames, a.m_missingMips) > std::tie(b.m_unusedFrames, b.m_missingMips);
+    });
+
+    uint64_t evictedSize = 0;
+    uint32_t evictionCount = 0;
+    for (MipChange const& eviction : evictions)
+    {
+        bool const isOverBudget = residentSize + streamedInSize > ms_memoryBudget;
+        if (evictionCount >= ms_maxMipChangesPerFrame || (!isOverBudget && (!isHeapUnderPressure || evictedSize >= ms_uploadBudget)))
+        {
+            break;
+        }
+
+        changes.push_back(eviction);
+        residentSize -= eviction.m_size;
+        evictedSize += eviction.m_size;
+        evictionCount++;
+    }
+
+    // Whatever still does not fit waits for memory to be released, starting with the lowest priority
+    while (residentSize + streamedInSize > ms_memoryBudget && !changes.empty())
+    {
+        auto const lastStreamIn = std::find_if(changes.rbegin(), changes.rend(), [](MipChange const& change) { return change.m_stagedSize > 0; });
+        if (lastStreamIn == changes.rend())
+        {
+            break;
+        }
+
+        uploadSize -= lastStreamIn->m_stagedSize;
+        streamedInSize -= lastStreamIn->m_size;
+        changes.erase(std::next(lastStreamIn).base());
+    }
+
+    m_statistics.m_streamedInSize += streamedInSize;
+    m_statistics.m_evictedSize += evictedSize;
+
+    ApplyMipChanges(changes, uploadSize);
+}
+
+SharedPtr<TextureResource> TextureStreamer::CreateTexture(TextureCreationInfo const& creationInfo, StreamedTextureData&& data)
+{
+    VkExtent2D const extent = ImageResource::GetExtent(creationInfo.m_imageCreateInfo);
+    uint8_t const mipLevels = data.m_mipOffsets.size();
+
+    uint8_t initialMip = 0;
+    while (initialMip + 1 < mipLevels && std::max(extent.width, extent.height) >> initialMip > ms_residentExtent)
+    {
+        initialMip++;
+    }
+
+    // The data of the initial mips is at the end, their offsets are relative to the first of them
+    std::vector<uint64_t> mipOffsets;
+    mipOffsets.reserve(mipLevels - initialMip);
+    for (uint8_t mip = initialMip; mip < mipLevels; mip++)
+    {
+        mipOffsets.push_back(data.m_mipOffsets[mip] - data.m_mipOffsets[initialMip]);
+    }
+
+    TextureCreationInfo textureInfo = creationInfo;
+    textureInfo.m_imageCreateInfo.m_mipLevels = mipLevels;
+    textureInfo.m_data = data.m_data.data() + data.m_mipOffsets[initialMip];
+    textureInfo.m_dataSize = data.m_data.size() - data.m_mipOffsets[initialMip];
+    textureInfo.m_mipOffsets = mipOffsets.data();
+    textureInfo.m_firstMip = initialMip;
+
+    SharedPtr<TextureResource> texture = std::make_shared<TextureResource>(textureInfo);
+    if (initialMip == 0)
+    {
+        // Small enough to always be resident
+        return texture;
+    }
+
+    StreamedTexture& streamedTexture = m_textures[texture.get()];
+    streamedTexture.m_texture = texture;
+    streamedTexture.m_data = std::move(data);
+    streamedTexture.m_initialMip = initialMip;
+    streamedTexture.m_requestedMip = initialMip;
+    streamedTexture.m_lastRequestFrame = m_frame;
+
+    return texture;
+}
+
+void TextureStreamer::RequestMips(Primitive const& primitive, float projectedScale)
+{
+    Material const* material = primitive.m_material.get();
+    if (!material || m_textures.empty())
+    {
+        return;
+    }
+
+    RequestMip(material->m_baseColorTexture.get(), material->m_baseColorTextCoordSet, primitive, projectedScale);
+    RequestMip(material->m_metallicRoughnessTexture.get(), material->m_metallicRoughnessTextCoordSet, primitive, projectedScale);
+    RequestMip(material->m_normalTexture.get(), material->m_normalTextCoordSet, primitive, projectedScale);
+    RequestMip(material->m_occlusionTexture.get(), material->m_occlusionTextCoordSet, primitive, projectedScale);
+    RequestMip(material->m_emissiveTexture.get(), material->m_emissiveTextCoordSet, primitive, projectedScale);
+}
+
+void TextureStreamer::RequestMip(TextureResource const* texture, uint8_t uvSet, Primitive const& primitive, float projectedScale)
+{
+    auto const foundIt = m_textures.find(texture);
+    float const uvDensity = primitive.m_uvDensity[std::min<uint8_t>(uvSet, primitive.m_uvDensity.size() - 1)];
+    if (foundIt == m_textures.end() || uvDensity <= 0.0f)
+    {
+        return;
+    }
+
+    ImageCreateInfo const& imageCreateInfo = texture->GetImageCreationInfo();
+    VkExtent2D const extent = ImageResource::GetExtent(imageCreateInfo);
+
+    // Texels of the largest mip per pixel, each mip halves them
+    float const texelsPerPixel = std::max(extent.width, extent.height) / (uvDensity * projectedScale);
+    uint8_t const mip = static_cast<uint8_t>(std::clamp(std::floor(std::log2(texelsPerPixel)), 0.0f, static_cast<float>(imageCreateInfo.m_mipLevels - 1)));
+
+    // The largest mip requested by any primitive this frame
+    StreamedTexture& streamedTexture = foundIt->second;
+    if (streamedTexture.m_lastRequestFrame != m_frame)
+    {
+        streamedTexture.m_requestedMip = mip;
+        streamedTexture.m_lastRequestFrame = m_frame;
+    }
+    else
+    {
+        streamedTexture.m_requestedMip = std::min(streamedTexture.m_requestedMip, mip);
+    }
+}
+
+void TextureStreamer::WaitForUpload(MipUpload& upload)
+{
+    VkDevice const device = Renderer::GetInstance().GetDevice();
+    if (upload.m_isPending)
+    {
+        vkWaitForFences(device, 1, &upload.m_fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(device, 1, &upload.m_fence);
+        upload.m_isPending = false;
+    }
+
+    // The fence also covers the frames submitted before the upload, the last ones sampling the replaced images
+    upload.m_retiredImages.clear();
+}
+
+void TextureStreamer::ApplyMipChanges(std::vector<MipChange> const& changes, uint64_t uploadSize)
+{
+    if (changes.empty())
+    {
+        return;
+    }
+
+    Renderer& renderer = Renderer::GetInstance();
+    MipUpload& upload = m_uploads.GetResource();
+
+    if (uploadSize > upload.m_stagingSize)
+    {
+        BufferInfo bufferInfo;
+        bufferInfo.m_size = uploadSize;
+        bufferInfo.m_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        bufferInfo.m_memoryUsage = VMA_MEMORY_USAGE_CPU_ONLY;
+        upload.m_stagingBuffer = Buffer(bufferInfo);
+        upload.m_stagingSize = uploadSize;
+    }
+
+    uint8_t* stagingMemory = uploadSize > 0 ? static_cast<uint8_t*>(upload.m_stagingBuffer.MapMemory()) : nullptr;
+    uint64_t stagingOffset = 0;
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VkCommandBuffer commandBuffer = upload.m_commandBuffer;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    for (MipChange const& change : changes)
+    {
+        // Only the mips the current image does not hold are staged
+        StreamedTextureData const& data = change.m_streamedTexture->m_data;
+        std::vector<uint64_t> bufferOffsets;
+        for (uint8_t mip = change.m_firstMip; mip < change.m_texture->GetFirstMip(); mip++)
+        {
+            memcpy(stagingMemory + stagingOffset, data.m_data.data() + data.m_mipOffsets[mip], data.m_mipSizes[mip]);
+            bufferOffsets.push_back(stagingOffset);
+            stagingOffset += AlignStagingSize(data.m_mipSizes[mip]);
+        }
+
+        upload.m_retiredImages.push_back(change.m_texture->RecordFirstMipChange(change.m_firstMip, upload.m_stagingBuffer, bufferOffsets, commandBuffer));
+    }
+
+    if (stagingMemory != nullptr)
+    {
+        upload.m_stagingBuffer.UnmapMemory();
+    }
+
+    vkEndCommandBuffer(commandBuffer);
+
+    // Not waited for, the barriers of the copies order them before the next frames sampling the textures
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    if (vkQueueSubmit(renderer.GetGraphicsQueue(), 1, &submitInfo, upload.m_fence) != VK_SUCCESS)
+    {
+        ThrowError("Failed to submit texture mip changes.");
+    }
+
+    upload.m_isPending = true;
+}
+
+uint64_t TextureStreamer::StreamedTexture::GetResidentSize(uint8_t firstMip) const
+{
+    return std::accumulate(m_data.m_mipSizes.begin() + firstMip, m_data.m_mipSizes.end(), uint64_t(0));
+}
+
+static bool IsDeviceMemoryUnderPressure()
+{
+    Renderer const& renderer = Renderer::GetInstance();
+    VkPhysicalDeviceMemoryProperties const& memoryProperties = renderer.GetPhysicalDeviceInfo().m_memoryProperties;
+
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets = {};
+    vmaGetHeapBudgets(renderer.GetAllocator(), budgets.data());
+
+    for (uint32_t heap = 0; heap < memoryProperties.memoryHeapCount; heap++)
+    {
+        bool const isDeviceLocal = (memoryProperties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        if (isDeviceLocal && budgets[heap].usage > budgets[heap].budget * TextureStreamer::ms_heapPressure)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static uint64_t AlignStagingSize(uint64_t size)
+{
+    // Keeps every staged mip aligned to the texel block of any format
+    return (size + 15) & ~uint64_t(15);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <Resources/Buffer.hpp>
+#include <Resources/ImageResource.hpp>
+#include <Resources/ResourceInFlight.hpp>
+#include <Resources/TextureResource.hpp>
+#include <Systems/System.hpp>
+#include <Utilities/Helpers.hpp>
+#include <Utilities/Singleton.hpp>
+
+struct Primitive;
+
+// Every mip of a streamed texture kept on the CPU, largest first. The data of a mip and the ones below it is contiguous.
+struct StreamedTextureData
+{
+    std::vector<uint8_t> m_data;
+    std::vector<uint64_t> m_mipOffsets;
+    std::vector<uint64_t> m_mipSizes;
+};
+
+struct TextureStreamingStatistics
+{
+    uint64_t m_streamedInSize = 0;
+    uint64_t m_evictedSize = 0;
+};
+
+// Keeps the largest mips of the material textures resident only while they are visible at that size on screen.
+// A texture starts with its small mips, the others are uploaded as the meshes using it request them and evicted
+// under memory pressure. The image of a texture is reallocated to hold exactly its resident mips, the copies are
+// submitted without waiting and their staging memory is reused once the fence of the submit is signaled.
+class TextureStreamer : public System, public Singleton<TextureStreamer>
+{
+public:
+    virtual void Init() override;
+    virtual void Terminate() override;
+    virtual void Update() override;
+
+    // Creates the texture with the mips no larger than ms_residentExtent, the data is kept to stream in the others
+    SharedPtr<TextureResource> CreateTexture(TextureCreationInfo const& creationInfo, StreamedTextureData&& data);
+    // Requests the mips the textures of the primitive need when one object space unit covers projectedScale pixels
+    void RequestMips(Primitive const& primitive, float projectedScale);
+
+    TextureStreamingStatistics const& GetStatistics() const { return m_statistics; }
+
+private:
+    struct StreamedTexture
+    {
+        WeakPtr<TextureResource> m_texture;
+        StreamedTextureData m_data;
+        uint8_t m_initialMip = 0; // Never evicted
+        uint8_t m_requestedMip = UINT8_MAX; // Largest mip of the latest request
+        uint64_t m_lastRequestFrame = 0;
+
+        uint64_t GetResidentSize(uint8_t firstMip) const;
+    };
+
+    // A texture whose image is reallocated this frame, with every mip between its current and new first mip added or removed
+    struct MipChange
+    {
+        SharedPtr<TextureResource> m_texture;
+        StreamedTexture* m_streamedTexture = nullptr;
+        uint8_t m_firstMip = 0;
+        uint8_t m_missingMips = 0; // Gap to the needed mip, the priority of the change
+        uint64_t m_unusedFrames = 0; // Frames since the last request
+        uint64_t m_size = 0; // Bytes of the mips added or removed
+        uint64_t m_stagedSize = 0; // Bytes of staging memory of the mips added
+    };
+
+    // Mip changes recorded in a frame, waited for when the frame comes around again
+    struct MipUpload
+    {
+        VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
+        VkFence m_fence = VK_NULL_HANDLE;
+        bool m_isPending = false;
+
+        Buffer m_stagingBuffer;
+        uint64_t m_stagingSize = 0;
+
+        // Images replaced by the mip changes, released once the fence also covers the frames sampling them
+        std::vector<SharedPtr<ImageResource>> m_retiredImages;
+    };
+
+    void RequestMip(TextureResource const* texture, uint8_t uvSet, Primitive const& primitive, float projectedScale);
+    void WaitForUpload(MipUpload& upload);
+    void ApplyMipChanges(std::vector<MipChange> const& changes, uint64_t uploadSize);
+
+private:
+    std::unordered_map<TextureResource const*, StreamedTexture> m_textures;
+    uint64_t m_frame = 0;
+
+    VkCommandPool m_commandPool = VK_NULL_HANDLE;
+    ResourceInFlight<MipUpload> m_uploads;
+
+    TextureStreamingStatistics m_statistics;
+
+public:
+    static constexpr uint32_t ms_residentExtent = 64; // Largest extent of the mips that are always resident
+    static constexpr uint64_t ms_uploadBudget = 16 * 1024 * 1024; // Bytes streamed in per frame
+    static constexpr uint32_t ms_maxMipChangesPerFrame = 8; // Images reallocated per frame, for stream ins and for evictions each
+    static constexpr uint64_t ms_memoryBudget = 512 * 1024 * 1024; // Bytes of resident streamed textures
+    static constexpr float ms_heapPressure = 0.9f; // Fraction of a device local heap budget above which mips are evicted
+    static constexpr uint64_t ms_unusedFrames = 120; // Frames without a request before the largest mips are released
+
+private:
+
+    friend class Singleton<TextureStreamer>;
+};
@@ -25,3 +25,15 @@ std::string ReadFile(std::string const& fileName)
 
     return buffer;
 }
+
+uint64_t HashBytes(void const* data, size_t size, uint64_t hash)
+{
+    uint8_t const* bytes = static_cast<uint8_t const*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
@@ -93,6 +93,9 @@ std::string ReadShaderFile(std::string const& shaderName);
 
 std::string ReadFile(std::string const& fileName);
 
+// FNV-1a, chain calls by passing the previous hash
+uint64_t HashBytes(void const* data, size_t size, uint64_t hash = 14695981039346656037ull);
+
 // Reverse iterator
 template<typename Iterator>
 class Range
@@ -0,0 +1,241 @@
+#include <Utilities/Ktx2.hpp>
+
+#include <Utilities/Helpers.hpp>
+
+static constexpr uint8_t s_ktx2Identifier[] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+static constexpr size_t s_ktx2LevelIndexOffset = 80; // After the supercompression global data range
+
+// Fixed part of the file up to the supercompression data, right after the identifier. Every field is little endian.
+struct Ktx2FileHeader
+{
+    uint32_t m_vkFormat;
+    uint32_t m_typeSize;
+    uint32_t m_pixelWidth;
+    uint32_t m_pixelHeight;
+    uint32_t m_pixelDepth;
+    uint32_t m_layerCount;
+    uint32_t m_faceCount;
+    uint32_t m_levelCount;
+    uint32_t m_supercompressionScheme;
+    uint32_t m_dfdByteOffset;
+    uint32_t m_dfdByteLength;
+    uint32_t m_kvdByteOffset;
+    uint32_t m_kvdByteLength;
+};
+
+struct Ktx2FileLevel
+{
+    uint64_t m_byteOffset;
+    uint64_t m_byteLength;
+    uint64_t m_uncompressedByteLength;
+};
+
+static_assert(sizeof(Ktx2FileHeader) == 52, "KTX2 header must match the file layout");
+static_assert(sizeof(Ktx2FileLevel) == 24, "KTX2 level index must match the file layout");
+
+static bool GetFormatBlock(VkFormat format, uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockSize);
+
+bool IsKtx2(void const* data, size_t size)
+{
+    return size >= sizeof(s_ktx2Identifier) && memcmp(data, s_ktx2Identifier, sizeof(s_ktx2Identifier)) == 0;
+}
+
+bool ParseKtx2(void const* data, size_t size, Ktx2Header& header)
+{
+    uint8_t const* bytes = static_cast<uint8_t const*>(data);
+    if (!IsKtx2(data, size) || size < s_ktx2LevelIndexOffset)
+    {
+        Warn("Not a KTX2 file.");
+        return false;
+    }
+
+    Ktx2FileHeader fileHeader;
+    memcpy(&fileHeader, bytes + sizeof(s_ktx2Identifier), sizeof(Ktx2FileHeader));
+
+    if (fileHeader.m_vkFormat == VK_FORMAT_UNDEFINED || fileHeader.m_supercompressionScheme != 0)
+    {
+        Warn("KTX2 file is supercompressed or Basis Universal, transcoding is not supported.");
+        return false;
+    }
+
+    if (fileHeader.m_pixelDepth > 1 || fileHeader.m_pixelHeight == 0)
+    {
+        Warn("KTX2 file is not a 2D texture.");
+        return false;
+    }
+
+    if (fileHeader.m_faceCount != 1 && fileHeader.m_faceCount != 6)
+    {
+        Warn("KTX2 file has an invalid face count: %u.", fileHeader.m_faceCount);
+        return false;
+    }
+
+    uint32_t blockWidth = 1;
+    uint32_t blockHeight = 1;
+    uint32_t blockSize = 0;
+    if (!GetFormatBlock(static_cast<VkFormat>(fileHeader.m_vkFormat), blockWidth, blockHeight, blockSize))
+    {
+        Warn("KTX2 file has an unsupported format: %u.", fileHeader.m_vkFormat);
+        return false;
+    }
+
+    // A level count of zero asks for mips generated at load, which compressed formats can't blit
+    uint32_t const levelCount = std::max(fileHeader.m_levelCount, 1u);
+    uint32_t const layers = std::max(fileHeader.m_layerCount, 1u) * fileHeader.m_faceCount;
+    if (levelCount > UINT8_MAX || layers > UINT8_MAX || size < s_ktx2LevelIndexOffset + levelCount * sizeof(Ktx2FileLevel))
+    {
+        Warn("KTX2 file has an invalid level index.");
+        return false;
+    }
+
+    header.m_format = static_cast<VkFormat>(fileHeader.m_vkFormat);
+    header.m_width = fileHeader.m_pixelWidth;
+    header.m_height = fileHeader.m_pixelHeight;
+    header.m_layers = layers;
+    header.m_isCube = fileHeader.m_faceCount == 6;
+    header.m_levels.resize(levelCount);
+
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        Ktx2FileLevel fileLevel;
+        memcpy(&fileLevel, bytes + s_ktx2LevelIndexOffset + level * sizeof(Ktx2FileLevel), sizeof(Ktx2FileLevel));
+
+        if (fileLevel.m_byteLength == 0 || fileLevel.m_byteOffset > size || fileLevel.m_byteLength > size - fileLevel.m_byteOffset)
+        {
+            Warn("KTX2 level %u is out of the file.", level);
+            return false;
+        }
+
+        // The upload copies this many bytes, a shorter level would be read past its end
+        uint64_t const width = level < 32 ? std::max(fileHeader.m_pixelWidth >> level, 1u) : 1;
+        uint64_t const height = level < 32 ? std::max(fileHeader.m_pixelHeight >> level, 1u) : 1;
+        uint64_t const levelSize = (width + blockWidth - 1) / blockWidth * ((height + blockHeight - 1) / blockHeight) * blockSize * layers;
+        if (fileLevel.m_byteLength < levelSize)
+        {
+            Warn("KTX2 level %u is truncated, it holds %llu bytes instead of %llu.", level,
+                static_cast<unsigned long long>(fileLevel.m_byteLength), static_cast<unsigned long long>(levelSize));
+            return false;
+        }
+
+        header.m_levels[level] = { fileLevel.m_byteOffset, fileLevel.m_byteLength };
+    }
+
+    return true;
+}
+
+bool WriteKtx2(std::string const& filePath, VkFormat format, uint32_t width, uint32_t height, std::vector<std::vector<uint8_t>> const& levels, std::vector<uint32_t> const& dataFormatDescriptor)
+{
+    uint32_t const dfdTotalSize = static_cast<uint32_t>((dataFormatDescriptor.size() + 1) * sizeof(uint32_t));
+    uint64_t const dfdOffset = s_ktx2LevelIndexOffset + levels.size() * sizeof(Ktx2FileLevel);
+
+    // Smallest mip first as the specification asks, aligned to the 16 bytes of a block
+    std::vector<Ktx2FileLevel> levelIndex(levels.size());
+    uint64_t offset = dfdOffset + dfdTotalSize;
+    for (size_t level = levels.size(); level-- > 0;)
+    {
+        offset = (offset + 15) & ~15ull;
+        levelIndex[level] = { offset, levels[level].size(), levels[level].size() };
+        offset += levels[level].size();
+    }
+
+    Ktx2FileHeader fileHeader = {};
+    fileHeader.m_vkFormat = format;
+    fileHeader.m_typeSize = 1;
+    fileHeader.m_pixelWidth = width;
+    fileHeader.m_pixelHeight = height;
+    fileHeader.m_faceCount = 1;
+    fileHeader.m_levelCount = static_cast<uint32_t>(levels.size());
+    fileHeader.m_dfdByteOffset = static_cast<uint32_t>(dfdOffset);
+    fileHeader.m_dfdByteLength = dfdTotalSize;
+    uint64_t const supercompressionData[2] = { 0, 0 };
+
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        Warn("Failed to write KTX2 file: %s.", filePath.c_str());
+        return false;
+    }
+
+    file.write(reinterpret_cast<char const*>(s_ktx2Identifier), sizeof(s_ktx2Identifier));
+    file.write(reinterpret_cast<char const*>(&fileHeader), sizeof(Ktx2FileHeader));
+    file.write(reinterpret_cast<char const*>(supercompressionData), sizeof(supercompressionData));
+    file.write(reinterpret_cast<char const*>(levelIndex.data()), levelIndex.size() * sizeof(Ktx2FileLevel));
+    file.write(reinterpret_cast<char const*>(&dfdTotalSize), sizeof(dfdTotalSize));
+    file.write(reinterpret_cast<char const*>(dataFormatDescriptor.data()), dataFormatDescriptor.size() * sizeof(uint32_t));
+
+    uint64_t position = dfdOffset + dfdTotalSize;
+    for (size_t level = levels.size(); level-- > 0;)
+    {
+        static constexpr char s_padding[16] = {};
+        file.write(s_padding, levelIndex[level].m_byteOffset - position);
+        file.write(reinterpret_cast<char const*>(levels[level].data()), levels[level].size());
+        position = levelIndex[level].m_byteOffset + levels[level].size();
+    }
+
+    return file.good();
+}
+
+static bool GetFormatBlock(VkFormat format, uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockSize)
+{
+    blockWidth = 1;
+    blockHeight = 1;
+
+    switch (format)
+    {
+    case VK_FORMAT_R8_UNORM: blockSize = 1; return true;
+    case VK_FORMAT_R8G8_UNORM:
+    case VK_FORMAT_R16_SFLOAT: blockSize = 2; return true;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+    case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+    case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+    case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+    case VK_FORMAT_R16G16_SFLOAT:
+    case VK_FORMAT_R32_SFLOAT: blockSize = 4; return true;
+    case VK_FORMAT_R16G16B16A16_UNORM:
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+    case VK_FORMAT_R32G32_SFLOAT: blockSize = 8; return true;
+    case VK_FORMAT_R32G32B32A32_SFLOAT: blockSize = 16; return true;
+    default: break;
+    }
+
+    // BC1 and BC4 blocks are half the size of the others
+    if (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK)
+    {
+        bool const isHalfBlock = format <= VK_FORMAT_BC1_RGBA_SRGB_BLOCK || format == VK_FORMAT_BC4_UNORM_BLOCK || format == VK_FORMAT_BC4_SNORM_BLOCK;
+        blockWidth = 4;
+        blockHeight = 4;
+        blockSize = isHalfBlock ? 8 : 16;
+        return true;
+    }
+
+    // ETC2 RGB, RGB with punch through alpha and EAC R11 blocks are half the size of the others
+    if (format >= VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK)
+    {
+        bool const isHalfBlock = format <= VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK || format == VK_FORMAT_EAC_R11_UNORM_BLOCK || format == VK_FORMAT_EAC_R11_SNORM_BLOCK;
+        blockWidth = 4;
+        blockHeight = 4;
+        blockSize = isHalfBlock ? 8 : 16;
+        return true;
+    }
+
+    // Every ASTC block is 16 bytes, the UNORM and sRGB variants of a block extent follow each other
+    if (format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK)
+    {
+        static constexpr uint8_t s_astcBlockExtents[][2] =
+        {
+            { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 },
+            { 8, 8 }, { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+        };
+
+        uint8_t const* extent = s_astcBlockExtents[(format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2];
+        blockWidth = extent[0];
+        blockHeight = extent[1];
+        blockSize = 16;
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+// Byte range of a mip in the file, holding every layer and face of it
+struct Ktx2Level
+{
+    uint64_t m_offset = 0;
+    uint64_t m_size = 0;
+};
+
+// Header and level index of a KTX2 container, see the Khronos KTX 2.0 specification.
+// The texel data is not copied, levels are uploaded straight from the file contents.
+struct Ktx2Header
+{
+    VkFormat m_format = VK_FORMAT_UNDEFINED;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_layers = 1; // Array layers times faces
+    bool m_isCube = false;
+    std::vector<Ktx2Level> m_levels; // Largest mip first
+};
+
+bool IsKtx2(void const* data, size_t size);
+// Returns false with a warning when the file is malformed or needs transcoding: supercompressed, Basis Universal or 3D
+bool ParseKtx2(void const* data, size_t size, Ktx2Header& header);
+// Single layer 2D texture of a block compressed format. Levels hold the data of each mip, largest first.
+// The descriptor holds the blocks of the data format descriptor, its total size is written in front of them.
+bool WriteKtx2(std::string const& filePath, VkFormat format, uint32_t width, uint32_t height, std::vector<std::vector<uint8_t>> const& levels, std::vector<uint32_t> const& dataFormatDescriptor);
@@ -0,0 +1,288 @@
+#include <Utilities/MeshOptimizer.hpp>
+
+VertexCacheStatistics AnalyzeVertexCache(std::vector<uint32_t> const& indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    VertexCacheStatistics statistics;
+    statistics.m_triangles = indices.size() / 3;
+
+    // A vertex is in the cache while fewer than cacheSize misses happened since it was loaded
+    std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+    std::vector<uint8_t> isReferenced(vertexCount, 0);
+    uint32_t timestamp = cacheSize + 1;
+
+    for (uint32_t const index : indices)
+    {
+        if (timestamp - cacheTimestamps[index] > cacheSize)
+        {
+            cacheTimestamps[index] = timestamp++;
+            statistics.m_transformedVertices++;
+        }
+
+        if (!isReferenced[index])
+        {
+            isReferenced[index] = 1;
+            statistics.m_vertices++;
+        }
+    }
+
+    return statistics;
+}
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, std::vector<uint32_t>* clusters, uint32_t cacheSize)
+{
+    uint32_t const triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Triangles adjacent to each vertex, live counts are the ones not emitted yet
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (uint32_t const index : indices)
+    {
+        liveTriangles[index]++;
+    }
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    std::partial_sum(liveTriangles.begin(), liveTriangles.end(), adjacencyOffsets.begin() + 1);
+
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            adjacency[adjacencyFill[indices[3 * triangle + c]]++] = triangle;
+        }
+    }
+
+    std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+    std::vector<uint8_t> isEmitted(triangleCount, 0);
+    std::vector<uint32_t> deadEndStack;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    uint32_t timestamp = cacheSize + 1;
+    uint32_t cursor = 0;
+
+    if (clusters)
+    {
+        clusters->assign(1, 0);
+    }
+
+    // Restarts from the most recent vertex with live triangles, then from the next one in input order
+    auto const skipDeadEnd = [&]() -> uint32_t
+    {
+        while (!deadEndStack.empty())
+        {
+            uint32_t const vertex = deadEndStack.back();
+            deadEndStack.pop_back();
+            if (liveTriangles[vertex] > 0)
+            {
+                return vertex;
+            }
+        }
+
+        for (; cursor < vertexCount; cursor++)
+        {
+            if (liveTriangles[cursor] > 0)
+            {
+                return cursor;
+            }
+        }
+
+        return UINT32_MAX;
+    };
+
+    uint32_t fanningVertex = indices[0];
+
+    while (fanningVertex != UINT32_MAX)
+    {
+        candidates.clear();
+
+        // Emit every live triangle around the fanning vertex
+        for (uint32_t a = adjacencyOffsets[fanningVertex]; a < adjacencyOffsets[fanningVertex + 1]; a++)
+        {
+            uint32_t const triangle = adjacency[a];
+            if (isEmitted[triangle])
+            {
+                continue;
+            }
+
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                uint32_t const vertex = indices[3 * triangle + c];
+                output.push_back(vertex);
+                deadEndStack.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+
+                if (timestamp - cacheTimestamps[vertex] > cacheSize)
+                {
+                    cacheTimestamps[vertex] = timestamp++;
+                }
+            }
+
+            isEmitted[triangle] = 1;
+        }
+
+        // Continue from the candidate that stays in the cache the longest while its triangles are emitted
+        uint32_t nextVertex = UINT32_MAX;
+        int32_t bestPriority = -1;
+        for (uint32_t const vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+            {
+                continue;
+            }
+
+            int32_t priority = 0;
+            if (timestamp - cacheTimestamps[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+            {
+                priority = timestamp - cacheTimestamps[vertex];
+            }
+
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                nextVertex = vertex;
+            }
+        }
+
+        if (nextVertex == UINT32_MAX)
+        {
+            nextVertex = skipDeadEnd();
+        }
+
+        // The cache restarts after a dead end or when no candidate is cached, the order across these boundaries is free
+        if (clusters && nextVertex != UINT32_MAX && bestPriority <= 0)
+        {
+            clusters->push_back(output.size() / 3);
+        }
+
+        fanningVertex = nextVertex;
+    }
+
+    indices = std::move(output);
+}
+
+void OptimizeVertexCacheRange(std::vector<uint32_t>& indices, uint32_t firstIndex, uint32_t indexCount, uint32_t cacheSize)
+{
+    auto const indexBegin = indices.begin() + firstIndex;
+    auto const indexEnd = indexBegin + indexCount;
+
+    std::vector<uint32_t> vertices(indexBegin, indexEnd);
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+    std::vector<uint32_t> localIndices;
+    localIndices.reserve(indexCount);
+    for (auto it = indexBegin; it != indexEnd; it++)
+    {
+        localIndices.push_back(std::lower_bound(vertices.begin(), vertices.end(), *it) - vertices.begin());
+    }
+
+    OptimizeVertexCache(localIndices, vertices.size(), nullptr, cacheSize);
+    std::transform(localIndices.begin(), localIndices.end(), indexBegin, [&vertices](uint32_t index) { return vertices[index]; });
+}
+
+std::vector<uint32_t> OptimizeOverdraw(std::vector<uint32_t>& indices, std::vector<glm::vec3> const& positions, std::vector<uint32_t> const& clusters)
+{
+    std::vector<uint32_t> clusterOrder(clusters.size());
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+
+    uint32_t const triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || clusters.size() <= 1)
+    {
+        return clusterOrder;
+    }
+
+    // Area weighted centroid of the mesh
+    glm::vec3 meshCentroid = glm::vec3(0.0f);
+    float meshArea = 0.0f;
+    for (uint32_t i = 0; i < indices.size(); i += 3)
+    {
+        glm::vec3 const& p0 = positions[indices[i]];
+        glm::vec3 const& p1 = positions[indices[i + 1]];
+        glm::vec3 const& p2 = positions[indices[i + 2]];
+        float const area = glm::length(glm::cross(p1 - p0, p2 - p0));
+        meshCentroid += area * (p0 + p1 + p2) / 3.0f;
+        meshArea += area;
+    }
+
+    if (meshArea > 0.0f)
+    {
+        meshCentroid /= meshArea;
+    }
+
+    // Clusters facing away from the center are likely to occlude the others
+    std::vector<float> sortKeys(clusters.size());
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        uint32_t const lastTriangle = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+        glm::vec3 centroid = glm::vec3(0.0f);
+        glm::vec3 normal = glm::vec3(0.0f);
+        float area = 0.0f;
+        for (uint32_t triangle = clusters[c]; triangle < lastTriangle; triangle++)
+        {
+            glm::vec3 const& p0 = positions[indices[3 * triangle]];
+            glm::vec3 const& p1 = positions[indices[3 * triangle + 1]];
+            glm::vec3 const& p2 = positions[indices[3 * triangle + 2]];
+            glm::vec3 const triangleNormal = glm::cross(p1 - p0, p2 - p0);
+            float const triangleArea = glm::length(triangleNormal);
+            centroid += triangleArea * (p0 + p1 + p2) / 3.0f;
+            normal += triangleNormal;
+            area += triangleArea;
+        }
+
+        if (area > 0.0f)
+        {
+            centroid /= area;
+        }
+
+        float const normalLength = glm::length(normal);
+        sortKeys[c] = normalLength > 0.0f ? glm::dot(centroid - meshCentroid, normal / normalLength) : 0.0f;
+    }
+
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (uint32_t const c : clusterOrder)
+    {
+        uint32_t const lastTriangle = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+        output.insert(output.end(), indices.begin() + 3 * clusters[c], indices.begin() + 3 * lastTriangle);
+    }
+
+    indices = std::move(output);
+    return clusterOrder;
+}
+
+std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount)
+{
+    std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+    uint32_t nextVertex = 0;
+
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == UINT32_MAX)
+        {
+            remap[index] = nextVertex++;
+        }
+
+        index = remap[index];
+    }
+
+    // Unreferenced vertices are kept after the referenced ones
+    for (uint32_t& newIndex : remap)
+    {
+        if (newIndex == UINT32_MAX)
+        {
+            newIndex = nextVertex++;
+        }
+    }
+
+    return remap;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// Post-transform vertex cache behaviour of an index buffer, simulated with a FIFO cache
+struct VertexCacheStatistics
+{
+    uint32_t m_transformedVertices = 0;
+    uint32_t m_triangles = 0;
+    uint32_t m_vertices = 0;
+
+    float GetAcmr() const { return m_triangles > 0 ? static_cast<float>(m_transformedVertices) / m_triangles : 0.0f; } // Average cache miss ratio, per triangle
+    float GetAtvr() const { return m_vertices > 0 ? static_cast<float>(m_transformedVertices) / m_vertices : 0.0f; } // Average transformed vertex ratio, 1 is optimal
+};
+
+VertexCacheStatistics AnalyzeVertexCache(std::vector<uint32_t> const& indices, uint32_t vertexCount, uint32_t cacheSize = 16);
+
+// Reorders triangles for the post-transform vertex cache (Tipsify, Sander et al. 2007).
+// Optionally returns the first triangle of every cluster, clusters start where the traversal restarts with a cold cache.
+void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, std::vector<uint32_t>* clusters = nullptr, uint32_t cacheSize = 16);
+
+// Same as OptimizeVertexCache on a range of indices only, its vertices are compacted so the cost depends on the range alone
+void OptimizeVertexCacheRange(std::vector<uint32_t>& indices, uint32_t firstIndex, uint32_t indexCount, uint32_t cacheSize = 16);
+
+// Reorders the clusters of a vertex cache optimized index buffer so that outer facing ones are drawn first.
+// Clusters are given by their first triangle, returns the clusters in their new order.
+std::vector<uint32_t> OptimizeOverdraw(std::vector<uint32_t>& indices, std::vector<glm::vec3> const& positions, std::vector<uint32_t> const& clusters);
+
+// Renumbers vertices in the order they are first referenced, returns the new index of every vertex
+std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount);
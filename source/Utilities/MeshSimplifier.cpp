@@ -0,0 +1,255 @@
+#include <Utilities/MeshSimplifier.hpp>
+
+struct Collapse
+{
+    uint32_t m_from;
+    uint32_t m_to;
+    float m_cost;
+};
+
+// Area weighted plane quadric of a triangle
+static glm::dmat4 ComputeTriangleQuadric(glm::vec3 const& p0, glm::vec3 const& p1, glm::vec3 const& p2)
+{
+    glm::dvec3 const normal = glm::cross(glm::dvec3(p1 - p0), glm::dvec3(p2 - p0));
+    double const doubleArea = glm::length(normal);
+    if (doubleArea <= 0.0)
+    {
+        return glm::dmat4(0.0);
+    }
+
+    glm::dvec4 const plane = glm::dvec4(normal / doubleArea, -glm::dot(normal / doubleArea, glm::dvec3(p0)));
+    return glm::outerProduct(plane, plane) * (0.5 * doubleArea);
+}
+
+static double EvaluateQuadric(glm::dmat4 const& quadric, glm::vec3 const& position)
+{
+    glm::dvec4 const point = glm::dvec4(glm::dvec3(position), 1.0);
+    return std::max(glm::dot(point, quadric * point), 0.0);
+}
+
+// Rejects collapses that fold a remaining triangle over
+static bool CollapseFlipsTriangles(Collapse const& collapse, std::vector<uint32_t> const& triangles, std::vector<uint32_t> const& indices, std::vector<glm::vec3> const& positions)
+{
+    for (uint32_t const triangle : triangles)
+    {
+        uint32_t const* corners = &indices[3 * triangle];
+        if (corners[0] == collapse.m_to || corners[1] == collapse.m_to || corners[2] == collapse.m_to)
+        {
+            // Removed by the collapse
+            continue;
+        }
+
+        std::array<glm::vec3, 3> before = { positions[corners[0]], positions[corners[1]], positions[corners[2]] };
+        std::array<glm::vec3, 3> after = before;
+        for (size_t i = 0; i < 3; i++)
+        {
+            if (corners[i] == collapse.m_from)
+            {
+                after[i] = positions[collapse.m_to];
+            }
+        }
+
+        glm::vec3 const normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+        glm::vec3 const normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+        if (glm::dot(normalBefore, normalAfter) <= 0.25f * glm::length(normalBefore) * glm::length(normalAfter))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+float SimplifyMesh(std::vector<uint32_t>& destination, std::vector<uint32_t> const& indices,
+    std::vector<glm::vec3> const& positions, std::vector<glm::vec3> const& normals,
+    size_t targetIndexCount, float targetError)
+{
+    size_t const vertexCount = positions.size();
+    destination = indices;
+
+    // Vertices sharing a position are the same point of the surface
+    std::map<std::array<float, 3>, uint32_t> positionMap;
+    std::vector<uint32_t> positionRemap(vertexCount);
+    for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+    {
+        std::array<float, 3> const key = { positions[vertex].x, positions[vertex].y, positions[vertex].z };
+        positionRemap[vertex] = positionMap.try_emplace(key, vertex).first->second;
+    }
+
+    // Lock seams, a position referenced through several vertices has discontinuous attributes
+    std::vector<uint8_t> isLocked(vertexCount, 0);
+    std::vector<uint32_t> wedgeCount(vertexCount, 0);
+    std::vector<uint8_t> isReferenced(vertexCount, 0);
+    for (uint32_t const index : indices)
+    {
+        if (!isReferenced[index])
+        {
+            isReferenced[index] = 1;
+            wedgeCount[positionRemap[index]]++;
+        }
+    }
+
+    // Lock borders, an edge without its opposite half edge is open
+    std::unordered_map<uint64_t, uint32_t> halfEdges;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        for (size_t e = 0; e < 3; e++)
+        {
+            uint64_t const from = positionRemap[indices[i + e]];
+            uint64_t const to = positionRemap[indices[i + (e + 1) % 3]];
+            halfEdges[(from << 32) | to]++;
+        }
+    }
+
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        for (size_t e = 0; e < 3; e++)
+        {
+            uint64_t const from = positionRemap[indices[i + e]];
+            uint64_t const to = positionRemap[indices[i + (e + 1) % 3]];
+            if (halfEdges.find((to << 32) | from) == halfEdges.end())
+            {
+                isLocked[from] = 1;
+                isLocked[to] = 1;
+            }
+        }
+    }
+
+    for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+    {
+        uint32_t const position = positionRemap[vertex];
+        isLocked[vertex] = isLocked[position] || wedgeCount[position] > 1;
+    }
+
+    // Quadrics live on positions so every vertex of a seam accumulates the same surface
+    std::vector<glm::dmat4> quadrics(vertexCount, glm::dmat4(0.0));
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        glm::dmat4 const quadric = ComputeTriangleQuadric(positions[indices[i]], positions[indices[i + 1]], positions[indices[i + 2]]);
+        for (size_t c = 0; c < 3; c++)
+        {
+            quadrics[positionRemap[indices[i + c]]] += quadric;
+        }
+    }
+
+    double const maxCost = static_cast<double>(targetError) * targetError;
+    double resultCost = 0.0;
+
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint8_t> isTouched(vertexCount);
+    std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+    std::vector<Collapse> collapses;
+
+    while (destination.size() > targetIndexCount)
+    {
+        size_t const triangleCount = destination.size() / 3;
+
+        for (std::vector<uint32_t>& triangles : vertexTriangles)
+        {
+            triangles.clear();
+        }
+
+        for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+        {
+            for (size_t c = 0; c < 3; c++)
+            {
+                vertexTriangles[destination[3 * triangle + c]].push_back(triangle);
+            }
+        }
+
+        // Every edge can be collapsed in both directions unless the vertex to remove is locked
+        collapses.clear();
+        for (size_t i = 0; i < destination.size(); i += 3)
+        {
+            for (size_t e = 0; e < 3; e++)
+            {
+                uint32_t const v0 = destination[i + e];
+                uint32_t const v1 = destination[i + (e + 1) % 3];
+
+                for (auto const& [from, to] : { std::make_pair(v0, v1), std::make_pair(v1, v0) })
+                {
+                    if (isLocked[from])
+                    {
+                        continue;
+                    }
+
+                    glm::dmat4 const quadric = quadrics[positionRemap[from]] + quadrics[positionRemap[to]];
+                    double cost = EvaluateQuadric(quadric, positions[to]);
+
+                    // Normals are not interpolated across the collapsed edge, penalize the deviation over its length
+                    glm::vec3 const edge = positions[to] - positions[from];
+                    cost += (1.0 - glm::dot(normals[from], normals[to])) * glm::dot(edge, edge);
+
+                    collapses.push_back({ from, to, static_cast<float>(cost) });
+                }
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](Collapse const& a, Collapse const& b) { return a.m_cost < b.m_cost; });
+
+        // Apply the cheapest independent collapses, each removes two triangles on a manifold
+        std::iota(remap.begin(), remap.end(), 0);
+        std::fill(isTouched.begin(), isTouched.end(), 0);
+
+        size_t const collapsesNeeded = (destination.size() - targetIndexCount) / 6 + 1;
+        size_t appliedCollapses = 0;
+
+        for (Collapse const& collapse : collapses)
+        {
+            if (collapse.m_cost > maxCost || appliedCollapses >= collapsesNeeded)
+            {
+                break;
+            }
+
+            if (isTouched[collapse.m_from] || isTouched[collapse.m_to])
+            {
+                continue;
+            }
+
+            if (CollapseFlipsTriangles(collapse, vertexTriangles[collapse.m_from], destination, positions))
+            {
+                continue;
+            }
+
+            remap[collapse.m_from] = collapse.m_to;
+            quadrics[positionRemap[collapse.m_to]] += quadrics[positionRemap[collapse.m_from]];
+            resultCost = std::max(resultCost, static_cast<double>(collapse.m_cost));
+
+            // The neighbourhood of the collapse changed, its other candidates are stale for this pass
+            for (uint32_t const triangle : vertexTriangles[collapse.m_from])
+            {
+                for (size_t c = 0; c < 3; c++)
+                {
+                    isTouched[destination[3 * triangle + c]] = 1;
+                }
+            }
+
+            appliedCollapses++;
+        }
+
+        if (appliedCollapses == 0)
+        {
+            break;
+        }
+
+        // Remap and drop the triangles that became degenerate
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < destination.size(); i += 3)
+        {
+            uint32_t const v0 = remap[destination[i]];
+            uint32_t const v1 = remap[destination[i + 1]];
+            uint32_t const v2 = remap[destination[i + 2]];
+
+            if (v0 != v1 && v1 != v2 && v0 != v2)
+            {
+                destination[writeIndex++] = v0;
+                destination[writeIndex++] = v1;
+                destination[writeIndex++] = v2;
+            }
+        }
+
+        destination.resize(writeIndex);
+    }
+
+    return static_cast<float>(std::sqrt(resultCost));
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// Quadric error metric edge collapse simplification.
+// Vertices are never moved, a collapse merges a vertex into one of its neighbours, so the simplified
+// indices still reference the original vertices and can be stored as another range of the same index buffer.
+// Vertices on borders and on attribute seams (several vertices sharing a position) are locked.
+// Returns the object space error of the simplified indices.
+float SimplifyMesh(std::vector<uint32_t>& destination, std::vector<uint32_t> const& indices,
+    std::vector<glm::vec3> const& positions, std::vector<glm::vec3> const& normals,
+    size_t targetIndexCount, float targetError);
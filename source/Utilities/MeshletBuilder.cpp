@@ -0,0 +1,207 @@
+#include <Utilities/MeshletBuilder.hpp>
+
+static void ComputeMeshletBounds(Meshlet& meshlet, std::vector<uint32_t> const& indices, std::vector<glm::vec3> const& positions)
+{
+    uint32_t const lastIndex = meshlet.m_firstIndex + meshlet.m_indexCount;
+
+    glm::vec3 minimum = positions[indices[meshlet.m_firstIndex]];
+    glm::vec3 maximum = minimum;
+    for (uint32_t i = meshlet.m_firstIndex; i < lastIndex; i++)
+    {
+        minimum = glm::min(minimum, positions[indices[i]]);
+        maximum = glm::max(maximum, positions[indices[i]]);
+    }
+
+    meshlet.m_center = 0.5f * (minimum + maximum);
+    meshlet.m_radius = 0.0f;
+    for (uint32_t i = meshlet.m_firstIndex; i < lastIndex; i++)
+    {
+        meshlet.m_radius = std::max(meshlet.m_radius, glm::distance(meshlet.m_center, positions[indices[i]]));
+    }
+
+    // The cone axis is the average of the triangle normals, its cutoff is given by the widest one
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshlet.m_indexCount / 3);
+    glm::vec3 axis = glm::vec3(0.0f);
+    for (uint32_t i = meshlet.m_firstIndex; i < lastIndex; i += 3)
+    {
+        glm::vec3 const& p0 = positions[indices[i]];
+        glm::vec3 const normal = glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0);
+        float const length = glm::length(normal);
+        if (length > 0.0f)
+        {
+            normals.push_back(normal / length);
+            axis += normals.back();
+        }
+    }
+
+    meshlet.m_coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    meshlet.m_coneCutoff = 1.0f;
+
+    float const axisLength = glm::length(axis);
+    if (normals.empty() || axisLength <= 0.0f)
+    {
+        return;
+    }
+
+    axis /= axisLength;
+    float minDot = 1.0f;
+    for (glm::vec3 const& normal : normals)
+    {
+        minDot = std::min(minDot, glm::dot(axis, normal));
+    }
+
+    // Cones wider than a hemisphere can always be seen
+    if (minDot <= 0.1f)
+    {
+        return;
+    }
+
+    meshlet.m_coneAxis = axis;
+    meshlet.m_coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+std::vector<Meshlet> BuildMeshlets(std::vector<uint32_t>& indices, std::vector<glm::vec3> const& positions,
+    uint32_t maxVertices, uint32_t maxTriangles)
+{
+    std::vector<Meshlet> meshlets;
+    uint32_t const triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return meshlets;
+    }
+
+    // Triangles adjacent to each vertex
+    std::vector<uint32_t> adjacencyOffsets(positions.size() + 1, 0);
+    for (uint32_t const index : indices)
+    {
+        adjacencyOffsets[index + 1]++;
+    }
+    std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            adjacency[adjacencyFill[indices[3 * triangle + c]]++] = triangle;
+        }
+    }
+
+    std::vector<uint32_t> orderedIndices;
+    orderedIndices.reserve(indices.size());
+    std::vector<uint8_t> isEmitted(triangleCount, 0);
+    std::vector<uint32_t> vertexMeshlet(positions.size(), UINT32_MAX); // Last meshlet that used each vertex
+    std::vector<uint32_t> meshletVertices;
+    meshletVertices.reserve(maxVertices);
+
+    uint32_t nextSeed = 0;
+    uint32_t emittedCount = 0;
+
+    while (emittedCount < triangleCount)
+    {
+        Meshlet meshlet = {};
+        meshlet.m_firstIndex = orderedIndices.size();
+        uint32_t const meshletId = meshlets.size();
+        meshletVertices.clear();
+
+        while (nextSeed < triangleCount && isEmitted[nextSeed])
+        {
+            nextSeed++;
+        }
+
+        uint32_t triangle = nextSeed;
+
+        while (triangle != UINT32_MAX)
+        {
+            isEmitted[triangle] = 1;
+            emittedCount++;
+
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                uint32_t const vertex = indices[3 * triangle + c];
+                orderedIndices.push_back(vertex);
+                if (vertexMeshlet[vertex] != meshletId)
+                {
+                    vertexMeshlet[vertex] = meshletId;
+                    meshletVertices.push_back(vertex);
+                }
+            }
+            meshlet.m_indexCount += 3;
+
+            if (meshlet.m_indexCount / 3 >= maxTriangles)
+            {
+                break;
+            }
+
+            // Grow with the neighbour that adds the fewest new vertices
+            triangle = UINT32_MAX;
+            uint32_t bestNewVertices = 3;
+            for (uint32_t const vertex : meshletVertices)
+            {
+                for (uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; a++)
+                {
+                    uint32_t const candidate = adjacency[a];
+                    if (isEmitted[candidate])
+                    {
+                        continue;
+                    }
+
+                    uint32_t newVertices = 0;
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        newVertices += vertexMeshlet[indices[3 * candidate + c]] != meshletId;
+                    }
+
+                    if (newVertices < bestNewVertices && meshletVertices.size() + newVertices <= maxVertices)
+                    {
+                        triangle = candidate;
+                        bestNewVertices = newVertices;
+                    }
+                }
+
+                if (bestNewVertices == 0)
+                {
+                    break;
+                }
+            }
+        }
+
+        meshlets.push_back(meshlet);
+    }
+
+    indices = std::move(orderedIndices);
+
+    for (Meshlet& meshlet : meshlets)
+    {
+        ComputeMeshletBounds(meshlet, indices, positions);
+    }
+
+    return meshlets;
+}
+
+bool IsMeshletCulled(Meshlet const& meshlet, glm::mat4 const& worldMatrix, float worldScale,
+    std::array<glm::vec4, 6> const& frustumPlanes, glm::vec3 const& cameraPosition)
+{
+    glm::vec3 const center = glm::vec3(worldMatrix * glm::vec4(meshlet.m_center, 1.0f));
+    float const radius = meshlet.m_radius * worldScale;
+
+    for (glm::vec4 const& plane : frustumPlanes)
+    {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+        {
+            return true;
+        }
+    }
+
+    if (meshlet.m_coneCutoff >= 1.0f)
+    {
+        return false;
+    }
+
+    // Every triangle faces away when the camera is outside the cone of view directions that can see them
+    glm::vec3 const axis = glm::normalize(glm::mat3(worldMatrix) * meshlet.m_coneAxis);
+    glm::vec3 const toCenter = center - cameraPosition;
+    return glm::dot(toCenter, axis) >= meshlet.m_coneCutoff * glm::length(toCenter) + radius;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// Cluster of triangles stored as a contiguous range of the index buffer
+struct Meshlet
+{
+    uint32_t m_firstIndex = 0;
+    uint32_t m_indexCount = 0;
+    // Bounding sphere
+    glm::vec3 m_center = glm::vec3(0.0f);
+    float m_radius = 0.0f;
+    // Normal cone, sine of the cone half angle, the cluster is never back facing when it is 1
+    glm::vec3 m_coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    float m_coneCutoff = 1.0f;
+};
+
+// Reorders the triangles of indices so that each meshlet is a contiguous range of them.
+// Triangles are grown from their neighbours to keep meshlets compact, which keeps their bounds and cones tight.
+std::vector<Meshlet> BuildMeshlets(std::vector<uint32_t>& indices, std::vector<glm::vec3> const& positions,
+    uint32_t maxVertices = 64, uint32_t maxTriangles = 124);
+
+// Whether a meshlet placed with worldMatrix is outside the frustum or faces away from the camera
+bool IsMeshletCulled(Meshlet const& meshlet, glm::mat4 const& worldMatrix, float worldScale,
+    std::array<glm::vec4, 6> const& frustumPlanes, glm::vec3 const& cameraPosition);
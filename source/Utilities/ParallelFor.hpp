@@ -0,0 +1,48 @@
+#pragma once
+
+// Runs the function for every index on the calling thread plus threadCount - 1 workers, taking indices in order.
+// The first exception stops the remaining indices and is rethrown on the calling thread once the workers are joined.
+inline void ParallelFor(uint32_t threadCount, uint32_t count, std::function<void(uint32_t)> const& function)
+{
+    std::atomic<uint32_t> next = 0;
+    std::exception_ptr exception;
+    std::mutex exceptionMutex;
+    auto const worker = [&]()
+    {
+        for (uint32_t i = next++; i < count; i = next++)
+        {
+            try
+            {
+                function(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> const lock(exceptionMutex);
+                if (!exception)
+                {
+                    exception = std::current_exception();
+                }
+                next = count;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount > 0 ? threadCount - 1 : 0);
+    for (uint32_t t = 1; t < threadCount; t++)
+    {
+        threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
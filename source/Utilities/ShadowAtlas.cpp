@@ -0,0 +1,99 @@
+#include <Utilities/ShadowAtlas.hpp>
+
+#include <Utilities/Helpers.hpp>
+
+ShadowAtlas::ShadowAtlas(uint32_t size, uint32_t minTileSize)
+    : m_size(std::bit_ceil(size))
+    , m_minTileSize(std::min(std::bit_ceil(minTileSize), m_size))
+{
+    m_freeTiles.resize(GetLevel(m_minTileSize) + 1);
+    m_freeTiles[0].push_back({ 0, 0, m_size });
+}
+
+uint32_t ShadowAtlas::GetTileSize(uint32_t size) const
+{
+    return std::clamp(std::bit_ceil(std::max(size, 1u)), m_minTileSize, m_size);
+}
+
+ShadowAtlasTile ShadowAtlas::Allocate(uint32_t size)
+{
+    uint32_t const tileSize = GetTileSize(size);
+    uint32_t const level = GetLevel(tileSize);
+
+    // Smallest free tile that is large enough
+    int32_t freeLevel = level;
+    while (freeLevel >= 0 && m_freeTiles[freeLevel].empty())
+    {
+        freeLevel--;
+    }
+
+    if (freeLevel < 0)
+    {
+        return {};
+    }
+
+    ShadowAtlasTile tile = m_freeTiles[freeLevel].back();
+    m_freeTiles[freeLevel].pop_back();
+
+    // Split it down to the requested size, keeping the first quadrant each time
+    for (uint32_t l = freeLevel + 1; l <= level; l++)
+    {
+        uint32_t const childSize = tile.m_size / 2;
+        m_freeTiles[l].push_back({ tile.m_x + childSize, tile.m_y, childSize });
+        m_freeTiles[l].push_back({ tile.m_x, tile.m_y + childSize, childSize });
+        m_freeTiles[l].push_back({ tile.m_x + childSize, tile.m_y + childSize, childSize });
+        tile.m_size = childSize;
+    }
+
+    return tile;
+}
+
+void ShadowAtlas::Free(ShadowAtlasTile const& tile)
+{
+    if (!tile.IsValid())
+    {
+        return;
+    }
+
+    uint32_t const level = GetLevel(tile.m_size);
+    std::vector<ShadowAtlasTile>& freeTiles = m_freeTiles[level];
+
+    if (level > 0)
+    {
+        // Tiles are aligned to their size, so the parent starts at the rounded down position
+        uint32_t const parentSize = tile.m_size * 2;
+        ShadowAtlasTile const parent = { tile.m_x & ~(parentSize - 1), tile.m_y & ~(parentSize - 1), parentSize };
+
+        std::array<size_t, 3> siblings;
+        uint32_t siblingCount = 0;
+        for (size_t i = 0; i < freeTiles.size() && siblingCount < siblings.size(); i++)
+        {
+            ShadowAtlasTile const& other = freeTiles[i];
+            if ((other.m_x & ~(parentSize - 1)) == parent.m_x && (other.m_y & ~(parentSize - 1)) == parent.m_y)
+            {
+                siblings[siblingCount++] = i;
+            }
+        }
+
+        if (siblingCount == siblings.size())
+        {
+            // Erase from the back so the remaining indices stay valid
+            std::sort(siblings.rbegin(), siblings.rend());
+            for (size_t i : siblings)
+            {
+                freeTiles[i] = freeTiles.back();
+                freeTiles.pop_back();
+            }
+
+            Free(parent);
+            return;
+        }
+    }
+
+    freeTiles.push_back(tile);
+}
+
+uint32_t ShadowAtlas::GetLevel(uint32_t tileSize) const
+{
+    return std::countr_zero(m_size) - std::countr_zero(tileSize);
+}
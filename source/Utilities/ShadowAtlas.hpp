@@ -0,0 +1,36 @@
+#pragma once
+
+// Square region of the shadow atlas, in texels
+struct ShadowAtlasTile
+{
+    uint32_t m_x = 0;
+    uint32_t m_y = 0;
+    uint32_t m_size = 0;
+
+    bool IsValid() const { return m_size > 0; }
+    bool operator==(ShadowAtlasTile const& other) const = default;
+};
+
+// Quadtree buddy allocator of power of two tiles in a square atlas.
+// Freed tiles merge back with their three siblings so large tiles become available again.
+class ShadowAtlas
+{
+public:
+    ShadowAtlas(uint32_t size, uint32_t minTileSize);
+
+    // Returns an invalid tile when no region of the rounded up size is free
+    ShadowAtlasTile Allocate(uint32_t size);
+    void Free(ShadowAtlasTile const& tile);
+
+    uint32_t GetSize() const { return m_size; }
+    uint32_t GetMinTileSize() const { return m_minTileSize; }
+    uint32_t GetTileSize(uint32_t size) const;
+
+private:
+    uint32_t GetLevel(uint32_t tileSize) const;
+
+private:
+    uint32_t m_size = 0;
+    uint32_t m_minTileSize = 0;
+    std::vector<std::vector<ShadowAtlasTile>> m_freeTiles; // Per level, level 0 is the whole atlas
+};
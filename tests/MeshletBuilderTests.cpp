@@ -0,0 +1,159 @@
+#include <ProceduralMeshes.hpp>
+#include <Utilities/MeshletBuilder.hpp>
+
+static uint32_t s_failureCount = 0;
+
+template<typename ... Args>
+static void Check(bool condition, char const* const format, Args ... args)
+{
+    if (!condition)
+    {
+        s_failureCount++;
+        std::fprintf(stderr, "[Failure] ");
+        std::fprintf(stderr, format, args ...);
+        std::fprintf(stderr, "\n");
+    }
+}
+
+static std::vector<std::array<uint32_t, 3>> GetSortedTriangles(std::vector<uint32_t> const& indices);
+static void CheckMeshlets(ProceduralMesh const& mesh, uint32_t maxVertices, uint32_t maxTriangles);
+
+// Checks the invariants of BuildMeshlets on meshes of different shapes and triangle orders
+int main()
+{
+    std::vector<ProceduralMesh> meshes;
+    meshes.push_back(MakeGridMesh(1));
+    meshes.push_back(MakeGridMesh(64));
+    meshes.push_back(MakeTorusMesh(48, 24));
+    meshes.push_back(MakeFanMesh(300));
+    meshes.push_back(ShuffleTriangles(MakeGridMesh(64)));
+    meshes.push_back(ShuffleTriangles(MakeTorusMesh(48, 24)));
+
+    // A triangle that is repeated and one without area
+    ProceduralMesh degenerate = MakeGridMesh(4);
+    degenerate.m_name = "grid with degenerate triangles";
+    degenerate.m_indices.insert(degenerate.m_indices.end(), { 0, 1, 6, 0, 1, 6, 2, 2, 3 });
+    meshes.push_back(degenerate);
+
+    for (ProceduralMesh const& mesh : meshes)
+    {
+        CheckMeshlets(mesh, 64, 124);
+        CheckMeshlets(mesh, 16, 8);
+        CheckMeshlets(mesh, 3, 1);
+    }
+
+    if (s_failureCount > 0)
+    {
+        std::fprintf(stderr, "%u checks failed\n", s_failureCount);
+        return EXIT_FAILURE;
+    }
+
+    std::printf("All meshlet checks passed on %zu meshes\n", meshes.size());
+    return EXIT_SUCCESS;
+}
+
+static std::vector<std::array<uint32_t, 3>> GetSortedTriangles(std::vector<uint32_t> const& indices)
+{
+    // Rotated to start with the smallest index, which keeps the winding
+    std::vector<std::array<uint32_t, 3>> triangles;
+    triangles.reserve(indices.size() / 3);
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        std::array<uint32_t, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+static void CheckMeshlets(ProceduralMesh const& mesh, uint32_t maxVertices, uint32_t maxTriangles)
+{
+    char const* const name = mesh.m_name.c_str();
+    std::vector<uint32_t> indices = mesh.m_indices;
+    std::vector<Meshlet> const meshlets = BuildMeshlets(indices, mesh.m_positions, maxVertices, maxTriangles);
+
+    // Every triangle is in exactly one meshlet, with its winding
+    Check(GetSortedTriangles(indices) == GetSortedTriangles(mesh.m_indices), "%s: the triangles changed", name);
+
+    // Wide planes, only the cone can cull
+    std::array<glm::vec4, 6> frustumPlanes;
+    frustumPlanes.fill(glm::vec4(0.0f, 0.0f, 1.0f, 1e9f));
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> distribution(-4.0f, 4.0f);
+    std::vector<glm::vec3> cameraPositions(64);
+    for (glm::vec3& cameraPosition : cameraPositions)
+    {
+        cameraPosition = glm::vec3(distribution(random), distribution(random), distribution(random));
+    }
+
+    uint32_t nextIndex = 0;
+    for (size_t m = 0; m < meshlets.size(); m++)
+    {
+        Meshlet const& meshlet = meshlets[m];
+        uint32_t const lastIndex = meshlet.m_firstIndex + meshlet.m_indexCount;
+
+        // Contiguous ranges covering the index buffer
+        Check(meshlet.m_firstIndex == nextIndex, "%s: meshlet %zu starts at %u instead of %u", name, m, meshlet.m_firstIndex, nextIndex);
+        Check(meshlet.m_indexCount > 0 && meshlet.m_indexCount % 3 == 0, "%s: meshlet %zu has %u indices", name, m, meshlet.m_indexCount);
+        Check(lastIndex <= indices.size(), "%s: meshlet %zu ends past the indices", name, m);
+        nextIndex = lastIndex;
+        if (lastIndex > indices.size())
+        {
+            break;
+        }
+
+        std::vector<uint32_t> vertices(indices.begin() + meshlet.m_firstIndex, indices.begin() + lastIndex);
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+        Check(vertices.size() <= maxVertices, "%s: meshlet %zu has %zu vertices, more than %u", name, m, vertices.size(), maxVertices);
+        Check(meshlet.m_indexCount / 3 <= maxTriangles, "%s: meshlet %zu has %u triangles, more than %u", name, m, meshlet.m_indexCount / 3, maxTriangles);
+
+        // The bounding sphere contains every vertex
+        for (uint32_t const vertex : vertices)
+        {
+            float const distance = glm::distance(meshlet.m_center, mesh.m_positions[vertex]);
+            Check(distance <= meshlet.m_radius * 1.0001f + 1e-5f, "%s: meshlet %zu vertex %u is %f away, outside the radius %f", name, m, vertex, distance, meshlet.m_radius);
+        }
+
+        if (meshlet.m_coneCutoff >= 1.0f)
+        {
+            continue;
+        }
+
+        // Every triangle normal is in the cone
+        float const minDot = std::sqrt(1.0f - meshlet.m_coneCutoff * meshlet.m_coneCutoff);
+        for (uint32_t i = meshlet.m_firstIndex; i < lastIndex; i += 3)
+        {
+            glm::vec3 const& p0 = mesh.m_positions[indices[i]];
+            glm::vec3 const normal = glm::cross(mesh.m_positions[indices[i + 1]] - p0, mesh.m_positions[indices[i + 2]] - p0);
+            if (glm::length(normal) > 0.0f)
+            {
+                float const dot = glm::dot(meshlet.m_coneAxis, glm::normalize(normal));
+                Check(dot >= minDot - 1e-4f, "%s: meshlet %zu triangle %u is outside its normal cone", name, m, (i - meshlet.m_firstIndex) / 3);
+            }
+        }
+
+        // A cone culled meshlet has no triangle facing the camera
+        for (glm::vec3 const& cameraPosition : cameraPositions)
+        {
+            if (!IsMeshletCulled(meshlet, glm::mat4(1.0f), 1.0f, frustumPlanes, cameraPosition))
+            {
+                continue;
+            }
+
+            for (uint32_t i = meshlet.m_firstIndex; i < lastIndex; i += 3)
+            {
+                glm::vec3 const& p0 = mesh.m_positions[indices[i]];
+                glm::vec3 const normal = glm::cross(mesh.m_positions[indices[i + 1]] - p0, mesh.m_positions[indices[i + 2]] - p0);
+                Check(glm::dot(normal, cameraPosition - p0) <= 1e-4f * glm::length(normal), "%s: meshlet %zu is culled with triangle %u facing the camera",
+                    name, m, (i - meshlet.m_firstIndex) / 3);
+            }
+        }
+    }
+
+    Check(nextIndex == indices.size(), "%s: the meshlets cover %u of %zu indices", name, nextIndex, indices.size());
+}
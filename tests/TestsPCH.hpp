@@ -0,0 +1,24 @@
+#pragma once
+
+
+// Standard library
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+// External
+#define NOMINMAX
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
@@ -0,0 +1,110 @@
+#pragma once
+
+// Indexed triangle meshes generated in code, so the mesh tools can be measured and tested without assets
+struct ProceduralMesh
+{
+    std::string m_name;
+    std::vector<glm::vec3> m_positions;
+    std::vector<uint32_t> m_indices;
+};
+
+// Flat grid of quads split in two triangles, rows of vertices along x
+inline ProceduralMesh MakeGridMesh(uint32_t quadCount)
+{
+    ProceduralMesh mesh;
+    mesh.m_name = "grid " + std::to_string(quadCount);
+
+    uint32_t const rowSize = quadCount + 1;
+    for (uint32_t y = 0; y < rowSize; y++)
+    {
+        for (uint32_t x = 0; x < rowSize; x++)
+        {
+            mesh.m_positions.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.0f);
+        }
+    }
+
+    for (uint32_t y = 0; y < quadCount; y++)
+    {
+        for (uint32_t x = 0; x < quadCount; x++)
+        {
+            uint32_t const corner = y * rowSize + x;
+            mesh.m_indices.insert(mesh.m_indices.end(), { corner, corner + 1, corner + rowSize + 1 });
+            mesh.m_indices.insert(mesh.m_indices.end(), { corner, corner + rowSize + 1, corner + rowSize });
+        }
+    }
+
+    return mesh;
+}
+
+// Closed surface of revolution, wrapping around both parameters, with outward facing triangles
+inline ProceduralMesh MakeTorusMesh(uint32_t ringCount, uint32_t segmentCount, float radius = 1.0f, float tubeRadius = 0.25f)
+{
+    ProceduralMesh mesh;
+    mesh.m_name = "torus " + std::to_string(ringCount) + "x" + std::to_string(segmentCount);
+
+    for (uint32_t r = 0; r < ringCount; r++)
+    {
+        float const u = 2.0f * static_cast<float>(M_PI) * r / ringCount;
+        for (uint32_t s = 0; s < segmentCount; s++)
+        {
+            float const v = 2.0f * static_cast<float>(M_PI) * s / segmentCount;
+            float const distance = radius + tubeRadius * std::cos(v);
+            mesh.m_positions.emplace_back(distance * std::cos(u), distance * std::sin(u), tubeRadius * std::sin(v));
+        }
+    }
+
+    for (uint32_t r = 0; r < ringCount; r++)
+    {
+        for (uint32_t s = 0; s < segmentCount; s++)
+        {
+            uint32_t const v0 = r * segmentCount + s;
+            uint32_t const v1 = ((r + 1) % ringCount) * segmentCount + s;
+            uint32_t const v2 = ((r + 1) % ringCount) * segmentCount + (s + 1) % segmentCount;
+            uint32_t const v3 = r * segmentCount + (s + 1) % segmentCount;
+            mesh.m_indices.insert(mesh.m_indices.end(), { v0, v1, v2, v0, v2, v3 });
+        }
+    }
+
+    return mesh;
+}
+
+// Disc of triangles around a single vertex, its valence is the triangle count
+inline ProceduralMesh MakeFanMesh(uint32_t triangleCount)
+{
+    ProceduralMesh mesh;
+    mesh.m_name = "fan " + std::to_string(triangleCount);
+
+    mesh.m_positions.emplace_back(0.0f);
+    for (uint32_t t = 0; t < triangleCount; t++)
+    {
+        float const angle = 2.0f * static_cast<float>(M_PI) * t / triangleCount;
+        mesh.m_positions.emplace_back(std::cos(angle), std::sin(angle), 0.0f);
+    }
+
+    for (uint32_t t = 0; t < triangleCount; t++)
+    {
+        mesh.m_indices.insert(mesh.m_indices.end(), { 0u, t + 1, (t + 1) % triangleCount + 1 });
+    }
+
+    return mesh;
+}
+
+// Same triangles in a random order, the worst case for the vertex cache and for locality
+inline ProceduralMesh ShuffleTriangles(ProceduralMesh mesh, uint32_t seed = 1)
+{
+    uint32_t const triangleCount = mesh.m_indices.size() / 3;
+    std::vector<uint32_t> order(triangleCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+
+    std::vector<uint32_t> indices;
+    indices.reserve(mesh.m_indices.size());
+    for (uint32_t const triangle : order)
+    {
+        indices.insert(indices.end(), mesh.m_indices.begin() + 3 * triangle, mesh.m_indices.begin() + 3 * triangle + 3);
+    }
+
+    mesh.m_name += " shuffled";
+    mesh.m_indices = std::move(indices);
+    return mesh;
+}
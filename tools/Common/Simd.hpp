@@ -0,0 +1,66 @@
+#pragma once
+
+// Widest float vector the baker is compiled for: AVX, SSE or plain scalars
+#if defined(__AVX__)
+
+using SimdFloat = __m256;
+static constexpr uint32_t s_simdWidth = 8;
+
+inline SimdFloat SimdSet(float value) { return _mm256_set1_ps(value); }
+inline SimdFloat SimdLoad(float const* data) { return _mm256_loadu_ps(data); }
+inline void SimdStore(float* data, SimdFloat value) { _mm256_storeu_ps(data, value); }
+inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b) { return _mm256_add_ps(a, b); }
+inline SimdFloat SimdSub(SimdFloat a, SimdFloat b) { return _mm256_sub_ps(a, b); }
+inline SimdFloat SimdMul(SimdFloat a, SimdFloat b) { return _mm256_mul_ps(a, b); }
+inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b) { return _mm256_div_ps(a, b); }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b) { return _mm256_max_ps(a, b); }
+// Lanes of value where mask is positive, zero elsewhere
+inline SimdFloat SimdSelectPositive(SimdFloat mask, SimdFloat value) { return _mm256_and_ps(_mm256_cmp_ps(mask, _mm256_setzero_ps(), _CMP_GT_OQ), value); }
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+using SimdFloat = __m128;
+static constexpr uint32_t s_simdWidth = 4;
+
+inline SimdFloat SimdSet(float value) { return _mm_set1_ps(value); }
+inline SimdFloat SimdLoad(float const* data) { return _mm_loadu_ps(data); }
+inline void SimdStore(float* data, SimdFloat value) { _mm_storeu_ps(data, value); }
+inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b) { return _mm_add_ps(a, b); }
+inline SimdFloat SimdSub(SimdFloat a, SimdFloat b) { return _mm_sub_ps(a, b); }
+inline SimdFloat SimdMul(SimdFloat a, SimdFloat b) { return _mm_mul_ps(a, b); }
+inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b) { return _mm_div_ps(a, b); }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b) { return _mm_max_ps(a, b); }
+// Lanes of value where mask is positive, zero elsewhere
+inline SimdFloat SimdSelectPositive(SimdFloat mask, SimdFloat value) { return _mm_and_ps(_mm_cmpgt_ps(mask, _mm_setzero_ps()), value); }
+
+#else
+
+using SimdFloat = float;
+static constexpr uint32_t s_simdWidth = 1;
+
+inline SimdFloat SimdSet(float value) { return value; }
+inline SimdFloat SimdLoad(float const* data) { return *data; }
+inline void SimdStore(float* data, SimdFloat value) { *data = value; }
+inline SimdFloat SimdAdd(SimdFloat a, SimdFloat b) { return a + b; }
+inline SimdFloat SimdSub(SimdFloat a, SimdFloat b) { return a - b; }
+inline SimdFloat SimdMul(SimdFloat a, SimdFloat b) { return a * b; }
+inline SimdFloat SimdDiv(SimdFloat a, SimdFloat b) { return a / b; }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b) { return std::max(a, b); }
+inline SimdFloat SimdSelectPositive(SimdFloat mask, SimdFloat value) { return mask > 0.0f ? value : 0.0f; }
+
+#endif
+
+inline SimdFloat SimdMulAdd(SimdFloat a, SimdFloat b, SimdFloat c) { return SimdAdd(SimdMul(a, b), c); }
+
+inline float SimdSum(SimdFloat value)
+{
+    std::array<float, s_simdWidth> lanes;
+    SimdStore(lanes.data(), value);
+    return std::accumulate(lanes.begin(), lanes.end(), 0.0f);
+}
+
+// Rounds a count up to whole vectors
+inline uint32_t SimdPadCount(uint32_t count)
+{
+    return (count + s_simdWidth - 1) / s_simdWidth * s_simdWidth;
+}
@@ -0,0 +1,137 @@
+#include <CpuCubemap.hpp>
+
+CpuCubemap::CpuCubemap(uint32_t size, uint32_t mipLevels)
+    : m_size(size)
+    , m_mipLevels(mipLevels)
+{
+    m_mips.resize(mipLevels);
+    for (uint32_t mipLevel = 0; mipLevel < mipLevels; mipLevel++)
+    {
+        uint32_t const mipSize = GetSize(mipLevel);
+        m_mips[mipLevel].resize(6 * mipSize * mipSize, glm::vec4(0.0f));
+    }
+}
+
+glm::vec4& CpuCubemap::GetTexel(uint32_t mipLevel, uint32_t face, uint32_t x, uint32_t y)
+{
+    uint32_t const mipSize = GetSize(mipLevel);
+    return m_mips[mipLevel][(face * mipSize + y) * mipSize + x];
+}
+
+glm::vec4 const& CpuCubemap::GetTexel(uint32_t mipLevel, uint32_t face, uint32_t x, uint32_t y) const
+{
+    uint32_t const mipSize = GetSize(mipLevel);
+    return m_mips[mipLevel][(face * mipSize + y) * mipSize + x];
+}
+
+void CpuCubemap::GenerateMipmaps()
+{
+    for (uint32_t mipLevel = 1; mipLevel < m_mipLevels; mipLevel++)
+    {
+        uint32_t const sourceSize = GetSize(mipLevel - 1);
+        uint32_t const mipSize = GetSize(mipLevel);
+
+        for (uint32_t face = 0; face < 6; face++)
+        {
+            for (uint32_t y = 0; y < mipSize; y++)
+            {
+                for (uint32_t x = 0; x < mipSize; x++)
+                {
+                    uint32_t const x0 = std::min(x * 2, sourceSize - 1);
+                    uint32_t const x1 = std::min(x * 2 + 1, sourceSize - 1);
+                    uint32_t const y0 = std::min(y * 2, sourceSize - 1);
+                    uint32_t const y1 = std::min(y * 2 + 1, sourceSize - 1);
+
+                    GetTexel(mipLevel, face, x, y) = 0.25f * (GetTexel(mipLevel - 1, face, x0, y0) + GetTexel(mipLevel - 1, face, x1, y0)
+                        + GetTexel(mipLevel - 1, face, x0, y1) + GetTexel(mipLevel - 1, face, x1, y1));
+                }
+            }
+        }
+    }
+}
+
+glm::vec4 CpuCubemap::SampleLod(glm::vec3 const& direction, float lod) const
+{
+    lod = std::clamp(lod, 0.0f, static_cast<float>(m_mipLevels - 1));
+    uint32_t const lowerLevel = static_cast<uint32_t>(lod);
+    uint32_t const upperLevel = std::min(lowerLevel + 1, m_mipLevels - 1);
+    float const blend = lod - static_cast<float>(lowerLevel);
+
+    glm::vec4 const lower = SampleLevel(direction, lowerLevel);
+    if (blend <= 0.0f || upperLevel == lowerLevel)
+    {
+        return lower;
+    }
+
+    return glm::mix(lower, SampleLevel(direction, upperLevel), blend);
+}
+
+glm::vec4 CpuCubemap::SampleLevel(glm::vec3 const& direction, uint32_t mipLevel) const
+{
+    glm::vec3 const absolute = glm::abs(direction);
+
+    // Major axis selection, see the cube map image selection table of the Vulkan specification
+    uint32_t face = 0;
+    float sc = 0.0f;
+    float tc = 0.0f;
+    float ma = 0.0f;
+    if (absolute.x >= absolute.y && absolute.x >= absolute.z)
+    {
+        face = direction.x >= 0.0f ? 0 : 1;
+        sc = direction.x >= 0.0f ? -direction.z : direction.z;
+        tc = -direction.y;
+        ma = absolute.x;
+    }
+    else if (absolute.y >= absolute.z)
+    {
+        face = direction.y >= 0.0f ? 2 : 3;
+        sc = direction.x;
+        tc = direction.y >= 0.0f ? direction.z : -direction.z;
+        ma = absolute.y;
+    }
+    else
+    {
+        face = direction.z >= 0.0f ? 4 : 5;
+        sc = direction.z >= 0.0f ? direction.x : -direction.x;
+        tc = -direction.y;
+        ma = absolute.z;
+    }
+
+    uint32_t const mipSize = GetSize(mipLevel);
+    float const u = 0.5f * (sc / ma + 1.0f) * mipSize - 0.5f;
+    float const v = 0.5f * (tc / ma + 1.0f) * mipSize - 0.5f;
+
+    float const floorU = std::floor(u);
+    float const floorV = std::floor(v);
+    float const fracU = u - floorU;
+    float const fracV = v - floorV;
+
+    int32_t const maxCoordinate = static_cast<int32_t>(mipSize) - 1;
+    uint32_t const x0 = std::clamp(static_cast<int32_t>(floorU), 0, maxCoordinate);
+    uint32_t const x1 = std::clamp(static_cast<int32_t>(floorU) + 1, 0, maxCoordinate);
+    uint32_t const y0 = std::clamp(static_cast<int32_t>(floorV), 0, maxCoordinate);
+    uint32_t const y1 = std::clamp(static_cast<int32_t>(floorV) + 1, 0, maxCoordinate);
+
+    glm::vec4 const top = glm::mix(GetTexel(mipLevel, face, x0, y0), GetTexel(mipLevel, face, x1, y0), fracU);
+    glm::vec4 const bottom = glm::mix(GetTexel(mipLevel, face, x0, y1), GetTexel(mipLevel, face, x1, y1), fracU);
+    return glm::mix(top, bottom, fracV);
+}
+
+/*static*/ glm::vec3 CpuCubemap::GetDirection(uint32_t face, float x, float y, uint32_t faceSize)
+{
+    float const u = (x + 0.5f) / faceSize * 2.0f - 1.0f;
+    float const v = (y + 0.5f) / faceSize * 2.0f - 1.0f;
+
+    glm::vec3 direction;
+    switch (face)
+    {
+    case 0: direction = glm::vec3(1.0f, -v, -u); break;
+    case 1: direction = glm::vec3(-1.0f, -v, u); break;
+    case 2: direction = glm::vec3(u, 1.0f, v); break;
+    case 3: direction = glm::vec3(u, -1.0f, -v); break;
+    case 4: direction = glm::vec3(u, -v, 1.0f); break;
+    default: direction = glm::vec3(-u, -v, -1.0f); break;
+    }
+
+    return glm::normalize(direction);
+}
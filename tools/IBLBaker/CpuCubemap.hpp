@@ -0,0 +1,32 @@
+#pragma once
+
+// RGBA float cube with a full mip chain, sampled the way the GPU samples the engine's cubes
+class CpuCubemap
+{
+public:
+    CpuCubemap(uint32_t size, uint32_t mipLevels);
+
+    uint32_t GetSize(uint32_t mipLevel = 0) const { return std::max(m_size >> mipLevel, 1u); }
+    uint32_t GetMipLevels() const { return m_mipLevels; }
+
+    glm::vec4& GetTexel(uint32_t mipLevel, uint32_t face, uint32_t x, uint32_t y);
+    glm::vec4 const& GetTexel(uint32_t mipLevel, uint32_t face, uint32_t x, uint32_t y) const;
+    std::vector<glm::vec4> const& GetMip(uint32_t mipLevel) const { return m_mips[mipLevel]; }
+
+    // Box filters each mip from the previous one, like the blits of the engine
+    void GenerateMipmaps();
+
+    // Trilinear sample. Faces are clamped at their edges rather than filtered across.
+    glm::vec4 SampleLod(glm::vec3 const& direction, float lod) const;
+    glm::vec4 SampleLevel(glm::vec3 const& direction, uint32_t mipLevel) const;
+
+    // Direction through the texel of a face, following the Vulkan face selection rules
+    static glm::vec3 GetDirection(uint32_t face, float x, float y, uint32_t faceSize);
+
+    static uint32_t GetFullMipLevels(uint32_t size) { return std::bit_width(size); }
+
+private:
+    uint32_t m_size = 0;
+    uint32_t m_mipLevels = 0;
+    std::vector<std::vector<glm::vec4>> m_mips; // Faces one after the other, rows top to bottom
+};
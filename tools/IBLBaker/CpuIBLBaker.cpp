@@ -0,0 +1,449 @@
+#include <CpuIBLBaker.hpp>
+
+#include <Simd.hpp>
+#include <Utilities/Helpers.hpp>
+#include <Utilities/ParallelFor.hpp>
+
+static constexpr float s_pi = 3.1415926535897932384626433832795f;
+static constexpr float s_epsilon = 1.175495e-38f;
+
+// Tangent space samples in structure of arrays, padded to whole SIMD vectors
+struct SampleTable
+{
+    void Resize(uint32_t count);
+
+    uint32_t m_count = 0;
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_z;
+    std::vector<float> m_weights;
+    std::vector<float> m_lods;
+};
+
+static glm::vec2 Hammersley(uint32_t i, uint32_t count);
+static glm::vec3 ImportanceSampleGGX(glm::vec2 const& xi, float roughness);
+static float NormalDistributionFunction(float dotNH, float roughness);
+static void TransformSamples(SampleTable const& samples, glm::vec3 const& tangent, glm::vec3 const& bitangent, glm::vec3 const& normal, float scale, SampleTable& directions);
+static void EncodeTexel(glm::vec4 const& texel, VkFormat format, uint8_t* destination);
+
+BakedImage CpuIBLBaker::BakeBrdflut(BrdflutSettings const& settings) const
+{
+    uint32_t const resolution = settings.m_resolution;
+    uint32_t const sampleCount = settings.m_sampleCount;
+
+    BakedImage image;
+    image.m_layout = { settings.m_format, resolution, resolution, 1, 1 };
+    image.m_texels.resize(resolution * resolution);
+    image.m_sampleCount = static_cast<uint64_t>(resolution) * resolution * sampleCount;
+
+    // A row per roughness, the halfway vectors of a row are shared by its texels
+    ParallelFor(m_threadCount, resolution, [&](uint32_t y)
+    {
+        float const roughness = 1.0f - (y + 0.5f) / resolution;
+        float const k = (roughness * roughness) / 2.0f;
+
+        // Padding samples have a null halfway vector, which never passes the dotNL test
+        SampleTable halfways;
+        halfways.Resize(sampleCount);
+        for (uint32_t i = 0; i < sampleCount; i++)
+        {
+            glm::vec3 const halfway = ImportanceSampleGGX(Hammersley(i, sampleCount), roughness);
+            // The normal is +Z, so the tangent frame is (0, -1, 0), (1, 0, 0)
+            halfways.m_x[i] = halfway.y;
+            halfways.m_z[i] = halfway.z;
+        }
+
+        for (uint32_t x = 0; x < resolution; x++)
+        {
+            float const dotNV = (x + 0.5f) / resolution;
+            SimdFloat const viewX = SimdSet(std::sqrt(1.0f - dotNV * dotNV));
+            SimdFloat const viewZ = SimdSet(dotNV);
+            SimdFloat const one = SimdSet(1.0f);
+            SimdFloat const zero = SimdSet(0.0f);
+            SimdFloat const oneMinusK = SimdSet(1.0f - k);
+            SimdFloat const kVector = SimdSet(k);
+            SimdFloat const geometryView = SimdSet(dotNV / (dotNV * (1.0f - k) + k));
+
+            SimdFloat scale = zero;
+            SimdFloat bias = zero;
+            for (uint32_t i = 0; i < halfways.m_x.size(); i += s_simdWidth)
+            {
+                SimdFloat const halfwayX = SimdLoad(&halfways.m_x[i]);
+                SimdFloat const halfwayZ = SimdLoad(&halfways.m_z[i]);
+
+                SimdFloat const dotVHSigned = SimdMulAdd(viewX, halfwayX, SimdMul(viewZ, halfwayZ));
+                SimdFloat const lightZ = SimdSub(SimdMul(SimdAdd(dotVHSigned, dotVHSigned), halfwayZ), viewZ);
+
+                SimdFloat const dotNL = SimdMax(lightZ, zero);
+                SimdFloat const dotNH = SimdMax(halfwayZ, zero);
+                SimdFloat const dotVH = SimdMax(dotVHSigned, zero);
+
+                SimdFloat const geometryLight = SimdDiv(dotNL, SimdMulAdd(dotNL, oneMinusK, kVector));
+                SimdFloat const geometryVisibility = SimdDiv(SimdMul(SimdMul(geometryLight, geometryView), dotVH), SimdMul(dotNH, viewZ));
+
+                SimdFloat const t = SimdSub(one, dotVH);
+                SimdFloat const t2 = SimdMul(t, t);
+                SimdFloat const fresnel = SimdMul(SimdMul(t2, t2), t);
+
+                scale = SimdAdd(scale, SimdSelectPositive(lightZ, SimdMul(SimdSub(one, fresnel), geometryVisibility)));
+                bias = SimdAdd(bias, SimdSelectPositive(lightZ, SimdMul(fresnel, geometryVisibility)));
+            }
+
+            image.m_texels[y * resolution + x] = glm::vec4(SimdSum(scale) / sampleCount, SimdSum(bias) / sampleCount, 0.0f, 1.0f);
+        }
+    });
+
+    return image;
+}
+
+BakedImage CpuIBLBaker::BakeIrradiance(CpuCubemap const& environment, IrradianceSettings const& settings) const
+{
+    uint32_t const resolution = settings.m_resolution;
+    uint32_t const mipLevels = CpuCubemap::GetFullMipLevels(resolution);
+
+    // Same float stepping as the shader, so both take the same samples
+    float const deltaPhi = (2.0f * s_pi) / settings.m_phiSteps;
+    float const deltaTheta = (0.5f * s_pi) / settings.m_thetaSteps;
+
+    std::vector<glm::vec4> hemisphere;
+    for (float phi = 0.0f; phi < 2.0f * s_pi; phi += deltaPhi)
+    {
+        for (float theta = 0.0f; theta < 0.5f * s_pi; theta += deltaTheta)
+        {
+            hemisphere.emplace_back(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta), std::cos(theta) * std::sin(theta));
+        }
+    }
+
+    SampleTable samples;
+    samples.Resize(hemisphere.size());
+    for (uint32_t i = 0; i < hemisphere.size(); i++)
+    {
+        samples.m_x[i] = hemisphere[i].x;
+        samples.m_y[i] = hemisphere[i].y;
+        samples.m_z[i] = hemisphere[i].z;
+        samples.m_weights[i] = hemisphere[i].w;
+    }
+
+    BakedImage image;
+    image.m_layout = { settings.m_format, resolution, resolution, mipLevels, 6 };
+
+    uint64_t texelCount = 0;
+    for (uint32_t mipLevel = 0; mipLevel < mipLevels; mipLevel++)
+    {
+        uint32_t const mipSize = std::max(resolution >> mipLevel, 1u);
+        uint64_t const mipOffset = texelCount;
+        texelCount += 6 * mipSize * mipSize;
+        image.m_texels.resize(texelCount);
+
+        ParallelFor(m_threadCount, 6 * mipSize, [&](uint32_t row)
+        {
+            uint32_t const face = row / mipSize;
+            uint32_t const y = row % mipSize;
+
+            SampleTable directions;
+            for (uint32_t x = 0; x < mipSize; x++)
+            {
+                glm::vec3 const normal = CpuCubemap::GetDirection(face, x, y, mipSize);
+                glm::vec3 const right = glm::normalize(glm::cross(glm::vec3(0.0f, 1.0f, 0.0f), normal));
+                glm::vec3 const up = glm::cross(normal, right);
+                TransformSamples(samples, right, up, normal, 1.0f, directions);
+
+                // The shader samples the base level, compute shaders have no derivatives
+                glm::vec3 color(0.0f);
+                for (uint32_t i = 0; i < samples.m_count; i++)
+                {
+                    glm::vec3 const direction(directions.m_x[i], directions.m_y[i], directions.m_z[i]);
+                    color += glm::vec3(environment.SampleLevel(direction, 0)) * samples.m_weights[i];
+                }
+
+                image.m_texels[mipOffset + (face * mipSize + y) * mipSize + x] = glm::vec4(s_pi * color / static_cast<float>(samples.m_count), 1.0f);
+            }
+        });
+    }
+
+    image.m_sampleCount = texelCount * samples.m_count;
+    return image;
+}
+
+BakedImage CpuIBLBaker::BakePrefiltered(CpuCubemap const& environment, PrefilterSettings const& settings) const
+{
+    uint32_t const resolution = settings.m_resolution;
+    uint32_t const mipLevels = CpuCubemap::GetFullMipLevels(resolution);
+    uint32_t const sampleCount = settings.m_sampleCount;
+
+    float const environmentSize = static_cast<float>(environment.GetSize());
+    float const maxLod = static_cast<float>(environment.GetMipLevels() - 1);
+
+    BakedImage image;
+    image.m_layout = { settings.m_format, resolution, resolution, mipLevels, 6 };
+
+    uint64_t texelCount = 0;
+    for (uint32_t mipLevel = 0; mipLevel < mipLevels; mipLevel++)
+    {
+        uint32_t const mipSize = std::max(resolution >> mipLevel, 1u);
+        uint64_t const mipOffset = texelCount;
+        texelCount += 6 * mipSize * mipSize;
+        image.m_texels.resize(texelCount);
+
+        float const roughness = static_cast<float>(mipLevel) / static_cast<float>(mipLevels - 1);
+
+        // With the view along the normal, the weight and the source lod of a sample don't depend on the texel
+        std::vector<glm::vec3> halfways;
+        std::vector<glm::vec2> weightsAndLods;
+        for (uint32_t i = 0; i < sampleCount; i++)
+        {
+            glm::vec3 const halfway = ImportanceSampleGGX(Hammersley(i, sampleCount), roughness);
+            float const dotNH = std::clamp(halfway.z, 0.0f, 1.0f);
+            float const dotNL = std::clamp(2.0f * dotNH * dotNH - 1.0f, 0.0f, 1.0f);
+            if (dotNL <= 0.0f)
+            {
+                continue;
+            }
+
+            float const pdf = NormalDistributionFunction(dotNH, roughness) * dotNH / (4.0f * dotNH) + s_epsilon;
+            float const omegaS = 1.0f / (static_cast<float>(sampleCount) * pdf);
+            float const omegaP = 4.0f * s_pi / (6.0f * environmentSize * environmentSize);
+            float const lod = roughness == 0.0f ? 0.0f : std::clamp(0.5f * std::log2(omegaS / omegaP), 0.0f, maxLod);
+
+            halfways.push_back(halfway);
+            weightsAndLods.emplace_back(dotNL, lod);
+        }
+
+        SampleTable samples;
+        samples.Resize(halfways.size());
+        float totalWeight = 0.0f;
+        for (uint32_t i = 0; i < halfways.size(); i++)
+        {
+            samples.m_x[i] = halfways[i].x;
+            samples.m_y[i] = halfways[i].y;
+            samples.m_z[i] = halfways[i].z;
+            samples.m_weights[i] = weightsAndLods[i].x;
+            samples.m_lods[i] = weightsAndLods[i].y;
+            totalWeight += weightsAndLods[i].x;
+        }
+
+        ParallelFor(m_threadCount, 6 * mipSize, [&](uint32_t row)
+        {
+            uint32_t const face = row / mipSize;
+            uint32_t const y = row % mipSize;
+
+            SampleTable directions;
+            for (uint32_t x = 0; x < mipSize; x++)
+            {
+                glm::vec3 const normal = CpuCubemap::GetDirection(face, x, y, mipSize);
+                glm::vec3 const up = std::abs(normal.z) < 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+                glm::vec3 const tangent = glm::normalize(glm::cross(up, normal));
+                glm::vec3 const bitangent = glm::normalize(glm::cross(normal, tangent));
+
+                // The light direction is the view reflected about the halfway vector, 2 * dot(N, H) * H - N
+                TransformSamples(samples, tangent, bitangent, normal, 2.0f, directions);
+
+                glm::vec3 color(0.0f);
+                for (uint32_t i = 0; i < samples.m_count; i++)
+                {
+                    glm::vec3 const direction(directions.m_x[i], directions.m_y[i], directions.m_z[i]);
+                    color += glm::vec3(environment.SampleLod(direction, samples.m_lods[i])) * samples.m_weights[i];
+                }
+
+                image.m_texels[mipOffset + (face * mipSize + y) * mipSize + x] = glm::vec4(color / totalWeight, 1.0f);
+            }
+        });
+
+        image.m_sampleCount += 6ull * mipSize * mipSize * sampleCount;
+    }
+
+    return image;
+}
+
+std::array<glm::vec3, 9> CpuIBLBaker::BakeIrradianceSH(CpuCubemap const& environment, uint32_t faceSize, uint64_t& sampleCount) const
+{
+    float const lod = std::max(std::log2(static_cast<float>(environment.GetSize()) / faceSize), 0.0f);
+
+    // A partial sum per face, the weights in the last element
+    std::array<std::array<glm::vec3, 10>, 6> faceSums;
+    ParallelFor(m_threadCount, 6, [&](uint32_t face)
+    {
+        std::array<glm::vec3, 10>& sums = faceSums[face];
+        sums.fill(glm::vec3(0.0f));
+        for (uint32_t y = 0; y < faceSize; y++)
+        {
+            for (uint32_t x = 0; x < faceSize; x++)
+            {
+                float const u = (x + 0.5f) / faceSize * 2.0f - 1.0f;
+                float const v = (y + 0.5f) / faceSize * 2.0f - 1.0f;
+                float const weight = 1.0f / std::pow(1.0f + u * u + v * v, 1.5f);
+
+                glm::vec3 const d = CpuCubemap::GetDirection(face, x, y, faceSize);
+                glm::vec3 const color = glm::vec3(environment.SampleLod(d, lod)) * weight;
+
+                std::array<float, 9> const basis = {
+                    0.282095f,
+                    0.488603f * d.y,
+                    0.488603f * d.z,
+                    0.488603f * d.x,
+                    1.092548f * d.x * d.y,
+                    1.092548f * d.y * d.z,
+                    0.315392f * (3.0f * d.z * d.z - 1.0f),
+                    1.092548f * d.x * d.z,
+                    0.546274f * (d.x * d.x - d.y * d.y)
+                };
+
+                for (uint32_t i = 0; i < basis.size(); i++)
+                {
+                    sums[i] += color * basis[i];
+                }
+                sums[9].x += weight;
+            }
+        }
+    });
+
+    std::array<glm::vec3, 10> total;
+    total.fill(glm::vec3(0.0f));
+    for (std::array<glm::vec3, 10> const& sums : faceSums)
+    {
+        for (uint32_t i = 0; i < total.size(); i++)
+        {
+            total[i] += sums[i];
+        }
+    }
+
+    // Cosine lobe convolution per band, divided by PI like the irradiance cube
+    std::array<float, 3> const bandFactors = { 1.0f, 2.0f / 3.0f, 0.25f };
+    float const normalization = 4.0f * s_pi / total[9].x;
+
+    std::array<glm::vec3, 9> coefficients;
+    for (uint32_t i = 0; i < coefficients.size(); i++)
+    {
+        float const band = bandFactors[i == 0 ? 0 : (i < 4 ? 1 : 2)];
+        coefficients[i] = total[i] * normalization * band;
+    }
+
+    sampleCount = 6ull * faceSize * faceSize;
+    return coefficients;
+}
+
+/*static*/ void CpuIBLBaker::WriteCacheFile(std::string const& name, uint64_t key, BakedImage const& image)
+{
+    IBLCacheHeader const header = image.m_layout.GetHeader(key);
+    uint32_t const texelSize = IBLCacheLayout::GetTexelSize(image.m_layout.m_format);
+    Assert(header.m_dataSize == image.m_texels.size() * texelSize, "Baked %s does not match its cache layout.", name.c_str());
+
+    std::vector<uint8_t> data(header.m_dataSize);
+    for (size_t i = 0; i < image.m_texels.size(); i++)
+    {
+        EncodeTexel(image.m_texels[i], image.m_layout.m_format, data.data() + i * texelSize);
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(s_iblCacheDirectory, error);
+
+    std::string const filePath = GetIBLCacheFilePath(name, key);
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        ThrowError("Failed to write IBL cache file: %s.", filePath.c_str());
+    }
+
+    file.write(reinterpret_cast<char const*>(&header), sizeof(IBLCacheHeader));
+    file.write(reinterpret_cast<char const*>(data.data()), data.size());
+    Log("Store IBL cache: %s", filePath.c_str());
+}
+
+void SampleTable::Resize(uint32_t count)
+{
+    uint32_t const paddedCount = SimdPadCount(count);
+    m_count = count;
+    m_x.assign(paddedCount, 0.0f);
+    m_y.assign(paddedCount, 0.0f);
+    m_z.assign(paddedCount, 0.0f);
+    m_weights.assign(paddedCount, 0.0f);
+    m_lods.assign(paddedCount, 0.0f);
+}
+
+static glm::vec2 Hammersley(uint32_t i, uint32_t count)
+{
+    uint32_t bits = (i << 16u) | (i >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+    float const rdi = static_cast<float>(bits) * 2.3283064365386963e-10f; // 0x100000000
+    return glm::vec2(static_cast<float>(i) / static_cast<float>(count), rdi);
+}
+
+// Halfway vector around +Z in tangent space
+static glm::vec3 ImportanceSampleGGX(glm::vec2 const& xi, float roughness)
+{
+    float const alpha = roughness * roughness;
+    float const phi = 2.0f * s_pi * xi.x;
+    float const cosTheta = std::sqrt((1.0f - xi.y) / (1.0f + (alpha * alpha - 1.0f) * xi.y));
+    float const sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+    return glm::vec3(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+}
+
+static float NormalDistributionFunction(float dotNH, float roughness)
+{
+    float const alpha = roughness * roughness;
+    float const alphaSquare = alpha * alpha;
+    float denominator = dotNH * dotNH * (alphaSquare - 1.0f) + 1.0f;
+    denominator = s_pi * denominator * denominator;
+    return alphaSquare / std::max(denominator, s_epsilon);
+}
+
+// Directions of the samples in the given frame. With a scale of 2 the result is reflected about the normal,
+// 2 * z * (x * T + y * B + z * N) - N, which is the light direction when the samples are halfway vectors.
+static void TransformSamples(SampleTable const& samples, glm::vec3 const& tangent, glm::vec3 const& bitangent, glm::vec3 const& normal, float scale, SampleTable& directions)
+{
+    if (directions.m_x.size() != samples.m_x.size())
+    {
+        directions.Resize(samples.m_count);
+    }
+
+    bool const reflect = scale != 1.0f;
+    SimdFloat const scaleVector = SimdSet(scale);
+
+    for (uint32_t i = 0; i < samples.m_x.size(); i += s_simdWidth)
+    {
+        SimdFloat const x = SimdLoad(&samples.m_x[i]);
+        SimdFloat const y = SimdLoad(&samples.m_y[i]);
+        SimdFloat const z = SimdLoad(&samples.m_z[i]);
+        SimdFloat const factor = reflect ? SimdMul(scaleVector, z) : scaleVector;
+
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            SimdFloat direction = SimdMulAdd(x, SimdSet(tangent[axis]), SimdMulAdd(y, SimdSet(bitangent[axis]), SimdMul(z, SimdSet(normal[axis]))));
+            if (reflect)
+            {
+                direction = SimdSub(SimdMul(factor, direction), SimdSet(normal[axis]));
+            }
+
+            std::vector<float>& destination = axis == 0 ? directions.m_x : (axis == 1 ? directions.m_y : directions.m_z);
+            SimdStore(&destination[i], direction);
+        }
+    }
+}
+
+static void EncodeTexel(glm::vec4 const& texel, VkFormat format, uint8_t* destination)
+{
+    switch (format)
+    {
+    case VK_FORMAT_R16G16_SFLOAT:
+    {
+        std::array<uint16_t, 2> const halfs = { glm::packHalf1x16(texel.x), glm::packHalf1x16(texel.y) };
+        memcpy(destination, halfs.data(), sizeof(halfs));
+        break;
+    }
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+    {
+        std::array<uint16_t, 4> const halfs = { glm::packHalf1x16(texel.x), glm::packHalf1x16(texel.y), glm::packHalf1x16(texel.z), glm::packHalf1x16(texel.w) };
+        memcpy(destination, halfs.data(), sizeof(halfs));
+        break;
+    }
+    case VK_FORMAT_R32G32B32A32_SFLOAT:
+        memcpy(destination, &texel, sizeof(glm::vec4));
+        break;
+    default:
+        ThrowError("Unsupported IBL cache format %d.", format);
+        break;
+    }
+}
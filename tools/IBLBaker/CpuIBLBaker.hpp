@@ -0,0 +1,30 @@
+#pragma once
+
+#include <CpuCubemap.hpp>
+#include <Resources/IBLCacheFormat.hpp>
+
+struct BakedImage
+{
+    IBLCacheLayout m_layout;
+    std::vector<glm::vec4> m_texels; // In the order of the cache files: mips, then layers, then rows
+    uint64_t m_sampleCount = 0;
+};
+
+// Reference CPU implementation of the IBL passes, taking the same samples as their shaders.
+// Sample directions are built a SIMD vector at a time, texels are spread over the threads.
+class CpuIBLBaker
+{
+public:
+    CpuIBLBaker(uint32_t threadCount) : m_threadCount(std::max(threadCount, 1u)) {}
+
+    BakedImage BakeBrdflut(BrdflutSettings const& settings) const;
+    BakedImage BakeIrradiance(CpuCubemap const& environment, IrradianceSettings const& settings) const;
+    BakedImage BakePrefiltered(CpuCubemap const& environment, PrefilterSettings const& settings) const;
+    // Cosine convolved coefficients divided by PI, as written by IrradianceSH.comp
+    std::array<glm::vec3, 9> BakeIrradianceSH(CpuCubemap const& environment, uint32_t faceSize, uint64_t& sampleCount) const;
+
+    static void WriteCacheFile(std::string const& name, uint64_t key, BakedImage const& image);
+
+private:
+    uint32_t m_threadCount = 1;
+};
@@ -0,0 +1,142 @@
+#include <CpuIBLBaker.hpp>
+#include <Resources/IBLCacheFormat.hpp>
+#include <Utilities/Helpers.hpp>
+
+// Same order as Loader::LoadTextureCubeHdr, the layers and the source hash depend on it
+static std::array<char const*, 6> const s_faceFileNames = { "negx.hdr", "posx.hdr", "negy.hdr", "posy.hdr", "negz.hdr", "posz.hdr" };
+
+static CpuCubemap LoadCubemap(std::string const& folderName, uint64_t& sourceHash);
+static void LogThroughput(char const* name, uint64_t sampleCount, std::chrono::steady_clock::time_point start);
+
+// Fills the IBL cache of an HDR cube folder without a GPU, the engine then loads the files instead of filtering
+int main(int argc, char** argv)
+{
+    std::string folderName;
+    uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    bool bakeSH = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string const argument = argv[i];
+        if (argument == "--threads" && i + 1 < argc)
+        {
+            threadCount = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (argument == "--sh")
+        {
+            bakeSH = true;
+        }
+        else
+        {
+            folderName = argument;
+        }
+    }
+
+    if (folderName.empty())
+    {
+        std::cerr << "Usage: iblbaker <cube folder> [--threads N] [--sh]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        uint64_t sourceHash = 0;
+        CpuCubemap const environment = LoadCubemap(folderName, sourceHash);
+        CpuIBLBaker const baker(threadCount);
+        Log("Baking %s with %u threads, %u wide SIMD", folderName.c_str(), threadCount, s_simdWidth);
+
+        BrdflutSettings const brdflutSettings;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        BakedImage const brdflut = baker.BakeBrdflut(brdflutSettings);
+        LogThroughput("brdflut", brdflut.m_sampleCount, start);
+        CpuIBLBaker::WriteCacheFile("brdflut", brdflutSettings.GetCacheKey(), brdflut);
+
+        IrradianceSettings const irradianceSettings;
+        start = std::chrono::steady_clock::now();
+        BakedImage const irradiance = baker.BakeIrradiance(environment, irradianceSettings);
+        LogThroughput("irradiance", irradiance.m_sampleCount, start);
+        CpuIBLBaker::WriteCacheFile("irradiance", irradianceSettings.GetCacheKey(sourceHash), irradiance);
+
+        PrefilterSettings const prefilterSettings;
+        start = std::chrono::steady_clock::now();
+        BakedImage const prefiltered = baker.BakePrefiltered(environment, prefilterSettings);
+        LogThroughput("prefilter", prefiltered.m_sampleCount, start);
+        CpuIBLBaker::WriteCacheFile("prefilter", prefilterSettings.GetCacheKey(sourceHash), prefiltered);
+
+        // The engine projects these at load time, they are printed to compare against a capture
+        if (bakeSH)
+        {
+            uint64_t sampleCount = 0;
+            start = std::chrono::steady_clock::now();
+            std::array<glm::vec3, 9> const coefficients = baker.BakeIrradianceSH(environment, 64, sampleCount);
+            LogThroughput("irradiance SH", sampleCount, start);
+
+            for (uint32_t i = 0; i < coefficients.size(); i++)
+            {
+                Log("SH %u: %f %f %f", i, coefficients[i].x, coefficients[i].y, coefficients[i].z);
+            }
+        }
+    }
+    catch (std::exception const&)
+    {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static CpuCubemap LoadCubemap(std::string const& folderName, uint64_t& sourceHash)
+{
+    std::array<float*, 6> faces = {};
+    int width = 0;
+    int height = 0;
+
+    for (uint32_t face = 0; face < faces.size(); face++)
+    {
+        std::string const filePath = folderName + "/" + s_faceFileNames[face];
+        int faceWidth = 0;
+        int faceHeight = 0;
+        int channels = 0;
+        faces[face] = stbi_loadf(filePath.c_str(), &faceWidth, &faceHeight, &channels, STBI_rgb_alpha);
+        if (!faces[face])
+        {
+            ThrowError("Failed to load texture image: %s.", filePath.c_str());
+        }
+
+        if (face == 0)
+        {
+            width = faceWidth;
+            height = faceHeight;
+        }
+        else if (faceWidth != width || faceHeight != height)
+        {
+            ThrowError("Cube faces have different sizes: %s.", filePath.c_str());
+        }
+    }
+
+    if (width != height)
+    {
+        ThrowError("Cube faces are not square: %s.", folderName.c_str());
+    }
+
+    uint32_t const size = static_cast<uint32_t>(width);
+    CpuCubemap cubemap(size, CpuCubemap::GetFullMipLevels(size));
+
+    // The cube stores the faces one after the other like the staging buffer of the engine, so it hashes the same
+    size_t const faceSize = static_cast<size_t>(size) * size * sizeof(glm::vec4);
+    for (uint32_t face = 0; face < faces.size(); face++)
+    {
+        memcpy(&cubemap.GetTexel(0, face, 0, 0), faces[face], faceSize);
+        stbi_image_free(faces[face]);
+    }
+
+    sourceHash = GetIBLSourceHash({ size, size }, reinterpret_cast<float const*>(cubemap.GetMip(0).data()));
+    cubemap.GenerateMipmaps();
+    return cubemap;
+}
+
+static void LogThroughput(char const* name, uint64_t sampleCount, std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+    Log("%s: %.3f s, %.1f M samples/s", name, elapsed.count(), sampleCount / elapsed.count() / 1e6);
+}
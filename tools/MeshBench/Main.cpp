@@ -0,0 +1,129 @@
+#include <ProceduralMeshes.hpp>
+#include <Utilities/MeshletBuilder.hpp>
+#include <Utilities/MeshOptimizer.hpp>
+
+static void BenchmarkMeshlets(ProceduralMesh const& mesh, uint32_t iterationCount);
+static void BenchmarkOptimizer(ProceduralMesh const& mesh, uint32_t iterationCount);
+static void LogVertexCache(char const* name, std::vector<uint32_t> const& indices, uint32_t vertexCount);
+static double GetTrianglesPerSecond(uint64_t triangleCount, std::chrono::steady_clock::duration duration);
+
+// Times the import time mesh processing on generated meshes, each step is repeated on a fresh copy of the indices.
+// The vertex cache behaviour is given for a 16 entry FIFO cache after each step.
+int main(int argc, char** argv)
+{
+    uint32_t iterationCount = 10;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string const argument = argv[i];
+        if (argument == "--iterations" && i + 1 < argc)
+        {
+            iterationCount = std::max(std::atoi(argv[++i]), 1);
+        }
+        else
+        {
+            std::cerr << "Usage: meshbench [--iterations N]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<ProceduralMesh> meshes;
+    meshes.push_back(MakeGridMesh(512));
+    meshes.push_back(MakeTorusMesh(1024, 256));
+    meshes.push_back(MakeFanMesh(4096));
+    meshes.push_back(ShuffleTriangles(MakeGridMesh(512)));
+    meshes.push_back(ShuffleTriangles(MakeTorusMesh(1024, 256)));
+
+    for (ProceduralMesh const& mesh : meshes)
+    {
+        std::printf("%s: %zu triangles, %zu vertices\n", mesh.m_name.c_str(), mesh.m_indices.size() / 3, mesh.m_positions.size());
+        BenchmarkMeshlets(mesh, iterationCount);
+        BenchmarkOptimizer(mesh, iterationCount);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static void BenchmarkMeshlets(ProceduralMesh const& mesh, uint32_t iterationCount)
+{
+    std::vector<Meshlet> meshlets;
+    std::chrono::steady_clock::duration duration = {};
+    for (uint32_t i = 0; i < iterationCount; i++)
+    {
+        std::vector<uint32_t> indices = mesh.m_indices;
+        std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+        meshlets = BuildMeshlets(indices, mesh.m_positions);
+        duration += std::chrono::steady_clock::now() - start;
+    }
+
+    uint32_t coneCount = 0;
+    for (Meshlet const& meshlet : meshlets)
+    {
+        coneCount += meshlet.m_coneCutoff < 1.0f;
+    }
+
+    uint64_t const triangleCount = mesh.m_indices.size() / 3;
+    std::printf("  meshlets: %.1f M triangles/s, %zu meshlets of %.1f triangles on average, %u with a normal cone\n",
+        GetTrianglesPerSecond(triangleCount * iterationCount, duration) / 1e6, meshlets.size(),
+        static_cast<double>(triangleCount) / std::max<size_t>(meshlets.size(), 1), coneCount);
+}
+
+static void BenchmarkOptimizer(ProceduralMesh const& mesh, uint32_t iterationCount)
+{
+    uint32_t const vertexCount = mesh.m_positions.size();
+    uint64_t const triangleCount = mesh.m_indices.size() / 3;
+    LogVertexCache("source", mesh.m_indices, vertexCount);
+
+    // Whole mesh Tipsify, then the outer facing clusters first
+    std::vector<uint32_t> indices;
+    std::chrono::steady_clock::duration cacheDuration = {};
+    std::chrono::steady_clock::duration overdrawDuration = {};
+    for (uint32_t i = 0; i < iterationCount; i++)
+    {
+        indices = mesh.m_indices;
+        std::vector<uint32_t> clusters;
+
+        std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+        OptimizeVertexCache(indices, vertexCount, &clusters);
+        std::chrono::steady_clock::time_point const cacheEnd = std::chrono::steady_clock::now();
+        OptimizeOverdraw(indices, mesh.m_positions, clusters);
+
+        cacheDuration += cacheEnd - start;
+        overdrawDuration += std::chrono::steady_clock::now() - cacheEnd;
+    }
+
+    std::printf("  vertex cache: %.1f M triangles/s, overdraw: %.1f M triangles/s\n",
+        GetTrianglesPerSecond(triangleCount * iterationCount, cacheDuration) / 1e6,
+        GetTrianglesPerSecond(triangleCount * iterationCount, overdrawDuration) / 1e6);
+    LogVertexCache("optimized", indices, vertexCount);
+
+    // Order drawn by the engine, Tipsify within each meshlet
+    std::chrono::steady_clock::duration meshletCacheDuration = {};
+    for (uint32_t i = 0; i < iterationCount; i++)
+    {
+        indices = mesh.m_indices;
+        std::vector<Meshlet> const meshlets = BuildMeshlets(indices, mesh.m_positions);
+
+        std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+        for (Meshlet const& meshlet : meshlets)
+        {
+            OptimizeVertexCacheRange(indices, meshlet.m_firstIndex, meshlet.m_indexCount);
+        }
+        meshletCacheDuration += std::chrono::steady_clock::now() - start;
+    }
+
+    std::printf("  meshlet vertex cache: %.1f M triangles/s\n", GetTrianglesPerSecond(triangleCount * iterationCount, meshletCacheDuration) / 1e6);
+    LogVertexCache("meshlets optimized", indices, vertexCount);
+}
+
+static void LogVertexCache(char const* name, std::vector<uint32_t> const& indices, uint32_t vertexCount)
+{
+    VertexCacheStatistics const statistics = AnalyzeVertexCache(indices, vertexCount);
+    std::printf("  %s: ACMR %.3f, ATVR %.3f\n", name, statistics.GetAcmr(), statistics.GetAtvr());
+}
+
+static double GetTrianglesPerSecond(uint64_t triangleCount, std::chrono::steady_clock::duration duration)
+{
+    double const seconds = std::chrono::duration<double>(duration).count();
+    return seconds > 0.0 ? triangleCount / seconds : 0.0;
+}
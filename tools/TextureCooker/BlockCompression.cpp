@@ -0,0 +1,334 @@
+#include <BlockCompression.hpp>
+
+// Interpolation weights of the 4 bit indices of BC6H and BC7, out of 64
+static constexpr std::array<uint32_t, 16> s_weights4 = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// Writes fields from the least significant bit of the block up
+class BlockWriter
+{
+public:
+    void Write(uint32_t value, uint32_t bitCount)
+    {
+        for (uint32_t i = 0; i < bitCount; i++, m_bit++)
+        {
+            if ((value >> i) & 1u)
+            {
+                m_block[m_bit / 8] |= static_cast<uint8_t>(1u << (m_bit % 8));
+            }
+        }
+    }
+
+    CompressedBlock const& GetBlock() const { return m_block; }
+
+private:
+    CompressedBlock m_block = {};
+    uint32_t m_bit = 0;
+};
+
+template<size_t Channels>
+static void FitEndpoints(std::array<std::array<float, Channels>, 16> const& texels, std::array<float, Channels>& endpoint0, std::array<float, Channels>& endpoint1);
+static uint16_t GetHalfBits(float value);
+
+CompressedBlock EncodeBC7Block(std::array<std::array<uint8_t, 4>, 16> const& texels)
+{
+    std::array<std::array<float, 4>, 16> values;
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            values[i][c] = texels[i][c];
+        }
+    }
+
+    std::array<float, 4> endpoint0;
+    std::array<float, 4> endpoint1;
+    FitEndpoints(values, endpoint0, endpoint1);
+
+    // Endpoints are 7 bits per channel plus a parity bit shared by the channels of an endpoint
+    std::array<std::array<uint32_t, 4>, 2> quantized;
+    std::array<uint32_t, 2> parity;
+    std::array<std::array<uint32_t, 4>, 2> endpoints;
+    for (uint32_t e = 0; e < 2; e++)
+    {
+        std::array<float, 4> const& endpoint = e == 0 ? endpoint0 : endpoint1;
+        float bestError = FLT_MAX;
+        for (uint32_t p = 0; p < 2; p++)
+        {
+            std::array<uint32_t, 4> candidate;
+            float error = 0.0f;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                candidate[c] = static_cast<uint32_t>(std::clamp(std::round((endpoint[c] - p) / 2.0f), 0.0f, 127.0f));
+                float const reconstructed = static_cast<float>((candidate[c] << 1) | p);
+                error += (reconstructed - endpoint[c]) * (reconstructed - endpoint[c]);
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                quantized[e] = candidate;
+                parity[e] = p;
+            }
+        }
+
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            endpoints[e][c] = (quantized[e][c] << 1) | parity[e];
+        }
+    }
+
+    std::array<uint32_t, 16> indices;
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        uint32_t bestError = UINT32_MAX;
+        for (uint32_t index = 0; index < 16; index++)
+        {
+            uint32_t error = 0;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                int32_t const color = static_cast<int32_t>(((64 - s_weights4[index]) * endpoints[0][c] + s_weights4[index] * endpoints[1][c] + 32) >> 6);
+                int32_t const difference = color - texels[i][c];
+                error += difference * difference;
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                indices[i] = index;
+            }
+        }
+    }
+
+    // The first index is stored without its top bit, which must then be zero
+    if (indices[0] >= 8)
+    {
+        std::swap(quantized[0], quantized[1]);
+        std::swap(parity[0], parity[1]);
+        for (uint32_t& index : indices)
+        {
+            index = 15 - index;
+        }
+    }
+
+    BlockWriter writer;
+    writer.Write(1u << 6, 7);
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        writer.Write(quantized[0][c], 7);
+        writer.Write(quantized[1][c], 7);
+    }
+    writer.Write(parity[0], 1);
+    writer.Write(parity[1], 1);
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        writer.Write(indices[i], i == 0 ? 3 : 4);
+    }
+
+    return writer.GetBlock();
+}
+
+CompressedBlock EncodeBC5Block(std::array<std::array<uint8_t, 2>, 16> const& texels)
+{
+    BlockWriter writer;
+    for (uint32_t c = 0; c < 2; c++)
+    {
+        uint32_t minimum = 255;
+        uint32_t maximum = 0;
+        for (std::array<uint8_t, 2> const& texel : texels)
+        {
+            minimum = std::min<uint32_t>(minimum, texel[c]);
+            maximum = std::max<uint32_t>(maximum, texel[c]);
+        }
+
+        // With the first endpoint greater, the six values in between are interpolated
+        std::array<uint32_t, 8> palette = { maximum, minimum };
+        for (uint32_t i = 2; i < 8; i++)
+        {
+            palette[i] = ((8 - i) * maximum + (i - 1) * minimum + 3) / 7;
+        }
+
+        writer.Write(maximum, 8);
+        writer.Write(minimum, 8);
+        for (std::array<uint8_t, 2> const& texel : texels)
+        {
+            uint32_t bestIndex = 0;
+            uint32_t bestError = UINT32_MAX;
+            for (uint32_t index = 0; index < palette.size(); index++)
+            {
+                uint32_t const error = static_cast<uint32_t>(std::abs(static_cast<int32_t>(palette[index]) - texel[c]));
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = index;
+                }
+            }
+
+            writer.Write(maximum == minimum ? 0 : bestIndex, 3);
+        }
+    }
+
+    return writer.GetBlock();
+}
+
+CompressedBlock EncodeBC6HBlock(std::array<std::array<float, 3>, 16> const& texels)
+{
+    // Work on the half bit patterns scaled by 64 / 31, the space the decoder interpolates in.
+    // Half bits grow roughly with the logarithm of the value, which suits HDR data.
+    std::array<std::array<float, 3>, 16> values;
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            values[i][c] = GetHalfBits(texels[i][c]) * 64.0f / 31.0f;
+        }
+    }
+
+    std::array<float, 3> endpoint0;
+    std::array<float, 3> endpoint1;
+    FitEndpoints(values, endpoint0, endpoint1);
+
+    std::array<std::array<uint32_t, 3>, 2> quantized;
+    std::array<std::array<uint32_t, 3>, 2> unquantized;
+    for (uint32_t e = 0; e < 2; e++)
+    {
+        std::array<float, 3> const& endpoint = e == 0 ? endpoint0 : endpoint1;
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            uint32_t const q = static_cast<uint32_t>(std::clamp(std::round((endpoint[c] - 32.0f) / 64.0f), 0.0f, 1023.0f));
+            quantized[e][c] = q;
+            unquantized[e][c] = q == 0 ? 0 : (q == 1023 ? 0xFFFF : q * 64 + 32);
+        }
+    }
+
+    std::array<uint32_t, 16> indices;
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        float bestError = FLT_MAX;
+        for (uint32_t index = 0; index < 16; index++)
+        {
+            float error = 0.0f;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                uint32_t const interpolated = ((64 - s_weights4[index]) * unquantized[0][c] + s_weights4[index] * unquantized[1][c] + 32) >> 6;
+                float const difference = static_cast<float>(interpolated) - values[i][c];
+                error += difference * difference;
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                indices[i] = index;
+            }
+        }
+    }
+
+    if (indices[0] >= 8)
+    {
+        std::swap(quantized[0], quantized[1]);
+        for (uint32_t& index : indices)
+        {
+            index = 15 - index;
+        }
+    }
+
+    BlockWriter writer;
+    writer.Write(0x03, 5);
+    for (uint32_t e = 0; e < 2; e++)
+    {
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            writer.Write(quantized[e][c], 10);
+        }
+    }
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        writer.Write(indices[i], i == 0 ? 3 : 4);
+    }
+
+    return writer.GetBlock();
+}
+
+// Extremes of the texels projected on their principal axis, found by power iteration on the covariance
+template<size_t Channels>
+static void FitEndpoints(std::array<std::array<float, Channels>, 16> const& texels, std::array<float, Channels>& endpoint0, std::array<float, Channels>& endpoint1)
+{
+    std::array<float, Channels> mean = {};
+    for (std::array<float, Channels> const& texel : texels)
+    {
+        for (size_t c = 0; c < Channels; c++)
+        {
+            mean[c] += texel[c] / 16.0f;
+        }
+    }
+
+    std::array<std::array<float, Channels>, Channels> covariance = {};
+    for (std::array<float, Channels> const& texel : texels)
+    {
+        for (size_t a = 0; a < Channels; a++)
+        {
+            for (size_t b = 0; b < Channels; b++)
+            {
+                covariance[a][b] += (texel[a] - mean[a]) * (texel[b] - mean[b]);
+            }
+        }
+    }
+
+    std::array<float, Channels> axis;
+    axis.fill(1.0f);
+    for (uint32_t iteration = 0; iteration < 8; iteration++)
+    {
+        std::array<float, Channels> next = {};
+        float length = 0.0f;
+        for (size_t a = 0; a < Channels; a++)
+        {
+            for (size_t b = 0; b < Channels; b++)
+            {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length = std::max(length, std::abs(next[a]));
+        }
+
+        if (length <= 0.0f)
+        {
+            // Every texel is the same color
+            break;
+        }
+
+        for (size_t a = 0; a < Channels; a++)
+        {
+            axis[a] = next[a] / length;
+        }
+    }
+
+    float axisLengthSquare = 0.0f;
+    for (float value : axis)
+    {
+        axisLengthSquare += value * value;
+    }
+
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+    for (std::array<float, Channels> const& texel : texels)
+    {
+        float projection = 0.0f;
+        for (size_t c = 0; c < Channels; c++)
+        {
+            projection += (texel[c] - mean[c]) * axis[c];
+        }
+        projection /= axisLengthSquare;
+        minimum = std::min(minimum, projection);
+        maximum = std::max(maximum, projection);
+    }
+
+    for (size_t c = 0; c < Channels; c++)
+    {
+        endpoint0[c] = mean[c] + axis[c] * minimum;
+        endpoint1[c] = mean[c] + axis[c] * maximum;
+    }
+}
+
+static uint16_t GetHalfBits(float value)
+{
+    // Largest finite half, the unsigned format has no infinity
+    return std::min<uint16_t>(glm::packHalf1x16(std::max(value, 0.0f)), 0x7BFF);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// Encoders of a single 4x4 block, texels in rows top to bottom.
+// They favour speed and simplicity over quality: one mode each, endpoints fitted along the principal axis.
+
+using CompressedBlock = std::array<uint8_t, 16>;
+
+// BC7 mode 6, RGBA with a single subset
+CompressedBlock EncodeBC7Block(std::array<std::array<uint8_t, 4>, 16> const& texels);
+// Two BC4 channels, for the XY of normal maps
+CompressedBlock EncodeBC5Block(std::array<std::array<uint8_t, 2>, 16> const& texels);
+// BC6H mode 11, unsigned half RGB with unquantized 10 bit endpoints. Negative values are clamped to zero.
+CompressedBlock EncodeBC6HBlock(std::array<std::array<float, 3>, 16> const& texels);
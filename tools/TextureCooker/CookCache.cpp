@@ -0,0 +1,49 @@
+#include <CookCache.hpp>
+
+#include <Utilities/Helpers.hpp>
+
+static char const* const s_cookCacheFileName = "cook_cache.txt";
+
+CookCache::CookCache(std::string const& folderName)
+    : m_filePath(folderName + "/" + s_cookCacheFileName)
+    , m_folderName(folderName)
+{
+    std::ifstream file(m_filePath);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream stream(line);
+        uint64_t hash = 0;
+        std::string outputName;
+        if (stream >> std::hex >> hash >> std::ws && std::getline(stream, outputName) && !outputName.empty())
+        {
+            m_hashes[outputName] = hash;
+        }
+    }
+}
+
+bool CookCache::IsUpToDate(std::string const& outputName, uint64_t hash) const
+{
+    auto const it = m_hashes.find(outputName);
+    return it != m_hashes.end() && it->second == hash && std::filesystem::exists(m_folderName + "/" + outputName);
+}
+
+void CookCache::Set(std::string const& outputName, uint64_t hash)
+{
+    m_hashes[outputName] = hash;
+}
+
+void CookCache::Save() const
+{
+    std::ofstream file(m_filePath, std::ios::trunc);
+    if (!file.is_open())
+    {
+        Warn("Failed to write cook cache: %s.", m_filePath.c_str());
+        return;
+    }
+
+    for (auto const& [outputName, hash] : m_hashes)
+    {
+        file << std::hex << hash << " " << outputName << "\n";
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// Hashes of the sources of the files cooked in a folder, so unchanged textures are skipped.
+// Stored as a text file next to the outputs, a line per output: hash, then the file name.
+class CookCache
+{
+public:
+    CookCache(std::string const& folderName);
+
+    // The output must also still exist
+    bool IsUpToDate(std::string const& outputName, uint64_t hash) const;
+    void Set(std::string const& outputName, uint64_t hash);
+    void Save() const;
+
+private:
+    std::string m_filePath;
+    std::string m_folderName;
+    std::map<std::string, uint64_t> m_hashes;
+};
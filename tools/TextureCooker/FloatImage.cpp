@@ -0,0 +1,68 @@
+#include <FloatImage.hpp>
+
+#include <Simd.hpp>
+
+FloatImage DownsampleBox(FloatImage const& image)
+{
+    FloatImage mip(std::max(image.m_width / 2, 1u), std::max(image.m_height / 2, 1u));
+
+    size_t const rowFloats = static_cast<size_t>(image.m_width) * 4;
+    std::vector<float> rowSum(rowFloats);
+    SimdFloat const quarter = SimdSet(0.25f);
+
+    for (uint32_t y = 0; y < mip.m_height; y++)
+    {
+        // Vertical pairs first, a contiguous sum of two rows that maps straight onto SIMD vectors
+        float const* row0 = image.GetTexel(0, y * 2);
+        float const* row1 = image.GetTexel(0, std::min(y * 2 + 1, image.m_height - 1));
+
+        size_t i = 0;
+        for (; i + s_simdWidth <= rowFloats; i += s_simdWidth)
+        {
+            SimdStore(&rowSum[i], SimdMul(SimdAdd(SimdLoad(row0 + i), SimdLoad(row1 + i)), quarter));
+        }
+        for (; i < rowFloats; i++)
+        {
+            rowSum[i] = (row0[i] + row1[i]) * 0.25f;
+        }
+
+        // Then horizontal pairs of texels
+        float* destination = mip.GetTexel(0, y);
+        for (uint32_t x = 0; x < mip.m_width; x++)
+        {
+            size_t const x0 = static_cast<size_t>(x * 2) * 4;
+            size_t const x1 = static_cast<size_t>(std::min(x * 2 + 1, image.m_width - 1)) * 4;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                destination[x * 4 + c] = rowSum[x0 + c] + rowSum[x1 + c];
+            }
+        }
+    }
+
+    return mip;
+}
+
+void NormalizeNormals(FloatImage& image)
+{
+    for (size_t i = 0; i < image.m_texels.size(); i += 4)
+    {
+        float* texel = &image.m_texels[i];
+        glm::vec3 normal = glm::vec3(texel[0], texel[1], texel[2]) * 2.0f - 1.0f;
+        float const length = glm::length(normal);
+        normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+
+        texel[0] = normal.x * 0.5f + 0.5f;
+        texel[1] = normal.y * 0.5f + 0.5f;
+        texel[2] = normal.z * 0.5f + 0.5f;
+    }
+}
+
+float SrgbToLinear(float value)
+{
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float LinearToSrgb(float value)
+{
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
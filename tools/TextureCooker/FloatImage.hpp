@@ -0,0 +1,24 @@
+#pragma once
+
+// RGBA float image, rows top to bottom
+struct FloatImage
+{
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    std::vector<float> m_texels; // Four floats per texel
+
+    FloatImage() = default;
+    FloatImage(uint32_t width, uint32_t height) : m_width(width), m_height(height), m_texels(static_cast<size_t>(width) * height * 4, 0.0f) {}
+
+    // Coordinates are clamped, so partial blocks repeat the edge
+    float const* GetTexel(uint32_t x, uint32_t y) const { return &m_texels[(static_cast<size_t>(std::min(y, m_height - 1)) * m_width + std::min(x, m_width - 1)) * 4]; }
+    float* GetTexel(uint32_t x, uint32_t y) { return &m_texels[(static_cast<size_t>(y) * m_width + x) * 4]; }
+};
+
+// Half size image with a 2x2 box filter, the image must hold linear values for the result to be gamma correct
+FloatImage DownsampleBox(FloatImage const& image);
+// Renormalizes tangent space normals stored as 0.5 * n + 0.5, which filtering shortens
+void NormalizeNormals(FloatImage& image);
+
+float SrgbToLinear(float value);
+float LinearToSrgb(float value);
@@ -0,0 +1,381 @@
+#include <BlockCompression.hpp>
+#include <CookCache.hpp>
+#include <FloatImage.hpp>
+#include <Simd.hpp>
+#include <Utilities/Helpers.hpp>
+#include <Utilities/Ktx2.hpp>
+#include <Utilities/ParallelFor.hpp>
+
+// Part of every hash, bump it when the output of the cooker changes
+static constexpr uint32_t s_cookerVersion = 1;
+
+enum class TextureKind : uint32_t
+{
+    Color, // BC7 with sRGB values
+    Data, // BC7 with linear values, e.g. metallic roughness or occlusion
+    Normal, // BC5, the shader rebuilds Z
+    Hdr // BC6H
+};
+
+struct CookedTexture
+{
+    std::string m_sourcePath;
+    std::string m_outputName;
+    TextureKind m_kind = TextureKind::Color;
+    uint64_t m_hash = 0;
+    uint64_t m_sourceSize = 0;
+    bool m_isValid = false; // False when up to date or when the source failed to load
+    std::vector<FloatImage> m_mips;
+    std::vector<std::vector<uint8_t>> m_levels;
+};
+
+static TextureKind GetTextureKind(std::filesystem::path const& path);
+static bool LoadTexture(CookedTexture& texture, CookCache const& cache);
+static void EncodeBlockRow(CookedTexture& texture, uint32_t mipLevel, uint32_t blockY);
+static VkFormat GetFormat(TextureKind kind);
+static std::vector<uint32_t> GetDataFormatDescriptor(TextureKind kind);
+
+// Cooks PNG, JPG and HDR sources into block compressed KTX2 files with a full mip chain, without a GPU
+int main(int argc, char** argv)
+{
+    std::string outputFolderName;
+    std::vector<std::string> inputs;
+    uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string const argument = argv[i];
+        if (argument == "--threads" && i + 1 < argc)
+        {
+            threadCount = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (outputFolderName.empty())
+        {
+            outputFolderName = argument;
+        }
+        else
+        {
+            inputs.push_back(argument);
+        }
+    }
+
+    if (outputFolderName.empty() || inputs.empty())
+    {
+        std::cerr << "Usage: texturecooker <output folder> <inputs...> [--threads N]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(outputFolderName, error);
+
+    CookCache cache(outputFolderName);
+    std::vector<CookedTexture> textures(inputs.size());
+    std::map<std::string, size_t> outputNames; // Lowercase, file systems may ignore the case
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        std::filesystem::path const path(inputs[i]);
+        textures[i].m_sourcePath = inputs[i];
+        textures[i].m_outputName = path.stem().string() + ".ktx2";
+        textures[i].m_kind = GetTextureKind(path);
+
+        // Sources with the same name would overwrite each other in the output folder
+        std::string outputName = textures[i].m_outputName;
+        std::transform(outputName.begin(), outputName.end(), outputName.begin(), [](unsigned char c) { return std::tolower(c); });
+        auto const [it, isInserted] = outputNames.emplace(outputName, i);
+        if (!isInserted)
+        {
+            std::cerr << "Both " << inputs[it->second] << " and " << inputs[i] << " would be cooked to " << textures[i].m_outputName << ", rename one of them" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    Log("Cooking %zu textures with %u threads, %u wide SIMD", textures.size(), threadCount, s_simdWidth);
+    std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+
+    // Decode and filter the mips, a texture per task
+    ParallelFor(threadCount, static_cast<uint32_t>(textures.size()), [&](uint32_t i)
+    {
+        textures[i].m_isValid = LoadTexture(textures[i], cache);
+    });
+
+    // Encode, a row of blocks of a mip per task so large textures spread over every thread
+    std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> blockRows;
+    for (uint32_t i = 0; i < textures.size(); i++)
+    {
+        CookedTexture& texture = textures[i];
+        if (!texture.m_isValid)
+        {
+            continue;
+        }
+
+        texture.m_levels.resize(texture.m_mips.size());
+        for (uint32_t mipLevel = 0; mipLevel < texture.m_mips.size(); mipLevel++)
+        {
+            FloatImage const& mip = texture.m_mips[mipLevel];
+            uint32_t const blockCountX = (mip.m_width + 3) / 4;
+            uint32_t const blockCountY = (mip.m_height + 3) / 4;
+            texture.m_levels[mipLevel].resize(static_cast<size_t>(blockCountX) * blockCountY * sizeof(CompressedBlock));
+
+            for (uint32_t blockY = 0; blockY < blockCountY; blockY++)
+            {
+                blockRows.emplace_back(i, mipLevel, blockY);
+            }
+        }
+    }
+
+    ParallelFor(threadCount, static_cast<uint32_t>(blockRows.size()), [&](uint32_t i)
+    {
+        auto const& [textureIndex, mipLevel, blockY] = blockRows[i];
+        EncodeBlockRow(textures[textureIndex], mipLevel, blockY);
+    });
+
+    uint32_t cookedCount = 0;
+    uint64_t sourceSize = 0;
+    uint64_t outputSize = 0;
+    for (CookedTexture& texture : textures)
+    {
+        if (!texture.m_isValid)
+        {
+            continue;
+        }
+
+        std::string const outputPath = outputFolderName + "/" + texture.m_outputName;
+        if (!WriteKtx2(outputPath, GetFormat(texture.m_kind), texture.m_mips[0].m_width, texture.m_mips[0].m_height, texture.m_levels, GetDataFormatDescriptor(texture.m_kind)))
+        {
+            continue;
+        }
+
+        cache.Set(texture.m_outputName, texture.m_hash);
+        cookedCount++;
+        sourceSize += texture.m_sourceSize;
+        outputSize += std::filesystem::file_size(outputPath, error);
+    }
+
+    cache.Save();
+
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+    Log("Cooked %u of %zu textures in %.3f s, %.1f MB of sources to %.1f MB", cookedCount, textures.size(), elapsed.count(), sourceSize / 1e6, outputSize / 1e6);
+    return EXIT_SUCCESS;
+}
+
+static TextureKind GetTextureKind(std::filesystem::path const& path)
+{
+    std::string extension = path.extension().string();
+    std::string name = path.stem().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    if (extension == ".hdr")
+    {
+        return TextureKind::Hdr;
+    }
+
+    if (name.find("normal") != std::string::npos)
+    {
+        return TextureKind::Normal;
+    }
+
+    for (char const* colorName : { "color", "albedo", "diffuse", "emissive" })
+    {
+        if (name.find(colorName) != std::string::npos)
+        {
+            return TextureKind::Color;
+        }
+    }
+
+    return TextureKind::Data;
+}
+
+static bool LoadTexture(CookedTexture& texture, CookCache const& cache)
+{
+    std::string bytes;
+    try
+    {
+        bytes = ReadFile(texture.m_sourcePath);
+    }
+    catch (std::exception const&)
+    {
+        return false;
+    }
+
+    texture.m_sourceSize = bytes.size();
+    texture.m_hash = HashBytes(bytes.data(), bytes.size());
+    texture.m_hash = HashBytes(&texture.m_kind, sizeof(TextureKind), texture.m_hash);
+    texture.m_hash = HashBytes(&s_cookerVersion, sizeof(s_cookerVersion), texture.m_hash);
+
+    if (cache.IsUpToDate(texture.m_outputName, texture.m_hash))
+    {
+        return false;
+    }
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    stbi_uc const* buffer = reinterpret_cast<stbi_uc const*>(bytes.data());
+
+    if (texture.m_kind == TextureKind::Hdr)
+    {
+        float* pixels = stbi_loadf_from_memory(buffer, static_cast<int>(bytes.size()), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            Warn("Failed to load texture image: %s.", texture.m_sourcePath.c_str());
+            return false;
+        }
+
+        FloatImage& image = texture.m_mips.emplace_back(width, height);
+        memcpy(image.m_texels.data(), pixels, image.m_texels.size() * sizeof(float));
+        stbi_image_free(pixels);
+    }
+    else
+    {
+        stbi_uc* pixels = stbi_load_from_memory(buffer, static_cast<int>(bytes.size()), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels)
+        {
+            Warn("Failed to load texture image: %s.", texture.m_sourcePath.c_str());
+            return false;
+        }
+
+        // Filtering happens on linear values
+        FloatImage& image = texture.m_mips.emplace_back(width, height);
+        for (size_t i = 0; i < image.m_texels.size(); i++)
+        {
+            float const value = pixels[i] / 255.0f;
+            bool const isColor = texture.m_kind == TextureKind::Color && i % 4 != 3;
+            image.m_texels[i] = isColor ? SrgbToLinear(value) : value;
+        }
+        stbi_image_free(pixels);
+    }
+
+    while (texture.m_mips.back().m_width > 1 || texture.m_mips.back().m_height > 1)
+    {
+        FloatImage mip = DownsampleBox(texture.m_mips.back());
+        if (texture.m_kind == TextureKind::Normal)
+        {
+            NormalizeNormals(mip);
+        }
+        texture.m_mips.push_back(std::move(mip));
+    }
+
+    return true;
+}
+
+static void EncodeBlockRow(CookedTexture& texture, uint32_t mipLevel, uint32_t blockY)
+{
+    FloatImage const& mip = texture.m_mips[mipLevel];
+    uint32_t const blockCountX = (mip.m_width + 3) / 4;
+    uint8_t* destination = texture.m_levels[mipLevel].data() + static_cast<size_t>(blockY) * blockCountX * sizeof(CompressedBlock);
+
+    auto const toUnorm = [](float value) { return static_cast<uint8_t>(std::clamp(std::round(value * 255.0f), 0.0f, 255.0f)); };
+
+    for (uint32_t blockX = 0; blockX < blockCountX; blockX++)
+    {
+        std::array<float const*, 16> texels;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            texels[i] = mip.GetTexel(blockX * 4 + i % 4, blockY * 4 + i / 4);
+        }
+
+        CompressedBlock block;
+        if (texture.m_kind == TextureKind::Hdr)
+        {
+            std::array<std::array<float, 3>, 16> values;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                values[i] = { texels[i][0], texels[i][1], texels[i][2] };
+            }
+            block = EncodeBC6HBlock(values);
+        }
+        else if (texture.m_kind == TextureKind::Normal)
+        {
+            std::array<std::array<uint8_t, 2>, 16> values;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                values[i] = { toUnorm(texels[i][0]), toUnorm(texels[i][1]) };
+            }
+            block = EncodeBC5Block(values);
+        }
+        else
+        {
+            std::array<std::array<uint8_t, 4>, 16> values;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    bool const isColor = texture.m_kind == TextureKind::Color && c != 3;
+                    values[i][c] = toUnorm(isColor ? LinearToSrgb(texels[i][c]) : texels[i][c]);
+                }
+            }
+            block = EncodeBC7Block(values);
+        }
+
+        memcpy(destination + blockX * sizeof(CompressedBlock), block.data(), sizeof(CompressedBlock));
+    }
+}
+
+static VkFormat GetFormat(TextureKind kind)
+{
+    switch (kind)
+    {
+    case TextureKind::Color: return VK_FORMAT_BC7_SRGB_BLOCK;
+    case TextureKind::Data: return VK_FORMAT_BC7_UNORM_BLOCK;
+    case TextureKind::Normal: return VK_FORMAT_BC5_UNORM_BLOCK;
+    case TextureKind::Hdr: return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+    }
+
+    return VK_FORMAT_UNDEFINED;
+}
+
+// Basic data format descriptor block of the Khronos Data Format specification
+static std::vector<uint32_t> GetDataFormatDescriptor(TextureKind kind)
+{
+    // Color models and the channels of their samples
+    static constexpr uint32_t s_modelBC5 = 132;
+    static constexpr uint32_t s_modelBC6H = 133;
+    static constexpr uint32_t s_modelBC7 = 134;
+    static constexpr uint32_t s_transferLinear = 1;
+    static constexpr uint32_t s_transferSrgb = 2;
+    static constexpr uint32_t s_primariesBT709 = 1;
+    static constexpr uint32_t s_channelFloat = 0x80;
+
+    // Bit offset, bit count, channel and upper bound of each sample
+    std::vector<std::array<uint32_t, 4>> samples;
+    uint32_t model = s_modelBC7;
+    switch (kind)
+    {
+    case TextureKind::Color:
+    case TextureKind::Data:
+        samples.push_back({ 0, 128, 0, 0xFFFFFFFF });
+        break;
+    case TextureKind::Normal:
+        model = s_modelBC5;
+        samples.push_back({ 0, 64, 0, 0xFFFFFFFF });
+        samples.push_back({ 64, 64, 1, 0xFFFFFFFF });
+        break;
+    case TextureKind::Hdr:
+        model = s_modelBC6H;
+        samples.push_back({ 0, 128, s_channelFloat, std::bit_cast<uint32_t>(1.0f) });
+        break;
+    }
+
+    uint32_t const transfer = kind == TextureKind::Color ? s_transferSrgb : s_transferLinear;
+    uint32_t const blockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+
+    std::vector<uint32_t> descriptor = {
+        0, // Khronos vendor, basic descriptor type
+        2 | (blockSize << 16), // Version
+        model | (s_primariesBT709 << 8) | (transfer << 16), // Straight alpha
+        3 | (3 << 8), // 4x4x1 texel blocks, stored minus one
+        sizeof(CompressedBlock), // Bytes of the first plane
+        0
+    };
+
+    for (std::array<uint32_t, 4> const& sample : samples)
+    {
+        descriptor.push_back(sample[0] | ((sample[1] - 1) << 16) | (sample[2] << 24));
+        descriptor.push_back(0); // Sample position
+        descriptor.push_back(0); // Lower bound
+        descriptor.push_back(sample[3]);
+    }
+
+    return descriptor;
+}
@@ -0,0 +1,4 @@
+#include <TextureCookerPCH.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
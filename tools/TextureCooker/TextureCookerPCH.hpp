@@ -0,0 +1,48 @@
+#pragma once
+
+
+// Standard library
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+
+// External
+#define NOMINMAX
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+// Only for the formats written to the KTX2 files, nothing is linked
+#include <vulkan/vulkan.h>
+
+#include <stb_image.h>
+
+
+// SIMD
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif